@@ -80,6 +80,9 @@ set(GAMESHAREDLIST
     ${GAMELOGIC_DIR}/shared/parse.cpp
     ${GAMELOGIC_DIR}/shared/parse.h
     ${GAMELOGIC_DIR}/shared/Clustering.h
+    ${GAMELOGIC_DIR}/shared/Timing.h
+    ${GAMELOGIC_DIR}/shared/Parallel.h
+    ${GAMELOGIC_DIR}/shared/Parallel.cpp
 
     ${GAMELOGIC_DIR}/shared/navgen/brush.cpp
     ${GAMELOGIC_DIR}/shared/navgen/nav.cpp
@@ -193,8 +196,11 @@ set(CGAMELIST
 set(SGAMELIST
     ${GAMELOGIC_DIR}/sgame/Beacon.cpp
     ${GAMELOGIC_DIR}/sgame/BaseClustering.cpp
+    ${GAMELOGIC_DIR}/sgame/BuildableCensus.cpp
     ${GAMELOGIC_DIR}/sgame/Entities.cpp
     ${GAMELOGIC_DIR}/sgame/Entities.h
+    ${GAMELOGIC_DIR}/sgame/EquipmentCensus.cpp
+    ${GAMELOGIC_DIR}/sgame/SpatialQueries.h
     ${GAMELOGIC_DIR}/sgame/sg_active.cpp
     ${GAMELOGIC_DIR}/sgame/sg_admin.cpp
     ${GAMELOGIC_DIR}/sgame/sg_admin.h
@@ -230,6 +236,7 @@ set(SGAMELIST
     ${GAMELOGIC_DIR}/sgame/sg_namelog.cpp
     ${GAMELOGIC_DIR}/sgame/sg_physics.cpp
     ${GAMELOGIC_DIR}/sgame/sg_public.h
+    ${GAMELOGIC_DIR}/sgame/sg_replay.cpp
     ${GAMELOGIC_DIR}/sgame/sg_session.cpp
     ${GAMELOGIC_DIR}/sgame/sg_spawn.cpp
     ${GAMELOGIC_DIR}/sgame/sg_spawn.h
@@ -23,6 +23,7 @@ along with Daemon.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "common/Common.h"
 #include "cg_local.h"
+#include "shared/Timing.h"
 
 #include <glm/geometric.hpp>
 
@@ -80,62 +81,33 @@ struct DamageIndicator {
 	float alpha;
 };
 
-class Clustering : public ::Clustering::EuclideanClustering<DamageIndicator*, 3> {
-	using super = Clustering::EuclideanClustering<DamageIndicator*, 3>;
+// Hits are merged per victim as they arrive and the number of live
+// indicators is capped, so that heavy fire has a bounded cost per frame.
+const int MAX_QUEUED_DAMAGE_INDICATORS = 64;
+const int MAX_DAMAGE_INDICATORS = 256;
 
-public:
-	Clustering(float laxity = 2.0f, std::function<bool(DamageIndicator*,
-	           DamageIndicator*)> visibilityTest = nullptr)
-	: super(laxity, visibilityTest)
-	{
-	}
+// indicators of the same victim closer than this are merged
+const float DAMAGE_INDICATOR_MERGE_DISTANCE = 200.0f;
+const int DAMAGE_INDICATOR_MERGE_TIME = 300;
 
-	void Update(DamageIndicator *di)
-	{
-		super::Update(di, di->origin);
-	}
+struct QueuedDamageIndicator {
+	DamageIndicator di;
+	int hits;
 };
 
-static std::list<DamageIndicator> damageIndicators;
-static std::list<DamageIndicator> damageIndicatorQueue;
+static DamageIndicator damageIndicators[MAX_DAMAGE_INDICATORS];
+static int numDamageIndicators;
+static QueuedDamageIndicator damageIndicatorQueue[MAX_QUEUED_DAMAGE_INDICATORS];
+static int numQueuedDamageIndicators;
 
-/**
- * @brief Create a new damage indicator and add it to the queue.
- */
-static void EnqueueDamageIndicator(glm::vec3 point, int flags, float value, int victim)
+static bool DamageIndicatorsSameKind(const DamageIndicator *A, const DamageIndicator *B)
 {
-	DamageIndicator di;
-
-	di.ctime = cg.time;
-	di.origin = point;
-	di.value = value;
-	di.victim = victim;
-
-	if (flags & HIT_BUILDING) {
-		bool alien = (CG_MyTeam() == TEAM_ALIENS) ^ !(flags & HIT_FRIENDLY);
-
-		if (alien)
-			di.layer = DIL_ALIEN_BUILDING;
-		else
-			di.layer = DIL_HUMAN_BUILDING;
-	} else {
-		if (flags & HIT_FRIENDLY)
-			di.layer = DIL_TEAMMATE;
-		else
-			di.layer = DIL_ENEMY;
-	}
-
-	// there will always be only one HIT_LETHAL damage indicator
-	// and it'll be always the last one, so it doesn't need its own layer
-	di.lethal = (flags & HIT_LETHAL) == HIT_LETHAL;
-
-	// FIXME: avoid copying DamageIndicators
-	damageIndicatorQueue.push_back(di);
+	return (A->layer == B->layer) && (A->victim == B->victim);
 }
 
-static bool DamageIndicatorsSameKind(DamageIndicator *A, DamageIndicator *B)
+static void RemoveDamageIndicator(int index)
 {
-	return (A->layer == B->layer) && (A->victim == B->victim);
+	damageIndicators[index] = damageIndicators[--numDamageIndicators];
 }
 
 /**
@@ -144,15 +116,14 @@ static bool DamageIndicatorsSameKind(DamageIndicator *A, DamageIndicator *B)
 static void AddDamageIndicator(DamageIndicator di)
 {
 	// combine older indicators of the same type if they're close enough
-	for ( auto i = damageIndicators.begin(); i != damageIndicators.end(); )
-	{
-		if ( DamageIndicatorsSameKind(&*i, &di) && di.ctime - i->ctime < 300 && glm::distance( di.origin, i->origin ) < 200 )
-		{
-			di.value += i->value;
-			i = damageIndicators.erase(i);
-		}
-		else
-		{
+	for (int i = 0; i < numDamageIndicators; ) {
+		const DamageIndicator &old = damageIndicators[i];
+
+		if (DamageIndicatorsSameKind(&old, &di) && di.ctime - old.ctime < DAMAGE_INDICATOR_MERGE_TIME &&
+		    glm::distance(di.origin, old.origin) < DAMAGE_INDICATOR_MERGE_DISTANCE) {
+			di.value += old.value;
+			RemoveDamageIndicator(i);
+		} else {
 			i++;
 		}
 	}
@@ -160,64 +131,80 @@ static void AddDamageIndicator(DamageIndicator di)
 	di.color = damageIndicatorColors[di.layer];
 	di.velocity = glm::vec3(crandom() * 20, crandom() * 20, 100);
 
-	damageIndicators.push_back(di);
+	if (numDamageIndicators < MAX_DAMAGE_INDICATORS) {
+		damageIndicators[numDamageIndicators++] = di;
+		return;
+	}
+
+	// replace the oldest one
+	int oldest = 0;
+	for (int i = 1; i < numDamageIndicators; i++) {
+		if (damageIndicators[i].ctime < damageIndicators[oldest].ctime)
+			oldest = i;
+	}
+	damageIndicators[oldest] = di;
 }
 
 /**
- * @brief The slow path of DequeueDamageIndicators.
+ * @brief Move indicators from the queue.
  */
-static void DequeueDamageIndicators2(void)
+static void DequeueDamageIndicators(void)
 {
-	Clustering clustering(2.0f, DamageIndicatorsSameKind);
-
-	for (auto &di : damageIndicatorQueue)
-		clustering.Update(&di);
-
-	for (auto cluster : clustering) {
-		const auto &center = cluster.GetCenter();
-		const DamageIndicator *mean = cluster.GetMeanObject();
-		DamageIndicator total;
+	for (int i = 0; i < numQueuedDamageIndicators; i++)
+		AddDamageIndicator(damageIndicatorQueue[i].di);
 
-		total.ctime = cg.time;
-		total.origin = center;
-		total.layer = mean->layer;
-		total.victim = mean->victim;
-		// velocity is set in AddDamageIndicator
+	numQueuedDamageIndicators = 0;
+}
 
-		total.value = 0;
-		total.lethal = false;
+/**
+ * @brief Create a new damage indicator and add it to the queue, merging it
+ *        with a queued one of the same victim if they are close enough.
+ */
+static void EnqueueDamageIndicator(glm::vec3 point, int flags, float value, int victim)
+{
+	DamageIndicator di;
 
-		for (auto record : cluster) {
-			total.value += record.first->value;
+	di.ctime = cg.time;
+	di.origin = point;
+	di.value = value;
+	di.victim = victim;
 
-			if (record.first->lethal)
-				total.lethal = true;
-		}
+	if (flags & HIT_BUILDING) {
+		bool alien = (CG_MyTeam() == TEAM_ALIENS) ^ !(flags & HIT_FRIENDLY);
 
-		AddDamageIndicator(total);
+		if (alien)
+			di.layer = DIL_ALIEN_BUILDING;
+		else
+			di.layer = DIL_HUMAN_BUILDING;
+	} else {
+		if (flags & HIT_FRIENDLY)
+			di.layer = DIL_TEAMMATE;
+		else
+			di.layer = DIL_ENEMY;
 	}
 
-	damageIndicatorQueue.clear();
-}
-
-/**
- * @brief Move indicators from the queue, merging similar indicators.
- */
-static void DequeueDamageIndicators(void)
-{
-	// most of the time there will be only one or no indicators per frame
-	// so these fast paths will save a lot of time
-	if (damageIndicatorQueue.empty())
-		return;
+	// there will always be only one HIT_LETHAL damage indicator
+	// and it'll be always the last one, so it doesn't need its own layer
+	di.lethal = (flags & HIT_LETHAL) == HIT_LETHAL;
 
-	if (damageIndicatorQueue.size() == 1) {
-		AddDamageIndicator(damageIndicatorQueue.front());
-		damageIndicatorQueue.pop_front();
-		return;
+	for (int i = 0; i < numQueuedDamageIndicators; i++) {
+		QueuedDamageIndicator &queued = damageIndicatorQueue[i];
+
+		if (DamageIndicatorsSameKind(&queued.di, &di) &&
+		    glm::distance(queued.di.origin, point) < DAMAGE_INDICATOR_MERGE_DISTANCE) {
+			// keep the origin at the mean of the merged hits
+			queued.hits++;
+			queued.di.origin += (point - queued.di.origin) / float(queued.hits);
+			queued.di.value += value;
+			queued.di.lethal |= di.lethal;
+			return;
+		}
 	}
 
-	// compute clusterings if there's more than one indicator
-	DequeueDamageIndicators2();
+	if (numQueuedDamageIndicators == MAX_QUEUED_DAMAGE_INDICATORS)
+		DequeueDamageIndicators();
+
+	damageIndicatorQueue[numQueuedDamageIndicators++] = {di, 1};
 }
 
 /**
@@ -332,42 +319,119 @@ static bool CompareDamageIndicators(DamageIndicator *A, DamageIndicator *B)
 	return A->dist < B->dist;
 }
 
+/**
+ * @brief State of a testDamageIndicators run.
+ */
+static struct {
+	int endTime;
+	int hitsPerSecond;
+	float pendingHits;
+	int frames, hits, peak;
+	int totalUsec, maxUsec;
+} stressTest;
+
+static void GenerateStressTestHits()
+{
+	stressTest.pendingHits += stressTest.hitsPerSecond * 0.001f * cg.frametime;
+
+	glm::vec3 center = VEC2GLM(cg.refdef.vieworg) + 300.0f * VEC2GLM(cg.refdef.viewaxis[0]);
+
+	for (; stressTest.pendingHits >= 1.0f; stressTest.pendingHits -= 1.0f) {
+		static const int flags[] = { 0, HIT_FRIENDLY, HIT_BUILDING, HIT_BUILDING | HIT_FRIENDLY };
+		glm::vec3 point = center + glm::vec3(crandom(), crandom(), crandom()) * 150.0f;
+
+		EnqueueDamageIndicator(point, flags[rand() % 4], 1.0f + random() * 20.0f, rand() % 16);
+		stressTest.hits++;
+	}
+}
+
+static void FinishStressTest()
+{
+	int frames = std::max(stressTest.frames, 1);
+
+	Log::Notice("%d hits in %d frames, at most %d indicators alive", stressTest.hits, stressTest.frames, stressTest.peak);
+	Log::Notice("update: %d us average, %d us max", stressTest.totalUsec / frames, stressTest.maxUsec);
+
+	stressTest = {};
+}
+
 /**
  * @brief Evaluate and draw all damage indicators.
  */
 void DrawDamageIndicators(void)
 {
-	std::vector<DamageIndicator*> drawList;
+	BoundedVector<DamageIndicator*, MAX_DAMAGE_INDICATORS> drawList;
+	auto start = Timing::Now();
+
+	if (stressTest.endTime) {
+		if (cg.time >= stressTest.endTime)
+			FinishStressTest();
+		else
+			GenerateStressTestHits();
+	}
 
 	DequeueDamageIndicators();
 
 	if (!damageIndicators_enable.Get()) {
-		if (!damageIndicators.empty())
-			damageIndicators.erase(damageIndicators.begin(),
-		                               damageIndicators.end());
+		numDamageIndicators = 0;
 		return;
 	}
 
-	for (auto i = damageIndicators.begin(); i != damageIndicators.end(); ) {
+	for (int i = 0; i < numDamageIndicators; ) {
 		bool draw;
 
-		if (!EvaluateDamageIndicator(&*i, &draw)) {
-			i = damageIndicators.erase(i);
+		// the last indicator takes the place of an expired one, so
+		// evaluate the same index again
+		if (!EvaluateDamageIndicator(&damageIndicators[i], &draw)) {
+			RemoveDamageIndicator(i);
 			continue;
 		}
 
 		if (draw)
-			drawList.push_back(&*i);
+			drawList.append(&damageIndicators[i]);
 
 		i++;
 	}
 
 	std::sort(drawList.begin(), drawList.end(), CompareDamageIndicators);
 
+	if (stressTest.endTime) {
+		int usec = Timing::Elapsed(start);
+
+		stressTest.frames++;
+		stressTest.totalUsec += usec;
+		stressTest.maxUsec = std::max(stressTest.maxUsec, usec);
+		stressTest.peak = std::max(stressTest.peak, numDamageIndicators);
+	}
+
 	for (auto i: drawList)
 		DrawDamageIndicator(i);
 
 	trap_R_SetColor(Color::White);
 }
 
+class TestDamageIndicatorsCmd : public Cmd::StaticCmd
+{
+public:
+	TestDamageIndicatorsCmd() : StaticCmd("testDamageIndicators",
+		"spawn damage indicators in front of the view to measure their cost: testDamageIndicators [hits per second] [seconds]") {}
+
+	void Run(const Cmd::Args& args) const override
+	{
+		int hitsPerSecond = args.Argc() > 1 ? atoi(args.Argv(1).c_str()) : 5000;
+		int seconds = args.Argc() > 2 ? atoi(args.Argv(2).c_str()) : 5;
+
+		if (hitsPerSecond <= 0 || seconds <= 0) {
+			PrintUsage(args, "[hits per second] [seconds]");
+			return;
+		}
+
+		stressTest = {};
+		stressTest.hitsPerSecond = hitsPerSecond;
+		stressTest.endTime = cg.time + 1000 * seconds;
+		Print("spawning %d damage indicators per second for %d seconds", hitsPerSecond, seconds);
+	}
+};
+static TestDamageIndicatorsCmd testDamageIndicatorsRegistration;
+
 } // namespace CombatFeedback
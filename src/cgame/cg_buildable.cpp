@@ -1478,6 +1478,13 @@ void CG_BuildableStatusParse( const char *filename, buildStat_t *bs )
 #define STATUS_MAX_VIEW_DIST 900.0f
 #define STATUS_PEEK_DIST     20
 
+// Visibility traces are reused until they are this old or the view has moved
+// this far, and only this many of them are refreshed per frame, closest and
+// oldest first.
+#define STATUS_TRACE_INTERVAL   100
+#define STATUS_TRACE_MOVE_DIST  32.0f
+#define STATUS_TRACES_PER_FRAME 6
+
 static Color::Color HealthColorFade( float healthFrac, buildStat_t *bs )
 {
 	healthFrac = Math::Clamp( healthFrac, 0.0f, 1.0f );
@@ -1520,78 +1527,22 @@ static Color::Color DepletionColorFade( float frac, buildStat_t *bs )
 
 /*
 ==================
-CG_BuildableStatusDisplay
+CG_BuildableStatusTrace
+
+Whether the status origin of a buildable can be seen from the view, peeking
+around corners and looking through players and transparent buildables
 ==================
 */
-static void CG_BuildableStatusDisplay( centity_t *cent )
+static bool CG_BuildableStatusTrace( centity_t *cent, const vec3_t origin )
 {
 	entityState_t *es = &cent->currentState;
-	vec3_t        origin;
-	float         healthFrac, mineEfficiencyFrac = 0.0f;
-	int           health = CG_Health(*es);
-	float         x, y;
-	bool          powered, marked, showMineEfficiency;
 	trace_t       tr;
-	float         d;
-	buildStat_t   *bs;
 	int           i, j;
 	int           entNum;
 	vec3_t        trOrigin;
 	vec3_t        right;
 	bool          visible = false;
-	vec3_t        mins, maxs;
-	vec3_t        cullMins, cullMaxs;
 	entityState_t *hit;
-	int           anim;
-	const buildableAttributes_t *attr = BG_Buildable( es->modelindex );
-
-	if ( attr->team == TEAM_ALIENS )
-	{
-		bs = &cgs.alienBuildStat;
-	}
-	else
-	{
-		bs = &cgs.humanBuildStat;
-	}
-
-	if ( !bs->loaded )
-	{
-		return;
-	}
-
-	d = Distance( cent->lerpOrigin, cg.refdef.vieworg );
-
-	if ( d > STATUS_MAX_VIEW_DIST )
-	{
-		return;
-	}
-
-	Color::Color color = bs->foreColor;
-
-	// trace for center point
-	BG_BuildableBoundingBox( es->modelindex, mins, maxs );
-
-	// cull buildings outside the view frustum
-	VectorAdd(cent->lerpOrigin, mins, cullMins);
-	VectorAdd(cent->lerpOrigin, maxs, cullMaxs);
-
-	if(CG_CullBox(cullMins, cullMaxs))
-		return;
-
-	// hack for shrunken barricades
-	anim = CG_AnimNumber( es->torsoAnim );
-
-	if ( es->modelindex == BA_A_BARRICADE &&
-	     ( anim == BANIM_DESTROYED || !( es->eFlags & EF_B_SPAWNED ) ) )
-	{
-		maxs[ 2 ] = ( int )( maxs[ 2 ] * BARRICADE_SHRINKPROP );
-	}
-
-	VectorCopy( cent->lerpOrigin, origin );
-
-	// center point
-	origin[ 2 ] += mins[ 2 ];
-	origin[ 2 ] += ( std::abs( mins[ 2 ] ) + std::abs( maxs[ 2 ] ) ) / 2;
 
 	entNum = cg.predictedPlayerState.clientNum;
 
@@ -1650,6 +1601,151 @@ static void CG_BuildableStatusDisplay( centity_t *cent )
 		}
 	}
 
+	return visible;
+}
+
+/*
+==================
+CG_BuildableStatusTraceAge
+
+How long ago visibility was traced to the status origin, or -1 if it wasn't
+==================
+*/
+static int CG_BuildableStatusTraceAge( const centity_t *cent, const vec3_t origin )
+{
+	const buildableStatus_t *status = &cent->buildableStatus;
+
+	if ( !status->traceTime || !VectorCompare( status->traceEnd, origin ) )
+	{
+		return -1;
+	}
+
+	return std::max( cg.time - status->traceTime, 0 );
+}
+
+/*
+==================
+CG_BuildableStatusTraceStale
+==================
+*/
+static bool CG_BuildableStatusTraceStale( const centity_t *cent, int age )
+{
+	const buildableStatus_t *status = &cent->buildableStatus;
+
+	return age >= STATUS_TRACE_INTERVAL || cg.time < status->traceTime ||
+	       DistanceSquared( status->traceStart, cg.refdef.vieworg ) > Square( STATUS_TRACE_MOVE_DIST );
+}
+
+/*
+==================
+CG_BuildableStatusRetrace
+==================
+*/
+static void CG_BuildableStatusRetrace( centity_t *cent, const vec3_t origin )
+{
+	buildableStatus_t *status = &cent->buildableStatus;
+
+	status->traceVisible = CG_BuildableStatusTrace( cent, origin );
+	status->traceTime = cg.time;
+	VectorCopy( cg.refdef.vieworg, status->traceStart );
+	VectorCopy( origin, status->traceEnd );
+}
+
+/*
+==================
+CG_BuildableStatusVisible
+
+Reuses the last visibility trace, which CG_RefreshBuildableStatusTraces keeps
+up to date, and only traces when there is none for this origin
+==================
+*/
+static bool CG_BuildableStatusVisible( centity_t *cent, const vec3_t origin )
+{
+	if ( CG_BuildableStatusTraceAge( cent, origin ) < 0 )
+	{
+		CG_BuildableStatusRetrace( cent, origin );
+	}
+
+	return cent->buildableStatus.traceVisible;
+}
+
+/*
+==================
+CG_BuildableStatusOrigin
+
+Finds where the status of a buildable is drawn, returns false if the
+buildable is out of view
+==================
+*/
+static bool CG_BuildableStatusOrigin( centity_t *cent, vec3_t origin )
+{
+	entityState_t *es = &cent->currentState;
+	vec3_t        mins, maxs;
+	vec3_t        cullMins, cullMaxs;
+	int           anim;
+
+	// trace for center point
+	BG_BuildableBoundingBox( es->modelindex, mins, maxs );
+
+	// cull buildings outside the view frustum
+	VectorAdd(cent->lerpOrigin, mins, cullMins);
+	VectorAdd(cent->lerpOrigin, maxs, cullMaxs);
+
+	if(CG_CullBox(cullMins, cullMaxs))
+		return false;
+
+	// hack for shrunken barricades
+	anim = CG_AnimNumber( es->torsoAnim );
+
+	if ( es->modelindex == BA_A_BARRICADE &&
+	     ( anim == BANIM_DESTROYED || !( es->eFlags & EF_B_SPAWNED ) ) )
+	{
+		maxs[ 2 ] = ( int )( maxs[ 2 ] * BARRICADE_SHRINKPROP );
+	}
+
+	VectorCopy( cent->lerpOrigin, origin );
+
+	// center point
+	origin[ 2 ] += mins[ 2 ];
+	origin[ 2 ] += ( std::abs( mins[ 2 ] ) + std::abs( maxs[ 2 ] ) ) / 2;
+
+	return true;
+}
+
+/*
+==================
+CG_BuildableStatusDisplay
+==================
+*/
+static void CG_BuildableStatusDisplay( centity_t *cent, const vec3_t origin, float d )
+{
+	entityState_t *es = &cent->currentState;
+	float         healthFrac, mineEfficiencyFrac = 0.0f;
+	int           health = CG_Health(*es);
+	float         x, y;
+	bool          powered, marked, showMineEfficiency;
+	buildStat_t   *bs;
+	bool          visible;
+	const buildableAttributes_t *attr = BG_Buildable( es->modelindex );
+
+	if ( attr->team == TEAM_ALIENS )
+	{
+		bs = &cgs.alienBuildStat;
+	}
+	else
+	{
+		bs = &cgs.humanBuildStat;
+	}
+
+	if ( !bs->loaded )
+	{
+		return;
+	}
+
+	Color::Color color = bs->foreColor;
+
+	visible = CG_BuildableStatusVisible( cent, origin );
+
 	// check if visibility state changed
 	if ( !visible && cent->buildableStatus.visible )
 	{
@@ -1880,17 +1976,66 @@ static void CG_BuildableStatusDisplay( centity_t *cent )
 	}
 }
 
+struct buildableStatusEntry_t
+{
+	float     distSquared;
+	centity_t *cent;
+	vec3_t    origin;
+};
+
 /*
 ==================
 CG_SortDistance
 ==================
 */
-static int CG_SortDistance( const centity_t *a, const centity_t *b )
+static bool CG_SortDistance( const buildableStatusEntry_t &a, const buildableStatusEntry_t &b )
 {
-	float adist = Distance( cg.refdef.vieworg, a->lerpOrigin );
-	float bdist = Distance( cg.refdef.vieworg, b->lerpOrigin );
+	return a.distSquared > b.distSquared;
+}
 
-	return adist > bdist;
+/*
+==================
+CG_RefreshBuildableStatusTraces
+
+Spends the traces of the frame on the stale results that matter most: the
+closest buildables go first, and the others as their result ages, so that when
+the view moves the nearby statuses react at once and far ones still catch up
+==================
+*/
+static void CG_RefreshBuildableStatusTraces( BoundedVector<buildableStatusEntry_t, MAX_GENTITIES> &buildableList )
+{
+	struct staleTrace_t
+	{
+		float                  priority;
+		buildableStatusEntry_t *entry;
+	};
+
+	BoundedVector<staleTrace_t, MAX_GENTITIES> stale;
+
+	for ( buildableStatusEntry_t &entry : buildableList )
+	{
+		int age = CG_BuildableStatusTraceAge( entry.cent, entry.origin );
+
+		// missing results are traced when drawing anyway
+		if ( age >= 0 && CG_BuildableStatusTraceStale( entry.cent, age ) )
+		{
+			// milliseconds of age per unit of distance
+			float dist = std::max( sqrtf( entry.distSquared ), 64.0f );
+			stale.append( { ( age + 1 ) / dist, &entry } );
+		}
+	}
+
+	int count = std::min( static_cast<int>( stale.size() ), STATUS_TRACES_PER_FRAME );
+
+	std::partial_sort( stale.begin(), stale.begin() + count, stale.end(),
+		[]( const staleTrace_t &a, const staleTrace_t &b ) {
+			return a.priority > b.priority;
+		} );
+
+	for ( int i = 0; i < count; i++ )
+	{
+		CG_BuildableStatusRetrace( stale[ i ].entry->cent, stale[ i ].entry->origin );
+	}
 }
 
 /*
@@ -1949,7 +2094,7 @@ or alien builder
 */
 void CG_DrawBuildableStatus()
 {
-	BoundedVector<centity_t *, MAX_GENTITIES> buildableList;
+	BoundedVector<buildableStatusEntry_t, MAX_GENTITIES> buildableList;
 
 	if ( !cg_drawBuildableHealth.Get() )
 	{
@@ -1960,15 +2105,26 @@ void CG_DrawBuildableStatus()
 	{
 		if ( es.eType == entityType_t::ET_BUILDABLE && CG_PlayerIsBuilder( (buildable_t) es.modelindex ) )
 		{
-			buildableList.append(&cg_entities[ es.number ]);
+			centity_t *cent = &cg_entities[ es.number ];
+			float distSquared = DistanceSquared( cent->lerpOrigin, cg.refdef.vieworg );
+
+			vec3_t origin;
+
+			if ( distSquared <= Square( STATUS_MAX_VIEW_DIST ) && CG_BuildableStatusOrigin( cent, origin ) )
+			{
+				buildableList.append( { distSquared, cent, { origin[ 0 ], origin[ 1 ], origin[ 2 ] } } );
+			}
 		}
 	}
 
+	CG_RefreshBuildableStatusTraces( buildableList );
+
+	// draw the farthest first so that closer ones end up on top
 	std::sort( buildableList.begin(), buildableList.end(), CG_SortDistance );
 
-	for ( centity_t *cent : buildableList )
+	for ( const buildableStatusEntry_t &entry : buildableList )
 	{
-		CG_BuildableStatusDisplay( cent );
+		CG_BuildableStatusDisplay( entry.cent, entry.origin, sqrtf( entry.distSquared ) );
 	}
 
 	if ( cg.predictedPlayerState.stats[ STAT_BUILDABLE ] & SB_BUILDABLE_MASK )
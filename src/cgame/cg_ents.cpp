@@ -28,6 +28,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "common/Common.h"
 #include "cg_local.h"
+#include "shared/Parallel.h"
+#include "shared/Timing.h"
 
 #include "EntityCache.h"
 
@@ -865,48 +867,60 @@ void CG_AdjustPositionForMover( const vec3_t in, int moverNum, int fromTime, int
 }
 
 /*
-=============================
-CG_InterpolateEntityPosition
-=============================
+Entity positions are computed for a whole frame at once. The trajectories are
+copied into a packed array, evaluated, in parallel when there are enough
+entities, and the results are copied back. Projectile nudging traces against
+the world, so it is finished afterwards on the main thread.
 */
-static void CG_InterpolateEntityPosition( centity_t *cent )
-{
-	vec3_t current, next;
-	float  f;
-
-	// it would be an internal error to find an entity that interpolates without
-	// a snapshot ahead of the current one
-	if ( cg.nextSnap == nullptr )
-	{
-		Sys::Drop( "CG_InterpolateEntityPosition: cg.nextSnap == NULL" );
-	}
 
-	f = cg.frameInterpolation;
+static Cvar::Cvar<int> cg_parallelLerpThreshold( "cg_parallelLerpThreshold",
+		"number of entities from which their positions are computed in parallel, 0 to never do it",
+		Cvar::NONE, 256 );
 
-	// this will linearize a sine or parabolic curve, but it is important
-	// to not extrapolate player positions if more recent data is available
-	BG_EvaluateTrajectory( &cent->currentState.pos, cg.snap->serverTime, current );
-	BG_EvaluateTrajectory( &cent->nextState.pos, cg.nextSnap->serverTime, next );
-
-	cent->lerpOrigin[ 0 ] = current[ 0 ] + f * ( next[ 0 ] - current[ 0 ] );
-	cent->lerpOrigin[ 1 ] = current[ 1 ] + f * ( next[ 1 ] - current[ 1 ] );
-	cent->lerpOrigin[ 2 ] = current[ 2 ] + f * ( next[ 2 ] - current[ 2 ] );
+enum entityLerpMode_t
+{
+	LERP_INTERPOLATE, // between the current and the next snapshot
+	LERP_EVALUATE,    // extrapolate the current snapshot, then ride movers
+	LERP_NUDGE,       // extrapolate projectiles further, then trace and ride movers
+};
 
-	BG_EvaluateTrajectory( &cent->currentState.apos, cg.snap->serverTime, current );
-	BG_EvaluateTrajectory( &cent->nextState.apos, cg.nextSnap->serverTime, next );
+struct entityLerp_t
+{
+	trajectory_t     pos, apos;
+	trajectory_t     nextPos, nextApos; // only used when interpolating
+	int              time;
+	int              groundEntityNum;   // ENTITYNUM_NONE to not ride movers
+	entityLerpMode_t mode;
+	bool             serial;            // must be evaluated on the main thread
+	vec3_t           origin, angles;
+};
+
+static bool CG_KnownTrajectory( const trajectory_t &tr )
+{
+	switch ( tr.trType )
+	{
+		case trType_t::TR_STATIONARY:
+		case trType_t::TR_INTERPOLATE:
+		case trType_t::TR_LINEAR:
+		case trType_t::TR_LINEAR_STOP:
+		case trType_t::TR_SINE:
+		case trType_t::TR_GRAVITY:
+		case trType_t::TR_BUOYANCY:
+			return true;
 
-	cent->lerpAngles[ 0 ] = LerpAngle( current[ 0 ], next[ 0 ], f );
-	cent->lerpAngles[ 1 ] = LerpAngle( current[ 1 ], next[ 1 ], f );
-	cent->lerpAngles[ 2 ] = LerpAngle( current[ 2 ], next[ 2 ], f );
+		default:
+			return false;
+	}
 }
 
 /*
 ===============
-CG_CalcEntityLerpPositions
+CG_PrepareEntityLerp
 
+Decides how to compute the position of an entity and copies what it needs.
 ===============
 */
-static void CG_CalcEntityLerpPositions( centity_t *cent )
+static void CG_PrepareEntityLerp( centity_t *cent, entityLerp_t &lerp )
 {
 	// this will be set to how far forward projectiles will be extrapolated
 	int timeshift = 0;
@@ -922,18 +936,27 @@ static void CG_CalcEntityLerpPositions( centity_t *cent )
 		}
 	}
 
-	if ( cent->interpolate && cent->currentState.pos.trType == trType_t::TR_INTERPOLATE )
-	{
-		CG_InterpolateEntityPosition( cent );
-		return;
-	}
+	lerp.pos = cent->currentState.pos;
+	lerp.apos = cent->currentState.apos;
 
-	// first see if we can interpolate between two snaps for
+	// first see if we can interpolate between two snaps, also for
 	// linear extrapolated clients
-	if ( cent->interpolate && cent->currentState.pos.trType == trType_t::TR_LINEAR_STOP &&
-	     cent->currentState.number < MAX_CLIENTS )
+	if ( cent->interpolate &&
+	     ( cent->currentState.pos.trType == trType_t::TR_INTERPOLATE ||
+	       ( cent->currentState.pos.trType == trType_t::TR_LINEAR_STOP && cent->currentState.number < MAX_CLIENTS ) ) )
 	{
-		CG_InterpolateEntityPosition( cent );
+		// it would be an internal error to find an entity that interpolates without
+		// a snapshot ahead of the current one
+		if ( cg.nextSnap == nullptr )
+		{
+			Sys::Drop( "CG_PrepareEntityLerp: cg.nextSnap == NULL" );
+		}
+
+		lerp.mode = LERP_INTERPOLATE;
+		lerp.nextPos = cent->nextState.pos;
+		lerp.nextApos = cent->nextState.apos;
+		lerp.serial = !CG_KnownTrajectory( lerp.pos ) || !CG_KnownTrajectory( lerp.apos ) ||
+		              !CG_KnownTrajectory( lerp.nextPos ) || !CG_KnownTrajectory( lerp.nextApos );
 		return;
 	}
 
@@ -945,38 +968,251 @@ static void CG_CalcEntityLerpPositions( centity_t *cent )
 		timeshift = cg.ping;
 	}
 
-	// just use the current frame and evaluate as best we can
-	BG_EvaluateTrajectory( &cent->currentState.pos,
-	                       ( cg.time + timeshift ), cent->lerpOrigin );
-	BG_EvaluateTrajectory( &cent->currentState.apos,
-	                       ( cg.time + timeshift ), cent->lerpAngles );
+	lerp.mode = timeshift ? LERP_NUDGE : LERP_EVALUATE;
+	lerp.time = cg.time + timeshift;
 
-	if ( timeshift )
-	{
-		trace_t tr;
-		vec3_t  lastOrigin;
+	// adjust for riding a mover if it wasn't rolled into the predicted
+	// player state
+	lerp.groundEntityNum = cent != &cg.predictedPlayerEntity ? cent->currentState.groundEntityNum : ENTITYNUM_NONE;
+	lerp.serial = !CG_KnownTrajectory( lerp.pos ) || !CG_KnownTrajectory( lerp.apos );
+}
 
-		BG_EvaluateTrajectory( &cent->currentState.pos, cg.time, lastOrigin );
+/*
+===============
+CG_EvaluateEntityLerp
 
-		CG_Trace( &tr, lastOrigin, vec3_origin, vec3_origin, cent->lerpOrigin,
-		          cent->currentState.number, MASK_SHOT, 0 );
+Only reads the snapshots and the entity states, so it can run on any thread.
+===============
+*/
+static void CG_EvaluateEntityLerp( entityLerp_t &lerp )
+{
+	vec3_t current, next;
 
-		// don't let the projectile go through the floor
-		if ( tr.fraction < 1.0f )
+	switch ( lerp.mode )
+	{
+		case LERP_INTERPOLATE:
 		{
-			VectorLerpTrem( tr.fraction, lastOrigin, cent->lerpOrigin, cent->lerpOrigin );
+			float f = cg.frameInterpolation;
+
+			// this will linearize a sine or parabolic curve, but it is important
+			// to not extrapolate player positions if more recent data is available
+			BG_EvaluateTrajectory( &lerp.pos, cg.snap->serverTime, current );
+			BG_EvaluateTrajectory( &lerp.nextPos, cg.nextSnap->serverTime, next );
+
+			lerp.origin[ 0 ] = current[ 0 ] + f * ( next[ 0 ] - current[ 0 ] );
+			lerp.origin[ 1 ] = current[ 1 ] + f * ( next[ 1 ] - current[ 1 ] );
+			lerp.origin[ 2 ] = current[ 2 ] + f * ( next[ 2 ] - current[ 2 ] );
+
+			BG_EvaluateTrajectory( &lerp.apos, cg.snap->serverTime, current );
+			BG_EvaluateTrajectory( &lerp.nextApos, cg.nextSnap->serverTime, next );
+
+			lerp.angles[ 0 ] = LerpAngle( current[ 0 ], next[ 0 ], f );
+			lerp.angles[ 1 ] = LerpAngle( current[ 1 ], next[ 1 ], f );
+			lerp.angles[ 2 ] = LerpAngle( current[ 2 ], next[ 2 ], f );
+			break;
 		}
+
+		case LERP_EVALUATE:
+			// just use the current frame and evaluate as best we can
+			BG_EvaluateTrajectory( &lerp.pos, lerp.time, lerp.origin );
+			BG_EvaluateTrajectory( &lerp.apos, lerp.time, lerp.angles );
+
+			if ( lerp.groundEntityNum != ENTITYNUM_NONE )
+			{
+				CG_AdjustPositionForMover( lerp.origin, lerp.groundEntityNum,
+				                           cg.snap->serverTime, cg.time, lerp.origin, lerp.angles, lerp.angles );
+			}
+			break;
+
+		case LERP_NUDGE:
+			BG_EvaluateTrajectory( &lerp.pos, lerp.time, lerp.origin );
+			BG_EvaluateTrajectory( &lerp.apos, lerp.time, lerp.angles );
+			break;
 	}
+}
 
-	// adjust for riding a mover if it wasn't rolled into the predicted
-	// player state
-	if ( cent != &cg.predictedPlayerEntity )
+/*
+===============
+CG_FinishEntityLerp
+
+Stores the position of an entity, after doing what can only be done on the main thread.
+===============
+*/
+static void CG_FinishEntityLerp( centity_t *cent, const entityLerp_t &lerp )
+{
+	VectorCopy( lerp.origin, cent->lerpOrigin );
+	VectorCopy( lerp.angles, cent->lerpAngles );
+
+	if ( lerp.mode != LERP_NUDGE )
 	{
-		CG_AdjustPositionForMover( cent->lerpOrigin, cent->currentState.groundEntityNum,
+		return;
+	}
+
+	trace_t tr;
+	vec3_t  lastOrigin;
+
+	BG_EvaluateTrajectory( &lerp.pos, cg.time, lastOrigin );
+
+	CG_Trace( &tr, lastOrigin, vec3_origin, vec3_origin, cent->lerpOrigin,
+	          cent->currentState.number, MASK_SHOT, 0 );
+
+	// don't let the projectile go through the floor
+	if ( tr.fraction < 1.0f )
+	{
+		VectorLerpTrem( tr.fraction, lastOrigin, cent->lerpOrigin, cent->lerpOrigin );
+	}
+
+	if ( lerp.groundEntityNum != ENTITYNUM_NONE )
+	{
+		CG_AdjustPositionForMover( cent->lerpOrigin, lerp.groundEntityNum,
 		                           cg.snap->serverTime, cg.time, cent->lerpOrigin, cent->lerpAngles, cent->lerpAngles );
 	}
 }
 
+/*
+===============
+CG_CalcEntityLerpPositions
+
+===============
+*/
+static void CG_CalcEntityLerpPositions( centity_t *cent )
+{
+	entityLerp_t lerp;
+
+	CG_PrepareEntityLerp( cent, lerp );
+	CG_EvaluateEntityLerp( lerp );
+	CG_FinishEntityLerp( cent, lerp );
+}
+
+/*
+===============
+CG_CalcEntitiesLerpPositions
+
+Computes the positions of all the given entities, spread over the worker
+threads when there are at least parallelThreshold of them.
+===============
+*/
+static void CG_CalcEntitiesLerpPositions( const std::vector<centity_t *> &cents, int parallelThreshold )
+{
+	static std::vector<entityLerp_t> lerps;
+
+	lerps.resize( cents.size() );
+
+	for ( size_t i = 0; i < cents.size(); i++ )
+	{
+		CG_PrepareEntityLerp( cents[ i ], lerps[ i ] );
+
+		// let a bad trajectory drop the game from the main thread
+		if ( lerps[ i ].serial )
+		{
+			CG_EvaluateEntityLerp( lerps[ i ] );
+		}
+	}
+
+	Parallel::For( lerps.size(), parallelThreshold > 0 ? parallelThreshold : INT_MAX, []( int begin, int end ) {
+		for ( int i = begin; i < end; i++ )
+		{
+			if ( !lerps[ i ].serial )
+			{
+				CG_EvaluateEntityLerp( lerps[ i ] );
+			}
+		}
+	} );
+
+	for ( size_t i = 0; i < cents.size(); i++ )
+	{
+		CG_FinishEntityLerp( cents[ i ], lerps[ i ] );
+	}
+}
+
+// Replays the current snapshots through the entity position code, checks that
+// batching doesn't change the results and reports timings.
+class BenchmarkEntityLerpCmd : public Cmd::StaticCmd
+{
+public:
+	BenchmarkEntityLerpCmd() : StaticCmd( "benchmarkEntityLerp",
+		"time the computation of entity positions: benchmarkEntityLerp [iterations] [copies of each entity]" ) {}
+
+	void Run( const Cmd::Args &args ) const override
+	{
+		if ( !cg.snap )
+		{
+			Print( "No snapshot to replay" );
+			return;
+		}
+
+		int iterations = args.Argc() > 1 ? std::max( 1, atoi( args.Argv( 1 ).c_str() ) ) : 100;
+		int copies = args.Argc() > 2 ? std::max( 1, atoi( args.Argv( 2 ).c_str() ) ) : 1;
+
+		std::vector<centity_t *> cents;
+		for ( int copy = 0; copy < copies; copy++ )
+		{
+			for ( const entityState_t &ent : cg.snap->entities )
+			{
+				centity_t *cent = &cg_entities[ ent.number ];
+
+				if ( cent->currentState.eType < entityType_t::ET_EVENTS )
+				{
+					cents.push_back( cent );
+				}
+			}
+		}
+
+		// per entity, as it used to be done
+		std::vector<std::array<float, 6>> reference( cents.size() );
+		auto start = Timing::Now();
+		for ( int iteration = 0; iteration < iterations; iteration++ )
+		{
+			for ( centity_t *cent : cents )
+			{
+				CG_CalcEntityLerpPositions( cent );
+			}
+		}
+		int serialUsec = Timing::Elapsed( start );
+
+		for ( size_t i = 0; i < cents.size(); i++ )
+		{
+			VectorCopy( cents[ i ]->lerpOrigin, &reference[ i ][ 0 ] );
+			VectorCopy( cents[ i ]->lerpAngles, &reference[ i ][ 3 ] );
+		}
+
+		int batchedUsec = Batch( cents, iterations, 0 );
+		bool batchedSame = Compare( cents, reference );
+		int parallelUsec = Batch( cents, iterations, 1 );
+		bool parallelSame = Compare( cents, reference );
+
+		Print( "%d entities, %d iterations, %d worker threads", static_cast<int>( cents.size() ), iterations, Parallel::NumThreads() );
+		Print( "per entity: %d us", serialUsec / iterations );
+		Print( "batched:    %d us%s", batchedUsec / iterations, batchedSame ? "" : " ^1(results differ)" );
+		Print( "parallel:   %d us%s", parallelUsec / iterations, parallelSame ? "" : " ^1(results differ)" );
+	}
+
+private:
+	static int Batch( const std::vector<centity_t *> &cents, int iterations, int parallelThreshold )
+	{
+		auto start = Timing::Now();
+		for ( int iteration = 0; iteration < iterations; iteration++ )
+		{
+			CG_CalcEntitiesLerpPositions( cents, parallelThreshold );
+		}
+		return Timing::Elapsed( start );
+	}
+
+	static bool Compare( const std::vector<centity_t *> &cents, const std::vector<std::array<float, 6>> &reference )
+	{
+		for ( size_t i = 0; i < cents.size(); i++ )
+		{
+			if ( !VectorCompare( cents[ i ]->lerpOrigin, &reference[ i ][ 0 ] ) ||
+			     !VectorCompare( cents[ i ]->lerpAngles, &reference[ i ][ 3 ] ) )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+};
+static BenchmarkEntityLerpCmd benchmarkEntityLerpCmdRegistration;
+
 /*
 ===============
 CG_CEntityPVSEnter
@@ -1117,7 +1353,7 @@ CG_AddCEntity
 
 ===============
 */
-static void CG_AddCEntity( centity_t *cent )
+static void CG_AddCEntity( centity_t *cent, bool calcLerpPositions )
 {
 	// event-only entities will have been dealt with already
 	if ( cent->currentState.eType >= entityType_t::ET_EVENTS )
@@ -1125,8 +1361,11 @@ static void CG_AddCEntity( centity_t *cent )
 		return;
 	}
 
-	// calculate the current origin
-	CG_CalcEntityLerpPositions( cent );
+	// calculate the current origin, unless done for the whole frame
+	if ( calcLerpPositions )
+	{
+		CG_CalcEntityLerpPositions( cent );
+	}
 
 	// add automatic effects
 	CG_EntityEffects( cent );
@@ -1251,11 +1490,28 @@ void CG_AddPacketEntities()
 	cg.predictedPlayerEntity.valid = true;
 	cg.predictedPlayerEntity.refEntitiesFrame ^= 1;
 	cg.predictedPlayerEntity.refEntitiesFrameCount[cg.predictedPlayerEntity.refEntitiesFrame] = 0;
-	CG_AddCEntity( &cg.predictedPlayerEntity );
+	CG_AddCEntity( &cg.predictedPlayerEntity, true );
 
 	// lerp the non-predicted value for lightning gun origins
 	CG_CalcEntityLerpPositions( &cg_entities[ cg.snap->ps.clientNum ] );
 
+	// calculate the current origin of each entity sent over by the server
+	static std::vector<centity_t *> lerpCents;
+	lerpCents.clear();
+
+	for ( const entityState_t &ent : cg.snap->entities )
+	{
+		centity_t *cent = &cg_entities[ ent.number ];
+
+		if ( cent->currentState.eType < entityType_t::ET_EVENTS )
+		{
+			lerpCents.push_back( cent );
+		}
+	}
+
+	Parallel::SetNumThreads( cg_workerThreads.Get() );
+	CG_CalcEntitiesLerpPositions( lerpCents, cg_parallelLerpThreshold.Get() );
+
 	bool done[ MAX_GENTITIES ] = {};
 
 	int highest = 0;
@@ -1280,7 +1536,7 @@ void CG_AddPacketEntities()
 
 		cent->refEntitiesFrame ^= 1;
 		cent->refEntitiesFrameCount[cent->refEntitiesFrame] = 0;
-		CG_AddCEntity( cent );
+		CG_AddCEntity( cent, false );
 
 		if ( cent != &cg.predictedPlayerEntity ) {
 			uint8_t lastFrameCount = cent->refEntitiesFrameCount[cent->refEntitiesFrame];
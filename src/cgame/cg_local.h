@@ -634,6 +634,10 @@ struct buildableStatus_t
 {
 	int      lastTime; // Last time status was visible
 	bool visible; // Status is visible?
+	int      traceTime; // Last time visibility was traced, 0 if never
+	bool     traceVisible; // Result of that trace
+	vec3_t   traceStart; // View origin it was traced from
+	vec3_t   traceEnd; // Status origin it was traced to
 };
 
 struct buildableCache_t
@@ -1370,27 +1374,51 @@ struct rocketMenu_t
 	bool passthrough; // whether binds can be used while the menu is open
 };
 
-#define MAX_SERVERS 2048
 #define MAX_LANGUAGES 64
 #define MAX_OUTPUTS 16
 #define MAX_MODS 64
 #define MAX_DEMOS 256
 
-struct server_t
+enum serverSortKey_t
 {
-	char *name;
-	char *label;
-	std::string version;
-	std::string abiVersion;
-	int clients;
-	int bots;
-	int ping;
-	int maxClients;
-	char *mapName;
-	char *addr;
+	SERVER_SORT_NONE, // in order of arrival
+	SERVER_SORT_NAME,
+	SERVER_SORT_VERSION,
+	SERVER_SORT_MAP,
+	SERVER_SORT_PLAYERS,
+	SERVER_SORT_PING,
+	SERVER_SORT_NUM
 };
 
+// Servers of one net source, stored by column. A server is identified by its
+// index in the columns, which stays valid until the list is cleared.
+struct serverList_t
+{
+	std::vector<std::string> names;
+	std::vector<std::string> cleanNames; // without colors and lowercase, to sort and filter by
+	std::vector<std::string> labels;
+	std::vector<std::string> versions;
+	std::vector<std::string> abiVersions;
+	std::vector<std::string> mapNames;
+	std::vector<std::string> addrs;
+	std::vector<int> clients;
+	std::vector<int> bots;
+	std::vector<int> pings;
+	std::vector<int> maxClients;
+
+	// server indices ordered by each sort key, kept sorted as servers arrive
+	std::vector<int> sorted[ SERVER_SORT_NUM ];
+	serverSortKey_t sortKey;
+
+	// lowercase filter and whether each server's clean name contains it
+	std::string filter;
+	std::vector<bool> matches;
 
+	// server indices of the rows currently in the data source table
+	std::vector<int> rows;
+
+	int Size() const { return names.size(); }
+};
 
 // 2 positive numbers is a resolution from the r_availableModes list
 // 2 negative numbers - their absolute values are a resolution not in that list
@@ -1431,8 +1459,7 @@ struct mapInfo_t
 
 struct rocketDataSource_t
 {
-	server_t servers[ AS_NUM_TYPES ][ MAX_SERVERS ];
-	int serverCount[ AS_NUM_TYPES ];
+	serverList_t serverLists[ AS_NUM_TYPES ];
 	std::vector<bool> haveServerInfo[ AS_NUM_TYPES ];
 	int serverIndex[ AS_NUM_TYPES ];
 	bool buildingServerInfo;
@@ -1923,6 +1950,7 @@ extern Cvar::Cvar<bool> cg_debugVoices;
 
 extern Cvar::Cvar<bool> cg_optimizePrediction;
 extern Cvar::Cvar<bool> cg_projectileNudge;
+extern Cvar::Range<Cvar::Cvar<int>> cg_workerThreads;
 
 extern Cvar::Cvar<bool> cg_emoticonsInMessages;
 
@@ -2303,7 +2331,39 @@ enum {
 //
 // cg_utils.c
 //
-bool   CG_ParseColor( byte *c, const char **text_p );
+
+// A script read on the main thread for a job to parse. Jobs can't log, so
+// their messages are kept until Flush.
+struct cgScript_t
+{
+	std::string name;
+	std::string text;
+	std::vector<std::pair<Log::Level, std::string>> messages;
+
+	template<typename... Args>
+	void Warn( Str::StringRef format, Args&&... args )
+	{
+		messages.emplace_back( Log::Level::WARNING, Str::Format( format, std::forward<Args>( args )... ) );
+	}
+
+	template<typename... Args>
+	void Notice( Str::StringRef format, Args&&... args )
+	{
+		messages.emplace_back( Log::Level::NOTICE, Str::Format( format, std::forward<Args>( args )... ) );
+	}
+
+	template<typename... Args>
+	void Debug( Str::StringRef format, Args&&... args )
+	{
+		messages.emplace_back( Log::Level::DEBUG, Str::Format( format, std::forward<Args>( args )... ) );
+	}
+
+	void Flush( Log::Logger &logger );
+};
+
+std::vector<std::string> CG_ScriptFiles( const char *extension, int maxFiles );
+bool CG_ReadScript( cgScript_t &script, const std::string &fileName );
+bool   CG_ParseColor( byte *c, const char **text_p, cgScript_t &script );
 void       CG_ReadableSize( char *buf, int bufsize, int value );
 void       CG_PrintTime( char *buf, int bufsize, int time );
 void CG_SetKeyCatcher( int catcher );
@@ -2384,6 +2444,7 @@ bool Rocket_GetEvent(std::string& cmdText);
 void Rocket_DeleteEvent();
 void Rocket_RegisterDataSource( const char *name );
 void Rocket_DSAddRow( const char *name, const char *table, const char *data );
+void Rocket_DSInsertRow( const char *name, const char *table, const int row, const char *data );
 void Rocket_DSChangeRow( const char *name, const char *table, const int row, const char *data );
 void Rocket_DSRemoveRow( const char *name, const char *table, const int row );
 void Rocket_DSClearTable( const char *name, const char *table );
@@ -167,6 +167,10 @@ static Cvar::Cvar<int> cg_navgenMaxThreads(
 	"cg_navgenMaxThreads", "Maximum number of threads to use when generating navmeshes",
 	Cvar::NONE, std::max(1, int(std::thread::hardware_concurrency()) - 1));
 
+Cvar::Range<Cvar::Cvar<int>> cg_workerThreads(
+	"cg_workerThreads", "number of threads helping the main thread with parallel work, 0 to disable",
+	Cvar::NONE, std::max(0, std::min(3, int(std::thread::hardware_concurrency()) - 1)), 0, 32);
+
 // search 'fovCvar' to find usage of these (names come from config files)
 // 0 means use global FOV setting
 static Cvar::Cvar<float> cg_fov_builder("cg_fov_builder", "field of view (degrees) for Granger", Cvar::NONE, 0);
@@ -443,6 +447,73 @@ enum cgLoadingStep_t {
 	LOAD_DONE
 };
 
+static Log::Logger loadingLog("cgame.loading", "[loading]");
+
+// Timings of the last map load, so that join time can be measured and
+// regressions caught with /loadingTimes.
+static const char *loadingStepLabels[ LOAD_DONE + 1 ];
+static int loadingStepTimes[ LOAD_DONE + 1 ];
+static int loadingStep = LOAD_START;
+static int loadingStepStartTime;
+static int loadingStartTime;
+static int loadingTotalTime = -1;
+
+static void CG_RecordLoadingTime( cgLoadingStep_t step )
+{
+	int now = trap_Milliseconds();
+
+	if ( step == LOAD_START )
+	{
+		memset( loadingStepLabels, 0, sizeof( loadingStepLabels ) );
+		memset( loadingStepTimes, 0, sizeof( loadingStepTimes ) );
+		loadingStartTime = now;
+		loadingTotalTime = -1;
+	}
+	else
+	{
+		int elapsed = now - loadingStepStartTime;
+
+		loadingStepTimes[ loadingStep ] += elapsed;
+		loadingLog.Verbose( "%s took %d ms.", loadingStepLabels[ loadingStep ], elapsed );
+	}
+
+	loadingStep = step;
+	loadingStepStartTime = now;
+
+	// the GLSL step is finished by the engine after CG_Init returns
+	if ( step == LOAD_GLSL || step == LOAD_DONE )
+	{
+		loadingTotalTime = now - loadingStartTime;
+		loadingLog.Verbose( "Map loaded in %d ms.", loadingTotalTime );
+	}
+}
+
+class LoadingTimesCmd : public Cmd::StaticCmd
+{
+public:
+	LoadingTimesCmd() : StaticCmd( "loadingTimes", "print how long each step of the last map load took" ) {}
+
+	void Run( const Cmd::Args& ) const override
+	{
+		if ( loadingTotalTime < 0 )
+		{
+			Print( "No map load has completed yet." );
+			return;
+		}
+
+		for ( int step = LOAD_START; step < loadingStep; step++ )
+		{
+			if ( loadingStepLabels[ step ] )
+			{
+				Print( "%-20s %6d ms", loadingStepLabels[ step ], loadingStepTimes[ step ] );
+			}
+		}
+
+		Print( "%-20s %6d ms", "Total", loadingTotalTime );
+	}
+};
+static LoadingTimesCmd loadingTimesCmdRegistration;
+
 /*
 ======================
 CG_UpdateLoadingProgress
@@ -454,6 +525,8 @@ static void CG_UpdateLoadingProgress( int step, const char *label, const char* l
 {
 	cg.loadingFraction = ( 1.0f * step ) / LOAD_DONE;
 
+	loadingStepLabels[ step ] = label;
+
 	cg.loadingText = loadingText;
 
 	Log::Debug( "CG_Init: %d%% %s.", static_cast<int>( 100 * cg.loadingFraction ), label );
@@ -466,6 +539,8 @@ static void CG_UpdateLoadingProgress( int step, const char *label, const char* l
 
 static void CG_UpdateLoadingStep( cgLoadingStep_t step )
 {
+	CG_RecordLoadingTime( step );
+
 	switch (step) {
 		case LOAD_START:
 			/* Note: this is too early to do screen updates,
@@ -29,6 +29,10 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "common/FileSystem.h"
 #include "common/cm/cm_public.h"
 #include "cg_local.h"
+#include "shared/Parallel.h"
+#include "shared/parse.h"
+
+#include <deque>
 
 static Log::Logger logger("cgame.particles", "[Particle Systems]");
 
@@ -39,6 +43,15 @@ static int                   numBaseParticleSystems = 0;
 static int                   numBaseParticleEjectors = 0;
 static int                   numBaseParticles = 0;
 
+// What a job parsed from a particle file, before it is added to the above.
+// The deques keep the parsed ejectors and particles where they are pointed to.
+struct particleScript_t : cgScript_t
+{
+	std::vector<baseParticleSystem_t>  systems;
+	std::deque<baseParticleEjector_t> ejectors;
+	std::deque<baseParticle_t>        particles;
+};
+
 static particleSystem_t      particleSystems[ MAX_PARTICLE_SYSTEMS ];
 static particleEjector_t     particleEjectors[ MAX_PARTICLE_EJECTORS ];
 static particle_t            particles[ MAX_PARTICLES ];
@@ -704,9 +717,11 @@ CG_ParseParticle helpers
 */
 static void CG_CopyLine( int *i, char *toks, int num, size_t size, const char **text_p )
 {
+	char tokenBuffer[ MAX_TOKEN_CHARS ];
+
 	while( *i < num )
 	{
-		const char *token = COM_ParseExt( text_p, false );
+		const char *token = COM_ParseExt_r( text_p, false, tokenBuffer );
 
 		if ( !*token )
 		{
@@ -722,7 +737,8 @@ static void CG_CopyLine( int *i, char *toks, int num, size_t size, const char **
 
 static bool CG_ParseType( pMoveType_t *pmt, const char **text_p )
 {
-	const char *token = COM_Parse( text_p );
+	char tokenBuffer[ MAX_TOKEN_CHARS ];
+	const char *token = COM_Parse_r( text_p, tokenBuffer );
 
 	if( !*token )
 	{
@@ -763,7 +779,8 @@ static bool CG_ParseType( pMoveType_t *pmt, const char **text_p )
 
 static bool CG_ParseDir( pMoveValues_t *pmv, const char **text_p )
 {
-	const char *token = COM_Parse( text_p );
+	char tokenBuffer[ MAX_TOKEN_CHARS ];
+	const char *token = COM_Parse_r( text_p, tokenBuffer );
 
 	if ( !*token )
 	{
@@ -784,7 +801,8 @@ static bool CG_ParseDir( pMoveValues_t *pmv, const char **text_p )
 
 static bool CG_ParseFinal( pLerpValues_t *plv, const char **text_p, bool allowNegative )
 {
-	const char *token = COM_Parse( text_p );
+	char tokenBuffer[ MAX_TOKEN_CHARS ];
+	const char *token = COM_Parse_r( text_p, tokenBuffer );
 
 	if( !*token )
 	{
@@ -811,12 +829,14 @@ CG_ParseParticle
 Parse a particle section
 ===============
 */
-static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char **text_p )
+static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char **text_p, cgScript_t &script )
 {
+	char tokenBuffer[ MAX_TOKEN_CHARS ];
+
 	// read optional parameters
 	while ( 1 )
 	{
-		const char *token = COM_Parse( text_p );
+		const char *token = COM_Parse_r( text_p, tokenBuffer );
 
 		if ( !*token )
 		{
@@ -825,7 +845,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 
 		if ( !Q_stricmp( token, "bounce" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -846,7 +866,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "bounceMark" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -855,7 +875,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 
 			CG_ParseValueAndVariance( token, &bp->bounceMarkCount, &bp->bounceMarkCountRandFrac, false );
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -864,7 +884,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 
 			CG_ParseValueAndVariance( token, &bp->bounceMarkRadius, &bp->bounceMarkRadiusRandFrac, false );
 
-			token = COM_ParseExt( text_p, false );
+			token = COM_ParseExt_r( text_p, false, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -875,7 +895,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "bounceSound" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -884,7 +904,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 
 			CG_ParseValueAndVariance( token, &bp->bounceSoundCount, &bp->bounceSoundCountRandFrac, false );
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -897,12 +917,12 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		{
 			if ( bp->numModels > 0 )
 			{
-				logger.Warn("'shader' not allowed in "
-				           "conjunction with 'model'" );
+				script.Warn( "'shader' not allowed in "
+				             "conjunction with 'model'" );
 				break;
 			}
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -924,8 +944,8 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		{
 			if ( bp->numFrames > 0 )
 			{
-				logger.Warn("'model' not allowed in "
-				           "conjunction with 'shader'" );
+				script.Warn( "'model' not allowed in "
+				             "conjunction with 'shader'" );
 				break;
 			}
 
@@ -933,7 +953,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "modelAnimation" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -942,7 +962,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 
 			bp->modelAnimation.firstFrame = atoi_neg( token, false );
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -960,7 +980,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 				bp->modelAnimation.reversed = true;
 			}
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -970,11 +990,11 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 			bp->modelAnimation.loopFrames = atoi( token );
 			if ( bp->modelAnimation.loopFrames && bp->modelAnimation.loopFrames != bp->modelAnimation.numFrames )
 			{
-				logger.Warn("CG_ParseParticle: loopFrames != numFrames");
+				script.Warn( "CG_ParseParticle: loopFrames != numFrames");
 				bp->modelAnimation.loopFrames = bp->modelAnimation.numFrames;
 			}
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1016,7 +1036,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "velocityMagnitude" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1027,7 +1047,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "parentVelocityFraction" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1040,7 +1060,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		{
 			for ( int i = 0; i <= 2; i++ )
 			{
-				token = COM_Parse( text_p );
+				token = COM_Parse_r( text_p, tokenBuffer );
 
 				if ( !*token )
 				{
@@ -1050,7 +1070,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 				bp->velMoveValues.dir[ i ] = atof_neg( token, true );
 			}
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1063,7 +1083,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		{
 			for ( int i = 0; i <= 2; i++ )
 			{
-				token = COM_Parse( text_p );
+				token = COM_Parse_r( text_p, tokenBuffer );
 
 				if ( !*token )
 				{
@@ -1073,7 +1093,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 				bp->velMoveValues.point[ i ] = atof_neg( token, true );
 			}
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1099,7 +1119,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "accelerationMagnitude" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1112,7 +1132,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		{
 			for ( int i = 0; i <= 2; i++ )
 			{
-				token = COM_Parse( text_p );
+				token = COM_Parse_r( text_p, tokenBuffer );
 
 				if ( !*token )
 				{
@@ -1122,7 +1142,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 				bp->accMoveValues.dir[ i ] = atof_neg( token, true );
 			}
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1135,7 +1155,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		{
 			for ( int i = 0; i <= 2; i++ )
 			{
-				token = COM_Parse( text_p );
+				token = COM_Parse_r( text_p, tokenBuffer );
 
 				if ( !*token )
 				{
@@ -1145,7 +1165,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 				bp->accMoveValues.point[ i ] = atof_neg( token, true );
 			}
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1159,7 +1179,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		{
 			for ( int i = 0; i <= 2; i++ )
 			{
-				token = COM_Parse( text_p );
+				token = COM_Parse_r( text_p, tokenBuffer );
 
 				if ( !*token )
 				{
@@ -1174,7 +1194,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 			// additional displacement in all three directions, for compatibility
 			// with the old scripts where this was the only option
 			float randFrac = 0;
-			token = COM_ParseExt( text_p, false );
+			token = COM_ParseExt_r( text_p, false, tokenBuffer );
 
 			if ( token )
 			{
@@ -1194,7 +1214,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "normalDisplacement" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1209,7 +1229,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "realLight" ) )
 		{
-			Log::Warn( "Particle system %s: realLight keyword is deprecated, use a diffuseMap stage to light particles instead",
+			script.Warn( "Particle system %s: realLight keyword is deprecated, use a diffuseMap stage to light particles instead",
 				name );
 			bp->realLight = true;
 		}
@@ -1217,7 +1237,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		{
 			bp->dynamicLight = true;
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1228,7 +1248,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 			CG_ParseValueAndVariance( token, &number, &bp->dLightRadius.delayRandFrac, false );
 			bp->dLightRadius.delay = ( int ) number;
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1242,7 +1262,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 				break;
 			}
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1251,7 +1271,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 
 			if ( !Q_stricmp( token, "{" ) )
 			{
-				if ( !CG_ParseColor( bp->dLightColor, text_p ) )
+				if ( !CG_ParseColor( bp->dLightColor, text_p, script ) )
 				{
 					break;
 				}
@@ -1263,7 +1283,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "radius" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1274,7 +1294,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 			CG_ParseValueAndVariance( token, &number, &bp->radius.delayRandFrac, false );
 			bp->radius.delay = ( int ) number;
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1290,7 +1310,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "physicsRadius" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1301,7 +1321,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "alpha" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1312,7 +1332,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 			CG_ParseValueAndVariance( token, &number, &bp->alpha.delayRandFrac, false );
 			bp->alpha.delay = ( int ) number;
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1328,7 +1348,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "color" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1339,7 +1359,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 			CG_ParseValueAndVariance( token, &number, &bp->colorDelayRandFrac, false );
 			bp->colorDelay = ( int ) number;
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1348,12 +1368,12 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 
 			if ( !Q_stricmp( token, "{" ) )
 			{
-				if ( !CG_ParseColor( bp->initialColor, text_p ) )
+				if ( !CG_ParseColor( bp->initialColor, text_p, script ) )
 				{
 					break;
 				}
 
-				token = COM_Parse( text_p );
+				token = COM_Parse_r( text_p, tokenBuffer );
 
 				if ( !*token )
 				{
@@ -1368,26 +1388,26 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 				}
 				else if ( !Q_stricmp( token, "{" ) )
 				{
-					if ( !CG_ParseColor( bp->finalColor, text_p ) )
+					if ( !CG_ParseColor( bp->finalColor, text_p, script ) )
 					{
 						break;
 					}
 				}
 				else
 				{
-					logger.Warn( "missing '{'" );
+					script.Warn( "missing '{'" );
 					break;
 				}
 			}
 			else
 			{
-				logger.Warn( "missing '{'" );
+				script.Warn( "missing '{'" );
 				break;
 			}
 		}
 		else if ( !Q_stricmp( token, "rotation" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1398,7 +1418,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 			CG_ParseValueAndVariance( token, &number, &bp->rotation.delayRandFrac, false );
 			bp->rotation.delay = ( int ) number;
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1414,7 +1434,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "lifeTime" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1427,7 +1447,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "childSystem" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1438,7 +1458,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "onDeathSystem" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1449,7 +1469,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "childTrailSystem" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1460,7 +1480,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else if ( !Q_stricmp( token, "scaleWithCharge" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1475,7 +1495,7 @@ static bool CG_ParseParticle( baseParticle_t *bp, const char* name, const char *
 		}
 		else
 		{
-			logger.Warn( "unknown token '%s' in particle", token );
+			script.Warn( "unknown token '%s' in particle", token );
 			return false;
 		}
 	}
@@ -1503,12 +1523,14 @@ CG_ParseParticleEjector
 Parse a particle ejector section
 ===============
 */
-static bool CG_ParseParticleEjector( baseParticleEjector_t *bpe, const char* name, const char **text_p )
+static bool CG_ParseParticleEjector( baseParticleEjector_t *bpe, const char* name, const char **text_p, particleScript_t &script )
 {
+	char tokenBuffer[ MAX_TOKEN_CHARS ];
+
 	// read optional parameters
 	while ( 1 )
 	{
-		const char *token = COM_Parse( text_p );
+		const char *token = COM_Parse_r( text_p, tokenBuffer );
 
 		if ( !*token )
 		{
@@ -1517,34 +1539,30 @@ static bool CG_ParseParticleEjector( baseParticleEjector_t *bpe, const char* nam
 
 		if ( !Q_stricmp( token, "{" ) )
 		{
-			CG_InitialiseBaseParticle( &baseParticles[ numBaseParticles ] );
+			script.particles.emplace_back();
+			baseParticle_t *bp = &script.particles.back();
 
-			if ( !CG_ParseParticle( &baseParticles[ numBaseParticles ], name, text_p ) )
-			{
-				logger.Warn( "failed to parse particle" );
-				return false;
-			}
+			CG_InitialiseBaseParticle( bp );
 
-			if ( bpe->numParticles == MAX_PARTICLES_PER_EJECTOR )
+			if ( !CG_ParseParticle( bp, name, text_p, script ) )
 			{
-				logger.Warn( "ejector has > %d particles", MAX_PARTICLES_PER_EJECTOR );
+				script.Warn( "failed to parse particle" );
 				return false;
 			}
 
-			if ( numBaseParticles == MAX_BASEPARTICLES )
+			if ( bpe->numParticles == MAX_PARTICLES_PER_EJECTOR )
 			{
-				logger.Warn( "maximum number of particles (%d) reached", MAX_BASEPARTICLES );
+				script.Warn( "ejector has > %d particles", MAX_PARTICLES_PER_EJECTOR );
 				return false;
 			}
 
 			//start parsing particles again
-			bpe->particles[ bpe->numParticles ] = &baseParticles[ numBaseParticles ];
+			bpe->particles[ bpe->numParticles ] = bp;
 			bpe->numParticles++;
-			numBaseParticles++;
 		}
 		else if ( !Q_stricmp( token, "delay" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1557,7 +1575,7 @@ static bool CG_ParseParticleEjector( baseParticleEjector_t *bpe, const char* nam
 		}
 		else if ( !Q_stricmp( token, "period" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1566,7 +1584,7 @@ static bool CG_ParseParticleEjector( baseParticleEjector_t *bpe, const char* nam
 
 			bpe->eject.initial = atoi_neg( token, false );
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1582,7 +1600,7 @@ static bool CG_ParseParticleEjector( baseParticleEjector_t *bpe, const char* nam
 				bpe->eject.final = atoi_neg( token, false );
 			}
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1593,7 +1611,7 @@ static bool CG_ParseParticleEjector( baseParticleEjector_t *bpe, const char* nam
 		}
 		else if ( !Q_stricmp( token, "count" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1622,7 +1640,7 @@ static bool CG_ParseParticleEjector( baseParticleEjector_t *bpe, const char* nam
 		}
 		else
 		{
-			logger.Warn( "unknown token '%s' in particle ejector", token );
+			script.Warn( "unknown token '%s' in particle ejector", token );
 			return false;
 		}
 	}
@@ -1637,12 +1655,14 @@ CG_ParseParticleSystem
 Parse a particle system section
 ===============
 */
-static bool CG_ParseParticleSystem( baseParticleSystem_t *bps, const char **text_p, const char *name )
+static bool CG_ParseParticleSystem( baseParticleSystem_t *bps, const char **text_p, const char *name, particleScript_t &script )
 {
+	char tokenBuffer[ MAX_TOKEN_CHARS ];
+
 	// read optional parameters
 	while ( 1 )
 	{
-		const char *token = COM_Parse( text_p );
+		const char *token = COM_Parse_r( text_p, tokenBuffer );
 
 		if ( !*token )
 		{
@@ -1651,39 +1671,32 @@ static bool CG_ParseParticleSystem( baseParticleSystem_t *bps, const char **text
 
 		if ( !Q_stricmp( token, "{" ) )
 		{
-			if ( !CG_ParseParticleEjector( &baseParticleEjectors[ numBaseParticleEjectors ], name, text_p ) )
+			script.ejectors.emplace_back();
+			baseParticleEjector_t *bpe = &script.ejectors.back();
+
+			if ( !CG_ParseParticleEjector( bpe, name, text_p, script ) )
 			{
-				logger.Warn( "failed to parse particle ejector" );
+				script.Warn( "failed to parse particle ejector" );
 				return false;
 			}
 
-			baseParticleEjector_t *bpe = &baseParticleEjectors[ numBaseParticleEjectors ];
-
 			//check for infinite count + zero period
 			if ( bpe->totalParticles == PARTICLES_INFINITE &&
 			     ( bpe->eject.initial == 0.0f || bpe->eject.final == 0.0f ) )
 			{
-				logger.Warn( "ejector with 'count infinite' potentially has zero period" );
+				script.Warn( "ejector with 'count infinite' potentially has zero period" );
 				return false;
 			}
 
 			if ( bps->numEjectors == MAX_EJECTORS_PER_SYSTEM )
 			{
-				logger.Warn( "particle system has > %d ejectors", MAX_EJECTORS_PER_SYSTEM );
-				return false;
-			}
-
-			if ( numBaseParticleEjectors == MAX_BASEPARTICLE_EJECTORS )
-			{
-				logger.Warn( "maximum number of particle ejectors (%d) reached",
-				           MAX_BASEPARTICLE_EJECTORS );
+				script.Warn( "particle system has > %d ejectors", MAX_EJECTORS_PER_SYSTEM );
 				return false;
 			}
 
 			//start parsing ejectors again
-			bps->ejectors[ bps->numEjectors ] = &baseParticleEjectors[ numBaseParticleEjectors ];
+			bps->ejectors[ bps->numEjectors ] = bpe;
 			bps->numEjectors++;
-			numBaseParticleEjectors++;
 		}
 		else if ( !Q_stricmp( token, "thirdPersonOnly" ) )
 		{
@@ -1697,14 +1710,14 @@ static bool CG_ParseParticleSystem( baseParticleSystem_t *bps, const char **text
 		{
 			if ( cg_debugParticles.Get() >= 1 )
 			{
-				logger.Debug( "Parsed particle system %s", name );
+				script.Debug( "Parsed particle system %s", name );
 			}
 
 			return true; //reached the end of this particle system
 		}
 		else
 		{
-			logger.Warn( "unknown token '%s' in particle system %s", token, bps->name );
+			script.Warn( "unknown token '%s' in particle system %s", token, bps->name );
 			return false;
 		}
 	}
@@ -1716,21 +1729,15 @@ static bool CG_ParseParticleSystem( baseParticleSystem_t *bps, const char **text
 ===============
 CG_ParseParticleFile
 
-Load the particle systems from a particle file
+Parse the particle systems of a particle file, in a job
 ===============
 */
-static bool CG_ParseParticleFile( const char *fileName )
+static bool CG_ParseParticleFile( particleScript_t &script )
 {
-	std::error_code err;
-	std::string text = FS::PakPath::ReadFile( fileName, err );
-	if ( err )
-	{
-		logger.Warn( "couldn't read particle file '%s': %s", fileName, err.message() );
-		return false;
-	}
+	char tokenBuffer[ MAX_TOKEN_CHARS ];
 
 	// parse the text
-	const char *text_p = text.c_str();
+	const char *text_p = script.text.c_str();
 
 	char psName[ MAX_QPATH ];
 	bool psNameSet = false;
@@ -1738,7 +1745,7 @@ static bool CG_ParseParticleFile( const char *fileName )
 	// read optional parameters
 	while ( 1 )
 	{
-		const char *token = COM_Parse( &text_p );
+		const char *token = COM_Parse_r( &text_p, tokenBuffer );
 
 		if ( !*token )
 		{
@@ -1749,58 +1756,35 @@ static bool CG_ParseParticleFile( const char *fileName )
 		{
 			if ( psNameSet )
 			{
-				Q_strncpyz( baseParticleSystems[ numBaseParticleSystems ].name, psName, MAX_QPATH );
+				script.systems.emplace_back();
+				baseParticleSystem_t *bps = &script.systems.back();
+
+				Q_strncpyz( bps->name, psName, MAX_QPATH );
 
-				if ( !CG_ParseParticleSystem( &baseParticleSystems[ numBaseParticleSystems ], &text_p, psName ) )
+				if ( !CG_ParseParticleSystem( bps, &text_p, psName, script ) )
 				{
-					logger.Warn( "%s: failed to parse particle system %s", fileName, psName );
+					script.Warn( "%s: failed to parse particle system %s", script.name, psName );
+					script.systems.pop_back();
 					return false;
 				}
 
 				//start parsing particle systems again
 				psNameSet = false;
-
-				if ( numBaseParticleSystems == MAX_BASEPARTICLE_SYSTEMS )
-				{
-					logger.Warn( "maximum number of particle systems (%d) reached",
-					           MAX_BASEPARTICLE_SYSTEMS );
-					return false;
-				}
-
-				numBaseParticleSystems++;
 			}
 			else
 			{
-				logger.Warn( "unnamed particle system" );
+				script.Warn( "unnamed particle system" );
 				return false;
 			}
 		}
 		else if ( !psNameSet )
 		{
 			Q_strncpyz( psName, token, sizeof( psName ) );
-
-			//check for name space clashes
-			int i;
-			for ( i = 0; i < numBaseParticleSystems; i++ )
-			{
-				if ( !Q_stricmp( baseParticleSystems[ i ].name, psName ) )
-				{
-					logger.Warn( "a particle system is already named %s", psName );
-					break;
-				}
-			}
-
-			if ( i < numBaseParticleSystems )
-			{
-				SkipBracedSection( &text_p );
-				continue;
-			}
-
 			psNameSet = true;
 		}
 		else
 		{
-			logger.Warn( "particle system already named" );
+			script.Warn( "particle system already named" );
 			return false;
 		}
 	}
@@ -1808,6 +1792,79 @@ static bool CG_ParseParticleFile( const char *fileName )
 	return true;
 }
 
+/*
+===============
+CG_AddParticleFile
+
+Add the particle systems parsed from a file, on the main thread
+===============
+*/
+static void CG_AddParticleFile( const particleScript_t &script )
+{
+	for ( const baseParticleSystem_t &parsed : script.systems )
+	{
+		//check for name space clashes, also with the other files
+		int i;
+		for ( i = 0; i < numBaseParticleSystems; i++ )
+		{
+			if ( !Q_stricmp( baseParticleSystems[ i ].name, parsed.name ) )
+			{
+				logger.Warn( "a particle system is already named %s", parsed.name );
+				break;
+			}
+		}
+
+		if ( i < numBaseParticleSystems )
+		{
+			continue;
+		}
+
+		int numParticles = 0;
+		for ( i = 0; i < parsed.numEjectors; i++ )
+		{
+			numParticles += parsed.ejectors[ i ]->numParticles;
+		}
+
+		if ( numBaseParticleSystems == MAX_BASEPARTICLE_SYSTEMS )
+		{
+			logger.Warn( "maximum number of particle systems (%d) reached",
+			           MAX_BASEPARTICLE_SYSTEMS );
+			return;
+		}
+
+		if ( numBaseParticleEjectors + parsed.numEjectors > MAX_BASEPARTICLE_EJECTORS )
+		{
+			logger.Warn( "maximum number of particle ejectors (%d) reached",
+			           MAX_BASEPARTICLE_EJECTORS );
+			return;
+		}
+
+		if ( numBaseParticles + numParticles > MAX_BASEPARTICLES )
+		{
+			logger.Warn( "maximum number of particles (%d) reached", MAX_BASEPARTICLES );
+			return;
+		}
+
+		// copy the system, pointing it to the copies of its ejectors and particles
+		baseParticleSystem_t *bps = &baseParticleSystems[ numBaseParticleSystems++ ];
+		*bps = parsed;
+
+		for ( i = 0; i < bps->numEjectors; i++ )
+		{
+			baseParticleEjector_t *bpe = &baseParticleEjectors[ numBaseParticleEjectors++ ];
+			*bpe = *bps->ejectors[ i ];
+			bps->ejectors[ i ] = bpe;
+
+			for ( int j = 0; j < bpe->numParticles; j++ )
+			{
+				baseParticle_t *bp = &baseParticles[ numBaseParticles++ ];
+				*bp = *bpe->particles[ j ];
+				bpe->particles[ j ] = bp;
+			}
+		}
+	}
+}
+
 /*
 ===============
 CG_LoadParticleSystems
@@ -1840,21 +1897,31 @@ void CG_LoadParticleSystems()
 		*bp = {};
 	}
 
-	//and bring in the new
-	char fileList[ MAX_PARTICLE_FILES * MAX_QPATH ];
-	int numFiles = trap_FS_GetFileList( "scripts", ".particle",
-	                                fileList, MAX_PARTICLE_FILES * MAX_QPATH );
+	//and bring in the new: the files are read here, parsed by jobs, and
+	//added in order so that the first of two systems with a name wins
+	std::vector<particleScript_t> scripts;
+	for ( const std::string &fileName : CG_ScriptFiles( ".particle", MAX_PARTICLE_FILES ) )
+	{
+		particleScript_t script;
+
+		if ( CG_ReadScript( script, fileName ) )
+		{
+			scripts.push_back( std::move( script ) );
+		}
+	}
+
+	Parallel::SetNumThreads( cg_workerThreads.Get() );
+	Parallel::For( scripts.size(), 2, [ &scripts ]( int begin, int end ) {
+		for ( int i = begin; i < end; i++ )
+		{
+			CG_ParseParticleFile( scripts[ i ] );
+		}
+	} );
 
-	char *filePtr = fileList;
-	for ( int i = 0; i < numFiles; i++ )
+	for ( particleScript_t &script : scripts )
 	{
-		int fileLen = strlen( filePtr );
-		char fileName[ MAX_QPATH ];
-		Q_strncpyz( fileName, "scripts/", sizeof fileName );
-		Q_strcat( fileName, sizeof fileName, filePtr );
-		// logger.Notice(_( "...loading '%s'"), fileName );
-		CG_ParseParticleFile( fileName );
-		filePtr += fileLen + 1;
+		script.Flush( logger );
+		CG_AddParticleFile( script );
 	}
 
 	//connect any child systems to their psHandle
@@ -35,38 +35,229 @@ Maryland 20850 USA.
 #include "common/Common.h"
 #include "cg_local.h"
 #include "shared/parse.h"
+#include "shared/Timing.h"
 
-static bool AddToServerList( const char *name, const char *label, std::string version, std::string abiVersion, int clients, int bots,
-	int ping, int maxClients, char *mapName, char *addr, int netSrc )
+static bool ServerListLess( const serverList_t &list, serverSortKey_t key, int a, int b )
 {
-	server_t *node;
+	int cmp = 0;
 
-	if ( rocketInfo.data.serverCount[ netSrc ] == MAX_SERVERS )
+	switch ( key )
 	{
-		return false;
+		case SERVER_SORT_NAME:
+			cmp = list.cleanNames[ a ].compare( list.cleanNames[ b ] );
+			break;
+
+		case SERVER_SORT_VERSION:
+			cmp = Q_stricmp( list.versions[ a ].c_str(), list.versions[ b ].c_str() );
+			break;
+
+		case SERVER_SORT_MAP:
+			cmp = Q_stricmp( list.mapNames[ a ].c_str(), list.mapNames[ b ].c_str() );
+			break;
+
+		case SERVER_SORT_PLAYERS:
+			cmp = list.clients[ a ] - list.clients[ b ];
+			break;
+
+		case SERVER_SORT_PING:
+			cmp = list.pings[ a ] - list.pings[ b ];
+			break;
+
+		default:
+			break;
 	}
 
+	// Equal servers stay in order of arrival
+	return cmp != 0 ? cmp < 0 : a < b;
+}
+
+static bool ServerMatchesFilter( const serverList_t &list, int server )
+{
+	return list.filter.empty() || list.cleanNames[ server ].find( list.filter ) != std::string::npos;
+}
+
+static bool AddToServerList( serverList_t &list, const char *name, const char *label, std::string version, std::string abiVersion, int clients, int bots,
+	int ping, int maxClients, const char *mapName, const char *addr )
+{
 	if ( !*name || !*mapName )
 	{
 		return false;
 	}
 
-	node = &rocketInfo.data.servers[ netSrc ][ rocketInfo.data.serverCount[ netSrc ] ];
+	char cleanName[ MAX_INFO_VALUE ];
+	Color::StripColors( name, cleanName, sizeof( cleanName ) );
+	Q_strlwr( cleanName );
+
+	int server = list.Size();
+
+	list.names.emplace_back( name );
+	list.cleanNames.emplace_back( cleanName );
+	list.labels.emplace_back( label );
+	list.versions.push_back( std::move( version ) );
+	list.abiVersions.push_back( std::move( abiVersion ) );
+	list.mapNames.emplace_back( mapName );
+	list.addrs.emplace_back( addr );
+	list.clients.push_back( clients );
+	list.bots.push_back( bots );
+	list.pings.push_back( ping );
+	list.maxClients.push_back( maxClients );
+
+	for ( int key = SERVER_SORT_NONE; key < SERVER_SORT_NUM; key++ )
+	{
+		std::vector<int> &sorted = list.sorted[ key ];
+		auto it = std::upper_bound( sorted.begin(), sorted.end(), server, [ &list, key ]( int a, int b ) {
+			return ServerListLess( list, static_cast<serverSortKey_t>( key ), a, b );
+		} );
+		sorted.insert( it, server );
+	}
 
-	node->name = BG_strdup( name );
-	node->clients = clients;
-	node->bots = bots;
-	node->ping = ping;
-	node->maxClients = maxClients;
-	node->addr = BG_strdup( addr );
-	node->label = BG_strdup( label );
-	node->version = version;
-	node->mapName = BG_strdup( mapName );
-	node->abiVersion = abiVersion;
-	rocketInfo.data.serverCount[ netSrc ]++;
+	list.matches.push_back( ServerMatchesFilter( list, server ) );
 	return true;
 }
 
+static void ClearServerList( serverList_t &list )
+{
+	// The sort key and the filter are kept for the next refresh
+	serverSortKey_t sortKey = list.sortKey;
+	std::string filter = std::move( list.filter );
+
+	list = {};
+	list.sortKey = sortKey;
+	list.filter = std::move( filter );
+}
+
+static void ServerRowData( const serverList_t &list, int server, char *data )
+{
+	data[ 0 ] = '\0';
+
+	Info_SetValueForKey( data, "name", list.names[ server ].c_str(), false );
+	Info_SetValueForKey( data, "players", va( "%d", list.clients[ server ] ), false );
+	Info_SetValueForKey( data, "bots", va( "%d", list.bots[ server ] ), false );
+	Info_SetValueForKey( data, "ping", va( "%d", list.pings[ server ] ), false );
+	Info_SetValueForKey( data, "maxClients", va( "%d", list.maxClients[ server ] ), false );
+	Info_SetValueForKey( data, "addr", list.addrs[ server ].c_str(), false );
+	Info_SetValueForKey( data, "label", list.labels[ server ].c_str(), false );
+
+	std::string version;
+	if ( !Q_stricmp( list.abiVersions[ server ].c_str(), IPC::SYSCALL_ABI_VERSION ) ) {
+		version = list.versions[ server ];
+	} else {
+		version = Str::Format( "^1!%s!", list.versions[ server ] );
+	}
+
+	Info_SetValueForKey( data, "version", version.c_str(), false );
+	Info_SetValueForKey( data, "map", list.mapNames[ server ].c_str(), false );
+}
+
+struct serverRowDiff_t
+{
+	int inserted;
+	int removed;
+};
+
+/*
+================
+UpdateServerRows
+
+Brings the rows of the table up to date with the sort key and the filter of
+the list, touching only the rows that changed. Both the old and the new rows
+are in sort order unless the sort key changed, so a single merge pass finds
+them. Without a table, only the row indices are updated.
+================
+*/
+static serverRowDiff_t UpdateServerRows( serverList_t &list, const char *table, bool reorder )
+{
+	serverRowDiff_t diff = { 0, 0 };
+	char data[ MAX_INFO_STRING ];
+
+	std::vector<int> rows;
+	for ( int server : list.sorted[ list.sortKey ] )
+	{
+		if ( list.matches[ server ] )
+		{
+			rows.push_back( server );
+		}
+	}
+
+	if ( reorder )
+	{
+		if ( table )
+		{
+			Rocket_DSClearTable( "server_browser", table );
+
+			for ( int server : rows )
+			{
+				ServerRowData( list, server, data );
+				Rocket_DSAddRow( "server_browser", table, data );
+			}
+		}
+
+		diff.removed = list.rows.size();
+		diff.inserted = rows.size();
+		list.rows = std::move( rows );
+		return diff;
+	}
+
+	const std::vector<int> &old = list.rows;
+	size_t i = 0, j = 0;
+	int row = 0;
+
+	while ( i < old.size() || j < rows.size() )
+	{
+		if ( i < old.size() && j < rows.size() && old[ i ] == rows[ j ] )
+		{
+			i++, j++, row++;
+		}
+		else if ( j < rows.size() && ( i == old.size() || ServerListLess( list, list.sortKey, rows[ j ], old[ i ] ) ) )
+		{
+			if ( table )
+			{
+				ServerRowData( list, rows[ j ], data );
+				Rocket_DSInsertRow( "server_browser", table, row, data );
+			}
+
+			diff.inserted++;
+			j++, row++;
+		}
+		else
+		{
+			if ( table )
+			{
+				Rocket_DSRemoveRow( "server_browser", table, row );
+			}
+
+			diff.removed++;
+			i++;
+		}
+	}
+
+	list.rows = std::move( rows );
+	return diff;
+}
+
+/*
+================
+SetServerListFilter
+
+When the new filter contains the old one, which is the case while it is being
+typed, only servers that matched the old filter can match the new one.
+================
+*/
+static void SetServerListFilter( serverList_t &list, const char *filter )
+{
+	std::string lowered = Str::ToLower( filter );
+	bool narrowing = lowered.find( list.filter ) != std::string::npos;
+	list.filter = std::move( lowered );
+
+	for ( int server = 0; server < list.Size(); server++ )
+	{
+		if ( !narrowing || list.matches[ server ] )
+		{
+			list.matches[ server ] = ServerMatchesFilter( list, server );
+		}
+	}
+}
+
 static void CG_Rocket_SetServerListServer( const char *table, int index )
 {
 	int netSrc = CG_StringToNetSource( table );
@@ -76,7 +267,9 @@ static void CG_Rocket_SetServerListServer( const char *table, int index )
 		return;
 	}
 
-	rocketInfo.data.serverIndex[ netSrc ] = index;
+	const std::vector<int> &rows = rocketInfo.data.serverLists[ netSrc ].rows;
+
+	rocketInfo.data.serverIndex[ netSrc ] = index >= 0 && index < static_cast<int>( rows.size() ) ? rows[ index ] : -1;
 	rocketInfo.currentNetSrc = netSrc;
 	CG_Rocket_BuildServerInfo();
 }
@@ -86,12 +279,12 @@ void CG_Rocket_BuildServerInfo()
 	static char serverInfoText[ MAX_SERVERSTATUS_LINES ];
 	char buf[ MAX_INFO_STRING ];
 	const char *p;
-	server_t *server;
 	int netSrc = rocketInfo.currentNetSrc;
+	const serverList_t &list = rocketInfo.data.serverLists[ netSrc ];
 
 	int serverIndex = rocketInfo.data.serverIndex[ netSrc ];
 
-	if ( serverIndex >= rocketInfo.data.serverCount[ netSrc ] || serverIndex < 0 )
+	if ( serverIndex >= list.Size() || serverIndex < 0 )
 	{
 		return;
 	}
@@ -110,10 +303,7 @@ void CG_Rocket_BuildServerInfo()
 		rocketInfo.data.buildingServerInfo = true;
 	}
 
-	server = &rocketInfo.data.servers[ netSrc ][ serverIndex ];
-
-
-	if ( trap_LAN_ServerStatus( server->addr, serverInfoText, sizeof( serverInfoText ) ) )
+	if ( trap_LAN_ServerStatus( list.addrs[ serverIndex ].c_str(), serverInfoText, sizeof( serverInfoText ) ) )
 	{
 		int i = 0, score, ping;
 		const char *start, *end;
@@ -286,7 +476,8 @@ void CG_Rocket_BuildServerList()
 		rocketInfo.data.retrievingServers = false;
 	}
 
-	int oldServerCount = rocketInfo.data.serverCount[ netSrc ];
+	serverList_t &list = rocketInfo.data.serverLists[ netSrc ];
+	int oldServerCount = list.Size();
 
 	for ( i = 0; i < numServers; ++i )
 	{
@@ -319,156 +510,56 @@ void CG_Rocket_BuildServerList()
 			const std::string version = Info_ValueForKey( info.c_str(), "daemonver" );
 			const std::string abiVersion = Info_ValueForKey( info.c_str(), "abi" );
 			rocketInfo.data.haveServerInfo[ netSrc ][ i ] =
-				AddToServerList( Info_ValueForKey( info.c_str(), "hostname" ), trustedInfo.featuredLabel,
-					version, abiVersion, clients, bots, ping, maxClients, mapname, trustedInfo.addr, netSrc );
+				AddToServerList( list, Info_ValueForKey( info.c_str(), "hostname" ), trustedInfo.featuredLabel,
+					version, abiVersion, clients, bots, ping, maxClients, mapname, trustedInfo.addr );
 		}
 	}
 
-	for ( i = oldServerCount; i < rocketInfo.data.serverCount[ netSrc ]; ++i )
+	if ( list.Size() != oldServerCount )
 	{
-		if ( rocketInfo.data.servers[ netSrc ][ i ].ping <= 0 )
-		{
-			continue;
-		}
-
-		char data[ MAX_INFO_STRING ];
-		data[ 0 ] = '\0';
-
-		Info_SetValueForKey( data, "name", rocketInfo.data.servers[ netSrc ][ i ].name, false );
-		Info_SetValueForKey( data, "players", va( "%d", rocketInfo.data.servers[ netSrc ][ i ].clients ), false );
-		Info_SetValueForKey( data, "bots", va( "%d", rocketInfo.data.servers[ netSrc ][ i ].bots ), false );
-		Info_SetValueForKey( data, "ping", va( "%d", rocketInfo.data.servers[ netSrc ][ i ].ping ), false );
-		Info_SetValueForKey( data, "maxClients", va( "%d", rocketInfo.data.servers[ netSrc ][ i ].maxClients ), false );
-		Info_SetValueForKey( data, "addr", rocketInfo.data.servers[ netSrc ][ i ].addr, false );
-		Info_SetValueForKey( data, "label", rocketInfo.data.servers[ netSrc ][ i ].label, false );
-
-		std::string version;
-		if ( !Q_stricmp( rocketInfo.data.servers[netSrc][i].abiVersion.c_str(), IPC::SYSCALL_ABI_VERSION) ) {
-			version = rocketInfo.data.servers[netSrc][i].version;
-		} else {
-			version = Str::Format( "^1!%s!", rocketInfo.data.servers[netSrc][i].version );
-		}
-
-		Info_SetValueForKey( data, "version", version.c_str(), false);
-		Info_SetValueForKey( data, "map", rocketInfo.data.servers[ netSrc ][ i ].mapName, false );
-
-		Rocket_DSAddRow( "server_browser", srcName, data );
+		UpdateServerRows( list, srcName, false );
 	}
 }
 
-static int ServerListCmpByPing( const void *one, const void *two )
-{
-	server_t* a = ( server_t* ) one;
-	server_t* b = ( server_t* ) two;
-
-	if ( a->ping > b->ping ) return 1;
-
-	if ( b->ping > a->ping ) return -1;
-
-	if ( a->ping == b->ping )  return 0;
-
-	return 0; // silence compiler
-}
-
-static int ServerListCmpByName( const void* one, const void* two )
-{
-	char cleanName1[ MAX_INFO_VALUE ];
-	char cleanName2[ MAX_INFO_VALUE ];
-	server_t* a = ( server_t* ) one;
-	server_t* b = ( server_t* ) two;
-
-	Color::StripColors( a->name, cleanName1, sizeof( cleanName1 ) );
-	Color::StripColors( b->name, cleanName2, sizeof( cleanName2 ) );
-
-	return Q_stricmp( cleanName1, cleanName2 );
-}
-
-static int ServerListCmpByMap( const void* one, const void* two )
-{
-	server_t* a = ( server_t* ) one;
-	server_t* b = ( server_t* ) two;
-
-	return Q_stricmp( a->mapName, b->mapName );
-}
-
-static int ServerListCmpByPlayers( const void* one, const void* two )
-{
-	server_t* a = ( server_t* ) one;
-	server_t* b = ( server_t* ) two;
-
-	if ( a->clients > b->clients ) return 1;
-
-	if ( b->clients > a->clients ) return -1;
-
-	if ( a->clients == b->clients )  return 0;
-
-	return 0; // silence compiler
-}
-
 static void CG_Rocket_SortServerList( const char *name, const char *sortBy )
 {
-	char data[ MAX_INFO_STRING ] = { 0 };
 	int netSrc = CG_StringToNetSource( name );
-	int  i;
+	serverList_t &list = rocketInfo.data.serverLists[ netSrc ];
 
 	if ( !Q_stricmp( sortBy, "ping" ) )
 	{
-		qsort( rocketInfo.data.servers[ netSrc ], rocketInfo.data.serverCount[ netSrc ], sizeof( server_t ), &ServerListCmpByPing );
+		list.sortKey = SERVER_SORT_PING;
 	}
 	else if ( !Q_stricmp( sortBy, "name" ) )
 	{
-		qsort( rocketInfo.data.servers[ netSrc ], rocketInfo.data.serverCount[ netSrc ], sizeof( server_t ), &ServerListCmpByName );
+		list.sortKey = SERVER_SORT_NAME;
 	}
 	else if ( !Q_stricmp( sortBy, "players" ) )
 	{
-		qsort( rocketInfo.data.servers[ netSrc ], rocketInfo.data.serverCount[ netSrc ], sizeof( server_t ), &ServerListCmpByPlayers );
+		list.sortKey = SERVER_SORT_PLAYERS;
 	}
 	else if ( !Q_stricmp( sortBy, "map" ) )
 	{
-		qsort( rocketInfo.data.servers[ netSrc ], rocketInfo.data.serverCount[ netSrc ], sizeof( server_t ), &ServerListCmpByMap );
+		list.sortKey = SERVER_SORT_MAP;
 	}
-
-	Rocket_DSClearTable( "server_browser", name );
-
-	for ( i = 0; i < rocketInfo.data.serverCount[ netSrc ]; ++i )
+	else if ( !Q_stricmp( sortBy, "version" ) )
 	{
-		if ( rocketInfo.data.servers[ netSrc ][ i ].ping <= 0 )
-		{
-			continue;
-		}
-
-		Info_SetValueForKey( data, "name", rocketInfo.data.servers[ netSrc ][ i ].name, false );
-		Info_SetValueForKey( data, "players", va( "%d", rocketInfo.data.servers[ netSrc ][ i ].clients ), false );
-		Info_SetValueForKey( data, "bots", va( "%d", rocketInfo.data.servers[ netSrc ][ i ].bots ), false );
-		Info_SetValueForKey( data, "ping", va( "%d", rocketInfo.data.servers[ netSrc ][ i ].ping ), false );
-		Info_SetValueForKey( data, "maxClients", va( "%d", rocketInfo.data.servers[ netSrc ][ i ].maxClients ), false );
-		Info_SetValueForKey( data, "addr", rocketInfo.data.servers[ netSrc ][ i ].addr, false );
-		Info_SetValueForKey( data, "label", rocketInfo.data.servers[ netSrc ][ i ].label, false );
-		Info_SetValueForKey( data, "version", rocketInfo.data.servers[netSrc][i].version.c_str(), false );
-		Info_SetValueForKey( data, "map", rocketInfo.data.servers[ netSrc ][ i ].mapName, false );
-
-		Rocket_DSAddRow( "server_browser", name, data );
+		list.sortKey = SERVER_SORT_VERSION;
 	}
+
+	UpdateServerRows( list, name, true );
 }
 
 void CG_Rocket_CleanUpServerList( const char *table )
 {
 	int i;
-	int j;
 	int netSrc = CG_StringToNetSource( table );
 
 	for ( i = AS_LOCAL; i < AS_NUM_TYPES; ++i )
 	{
 		if ( !table || !*table || i == netSrc )
 		{
-			for ( j = 0; j < rocketInfo.data.serverCount[ i ]; ++j )
-			{
-				BG_Free( rocketInfo.data.servers[ i ][ j ].name );
-				BG_Free( rocketInfo.data.servers[ i ][ j ].label );
-				BG_Free( rocketInfo.data.servers[ i ][ j ].addr );
-				BG_Free( rocketInfo.data.servers[ i ][ j ].mapName );
-			}
-			rocketInfo.data.serverCount[ i ] = 0;
+			ClearServerList( rocketInfo.data.serverLists[ i ] );
 			rocketInfo.data.haveServerInfo[ i ].clear();
 		}
 	}
@@ -478,31 +569,10 @@ static void CG_Rocket_FilterServerList( const char *table, const char *filter )
 {
 	const char *str = ( table && *table ) ? table : CG_NetSourceToString( rocketInfo.currentNetSrc );
 	int netSrc = CG_StringToNetSource( str );
-	int i;
-
-	Rocket_DSClearTable( "server_browser", str );
+	serverList_t &list = rocketInfo.data.serverLists[ netSrc ];
 
-	for ( i = 0; i < rocketInfo.data.serverCount[ netSrc ]; ++i )
-	{
-		char name[ MAX_INFO_VALUE ];
-		Color::StripColors( rocketInfo.data.servers[ netSrc ][ i ].name, name, sizeof( name ) );
-
-		if ( Q_stristr( name, filter ) )
-		{
-			char data[ MAX_INFO_STRING ] = { 0 };
-
-			Info_SetValueForKey( data, "name", rocketInfo.data.servers[ netSrc ][ i ].name, false );
-			Info_SetValueForKey( data, "players", va( "%d", rocketInfo.data.servers[ netSrc ][ i ].clients ), false );
-			Info_SetValueForKey( data, "bots", va( "%d", rocketInfo.data.servers[ netSrc ][ i ].bots ), false );
-			Info_SetValueForKey( data, "ping", va( "%d", rocketInfo.data.servers[ netSrc ][ i ].ping ), false );
-			Info_SetValueForKey( data, "maxClients", va( "%d", rocketInfo.data.servers[ netSrc ][ i ].maxClients ), false );
-			Info_SetValueForKey( data, "addr", rocketInfo.data.servers[ netSrc ][ i ].addr, false );
-			Info_SetValueForKey( data, "label", rocketInfo.data.servers[ netSrc ][ i ].label, false );
-			Info_SetValueForKey( data, "version", rocketInfo.data.servers[netSrc][i].version.c_str(), false );
-
-			Rocket_DSAddRow( "server_browser", str, data );
-		}
-	}
+	SetServerListFilter( list, filter );
+	UpdateServerRows( list, str, false );
 }
 
 static std::string cg_currentSelectedServer;
@@ -521,17 +591,128 @@ class ConnectToCurrentSelectedServerCmd : public Cmd::StaticCmd {
 };
 static ConnectToCurrentSelectedServerCmd ConnectToCurrentSelectedServerCmdRegistration;
 
+// Feeds a synthetic server list through insertion, sorting and filtering
+// without any network, checks the rows against a full rebuild and reports timings.
+class ServerListBenchmarkCmd : public Cmd::StaticCmd
+{
+public:
+	ServerListBenchmarkCmd() : StaticCmd( "serverListBenchmark", Cmd::CLIENT,
+		"time the server list with a number of synthetic servers" ) {}
+
+	void Run( const Cmd::Args &args ) const override
+	{
+		int count = args.Argc() > 1 ? atoi( args.Argv( 1 ).c_str() ) : 5000;
+		static const char *const words[] = { "Unvanquished", "Overmind", "Reactor", "Granger", "Tyrant", "Dretch", "Luci", "Chaingun" };
+		static const char *const maps[] = { "plat23", "chasm", "station15", "vega", "spacetracks", "yocto" };
+		serverList_t list = {};
+		uint32_t seed = 0x1234567;
+		auto random = [ &seed ]( uint32_t range ) {
+			seed = seed * 1664525 + 1013904223;
+			return static_cast<int>( ( seed >> 8 ) % range );
+		};
+
+		auto start = Timing::Now();
+		auto elapsed = [ &start ]() {
+			int usec = Timing::Elapsed( start );
+			start = Timing::Now();
+			return usec;
+		};
+
+		// Servers arrive in batches, as they do between two refreshes of the list
+		int batches = 0;
+		for ( int server = 0; server < count; server++ )
+		{
+			std::string name = Str::Format( "^%d%s ^7%s #%d", random( 10 ), words[ random( ARRAY_LEN( words ) ) ],
+			                                words[ random( ARRAY_LEN( words ) ) ], server );
+			AddToServerList( list, name.c_str(), "", Str::Format( "0.%d", 50 + random( 5 ) ), IPC::SYSCALL_ABI_VERSION,
+			                 random( 32 ), random( 8 ), 1 + random( 300 ), 32, maps[ random( ARRAY_LEN( maps ) ) ],
+			                 va( "10.%d.%d.%d:27960", server >> 16, ( server >> 8 ) & 255, server & 255 ) );
+
+			if ( server % 100 == 99 || server == count - 1 )
+			{
+				UpdateServerRows( list, nullptr, false );
+				batches++;
+			}
+		}
+		Print( "%d servers inserted in %d batches: %d us", count, batches, elapsed() );
+
+		bool valid = Check( list );
+
+		static const char *const keys[] = { "none", "name", "version", "map", "players", "ping" };
+		for ( int key = SERVER_SORT_NAME; key < SERVER_SORT_NUM; key++ )
+		{
+			list.sortKey = static_cast<serverSortKey_t>( key );
+			UpdateServerRows( list, nullptr, true );
+			Print( "sort by %s: %d us", keys[ key ], elapsed() );
+			valid = Check( list ) && valid;
+		}
+
+		// Type a filter, then erase it again
+		std::string typed = "overmind #12";
+		std::vector<std::string> filters;
+		for ( size_t length = 1; length <= typed.size(); length++ )
+		{
+			filters.push_back( typed.substr( 0, length ) );
+		}
+		for ( size_t length = typed.size(); length-- > 0; )
+		{
+			filters.push_back( typed.substr( 0, length ) );
+		}
+
+		int changes = 0;
+		int usec = 0;
+		for ( const std::string &filter : filters )
+		{
+			SetServerListFilter( list, filter.c_str() );
+			serverRowDiff_t diff = UpdateServerRows( list, nullptr, false );
+			usec += elapsed();
+			changes += diff.inserted + diff.removed;
+			valid = Check( list ) && valid;
+			elapsed(); // don't count the check
+		}
+		Print( "%d filter keystrokes: %d row changes, %d us", static_cast<int>( filters.size() ), changes, usec );
+
+		Print( valid ? "rows match a full rebuild" : "^1rows differ from a full rebuild" );
+	}
+
+private:
+	// Compares the rows with the ones a full sort and filter would give
+	static bool Check( const serverList_t &list )
+	{
+		std::vector<int> expected;
+		for ( int server = 0; server < list.Size(); server++ )
+		{
+			if ( Q_stristr( list.cleanNames[ server ].c_str(), list.filter.c_str() ) )
+			{
+				expected.push_back( server );
+			}
+		}
+
+		std::stable_sort( expected.begin(), expected.end(), [ &list ]( int a, int b ) {
+			return ServerListLess( list, list.sortKey, a, b );
+		} );
+
+		return expected == list.rows;
+	}
+};
+static ServerListBenchmarkCmd serverListBenchmarkCmdRegistration;
+
 static void CG_Rocket_ExecServerList( const char *table )
 {
 	int netSrc = CG_StringToNetSource( table );
 
+	const serverList_t &list = rocketInfo.data.serverLists[netSrc];
 	int i = rocketInfo.data.serverIndex[netSrc];
 
-	if ( Q_stricmp( rocketInfo.data.servers[netSrc][i].abiVersion.c_str(), IPC::SYSCALL_ABI_VERSION ) ) {
-		cg_currentSelectedServer = rocketInfo.data.servers[netSrc][rocketInfo.data.serverIndex[netSrc]].addr;
+	if ( i < 0 || i >= list.Size() ) {
+		return;
+	}
+
+	if ( Q_stricmp( list.abiVersions[i].c_str(), IPC::SYSCALL_ABI_VERSION ) ) {
+		cg_currentSelectedServer = list.addrs[i];
 		Rocket_DocumentAction( "server_mismatch", "show" );
 	} else {
-		trap_SendConsoleCommand( va( "connect %s", rocketInfo.data.servers[netSrc][rocketInfo.data.serverIndex[netSrc]].addr ) );
+		trap_SendConsoleCommand( va( "connect %s", list.addrs[i].c_str() ) );
 	}
 }
 
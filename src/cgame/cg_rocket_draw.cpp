@@ -38,12 +38,14 @@ Maryland 20850 USA.
 #include "cg_local.h"
 #include "cg_key_name.h"
 #include "rocket/rocket.h"
+#include "shared/Timing.h"
 #include <RmlUi/Core/Element.h>
 #include <RmlUi/Core/ElementInstancer.h>
 #include <RmlUi/Core/Factory.h>
 #include <RmlUi/Core/ElementText.h>
 
 Cvar::Cvar<bool> cg_drawPosition("cg_drawPosition", "show position. Requires cg_drawSpeed to be enabled.", Cvar::NONE, false);
+static Cvar::Cvar<bool> cg_hudStats("cg_hudStats", "count and time updates of HUD elements, shown by the hud_stats element", Cvar::NONE, false);
 
 static void CG_GetRocketElementColor( Color::Color& color )
 {
@@ -234,6 +236,65 @@ class TranslateNodeHandler : public Rml::XMLNodeHandler
 	bool ElementEnd(Rml::XMLParser*, const Rml::String&) override { return true; }
 };
 
+/**
+ * Copy of all the values a HUD element's content depends on, compared between frames to find
+ * out whether the element needs updating.
+ */
+class HudInputs
+{
+public:
+	template<typename T>
+	HudInputs& operator()( const T& value )
+	{
+		static_assert( std::is_trivially_copyable<T>::value, "HUD inputs must be plain values" );
+		current_.append( reinterpret_cast<const char *>( &value ), sizeof( T ) );
+		return *this;
+	}
+
+	HudInputs& operator()( const char *str )
+	{
+		current_.append( str ? str : "" );
+		current_.push_back( '\0' );
+		return *this;
+	}
+
+	void Begin()
+	{
+		std::swap( current_, previous_ );
+		current_.clear();
+	}
+
+	/**
+	 * Whether the inputs declared since Begin differ from the ones declared before.
+	 */
+	bool Changed()
+	{
+		bool changed = !valid_ || current_ != previous_;
+		valid_ = true;
+		return changed;
+	}
+
+	void Invalidate()
+	{
+		valid_ = false;
+	}
+
+private:
+	std::string current_;
+	std::string previous_;
+	bool valid_ = false;
+};
+
+struct hudElementStats_t
+{
+	int updates;
+	int skipped;
+	int usec;
+};
+
+// Accumulated by tag name between two refreshes of the hud_stats element.
+static std::map<Rml::String, hudElementStats_t> hudElementStats;
+
 class HudElement : public Rml::Element
 {
 public:
@@ -250,10 +311,46 @@ public:
 	void OnUpdate() override
 	{
 		Rml::Element::OnUpdate();
-		if (CG_Rocket_IsCommandAllowed(type))
+		if (!CG_Rocket_IsCommandAllowed(type))
+		{
+			// The element's state may be stale when it is allowed again.
+			inputs_.Invalidate();
+			return;
+		}
+
+		bool changed = true;
+		inputs_.Begin();
+		if ( DeclareInputs( inputs_ ) )
+		{
+			changed = inputs_.Changed();
+		}
+		else
 		{
-			DoOnUpdate();
+			inputs_.Invalidate();
 		}
+
+		if ( !cg_hudStats.Get() )
+		{
+			if ( changed )
+			{
+				DoOnUpdate();
+			}
+			return;
+		}
+
+		hudElementStats_t &stats = hudElementStats[ GetTagName() ];
+
+		if ( !changed )
+		{
+			stats.skipped++;
+			return;
+		}
+
+		auto start = Timing::Now();
+		DoOnUpdate();
+
+		stats.updates++;
+		stats.usec += Timing::Elapsed( start );
 	}
 
 	void OnRender() override
@@ -268,6 +365,12 @@ public:
 	virtual void DoOnRender() {}
 	virtual void DoOnUpdate() {}
 
+	/**
+	 * Declare every value that DoOnUpdate depends on. If this returns true, DoOnUpdate is only
+	 * called when one of the declared values changed since the last update.
+	 */
+	virtual bool DeclareInputs( HudInputs& ) { return false; }
+
 	bool GetIntrinsicDimensions( Rml::Vector2f &dimension, float& /*ratio*/ ) override
 	{
 		if ( !isReplacedElement )
@@ -338,6 +441,7 @@ protected:
 private:
 	rocketElementType_t type;
 	bool isReplacedElement;
+	HudInputs inputs_;
 };
 
 class TextHudElement : public HudElement
@@ -1096,10 +1200,16 @@ public:
 			TextHudElement( tag, ELEMENT_HUMANS ),
 			credits_( -1 ) {}
 
+	bool DeclareInputs( HudInputs& inputs ) override
+	{
+		inputs( cg.snap->ps.persistant[ PERS_CREDIT ] );
+		return true;
+	}
+
 	void DoOnUpdate() override
 	{
 		playerState_t *ps = &cg.snap->ps;
-		int value = ps->persistant[ PERS_CREDIT ];;
+		int value = ps->persistant[ PERS_CREDIT ];
 		if ( credits_ != value )
 		{
 			credits_ = value;
@@ -1118,6 +1228,12 @@ public:
 			TextHudElement( tag, ELEMENT_ALIENS ),
 			evos_( -1 ) {}
 
+	bool DeclareInputs( HudInputs& inputs ) override
+	{
+		inputs( cg.snap->ps.persistant[ PERS_CREDIT ] );
+		return true;
+	}
+
 	void DoOnUpdate() override
 	{
 		playerState_t *ps = &cg.snap->ps;
@@ -1128,7 +1244,7 @@ public:
 		// multiplications and divisions by 10 because humans count in
 		// base 10.
 
-		int value = ps->persistant[ PERS_CREDIT ];;
+		int value = ps->persistant[ PERS_CREDIT ];
 		// value is in tenth of evo points
 		value = value * 10 / CREDITS_PER_EVO;
 
@@ -1151,6 +1267,14 @@ public:
 			weapon_( WP_NONE ),
 			isNoAmmo_( false ) {}
 
+	bool DeclareInputs( HudInputs& inputs ) override
+	{
+		const playerState_t &ps = cg.snap->ps;
+		inputs( BG_GetPlayerWeapon( &ps ) )( ps.clips )( ps.ammo )
+		      ( cg.predictedPlayerState.stats[ STAT_HEALTH ] <= 0 )( IsVisible() );
+		return true;
+	}
+
 	void DoOnUpdate() override
 	{
 		playerState_t *ps;
@@ -1186,13 +1310,12 @@ public:
 			SetProperty( "display", "block" );
 		}
 
-		if ( !isNoAmmo_ && ps->clips == 0 && ps->ammo == 0 && !BG_Weapon( weapon_ )->infiniteAmmo )
-		{
-			SetClass( "no_ammo", true );
-		}
-		else if ( isNoAmmo_ )
+		bool noAmmo = ps->clips == 0 && ps->ammo == 0 && !BG_Weapon( weapon_ )->infiniteAmmo;
+
+		if ( noAmmo != isNoAmmo_ )
 		{
-			SetClass( "no_ammo", false );
+			isNoAmmo_ = noAmmo;
+			SetClass( "no_ammo", noAmmo );
 		}
 
 	}
@@ -1302,6 +1425,16 @@ public:
 			HudElement( tag, ELEMENT_GAME ),
 			lastlocation_( Util::nullopt ) {}
 
+	bool DeclareInputs( HudInputs& inputs ) override
+	{
+		// The nearest location only changes when the player moves, entities come and go,
+		// or the current location entity leaves the snapshot.
+		bool locationValid = lastlocation_ && *lastlocation_ && ( *lastlocation_ )->valid;
+		inputs( cg.intermissionStarted )( VEC2GLM( cg.predictedPlayerState.origin ) )
+		      ( VEC2GLM( cg.predictedPlayerEntity.lerpOrigin ) )( cg_highestActiveEntity )( locationValid );
+		return true;
+	}
+
 	void DoOnUpdate() override
 	{
 		if ( cg.intermissionStarted )
@@ -1806,6 +1939,35 @@ public:
 	CrosshairNamesElement( const Rml::String& tag  ) :
 			HudElement( tag, ELEMENT_GAME ), alpha_( 0.0F ) {}
 
+	bool DeclareInputs( HudInputs& inputs ) override
+	{
+		bool enabled = ( cg_drawCrosshairNames.Get() || cg_drawEntityInfo.Get() ) && !cg.renderingThirdPerson;
+		inputs( enabled );
+
+		if ( !enabled )
+		{
+			return true;
+		}
+
+		// The target is scanned for here rather than in DoOnUpdate, as the crosshair
+		// indicator reads whether it is a friend or a foe every frame.
+		CG_ScanForCrosshairEntity();
+
+		int num = cg.crosshairEntityNum;
+		inputs( Alpha() )( num )( cg_drawEntityInfo.Get() )( cg_drawCrosshairNames.Get() );
+
+		if ( num < MAX_CLIENTS )
+		{
+			const clientInfo_t &ci = cgs.clientinfo[ num ];
+			inputs( ci.name )( ci.health )( cg_teamOverlayUserinfo.Get() )( CG_MyTeam() )( cgs.teamInfoReceived );
+		}
+		else
+		{
+			inputs( cg_entities[ num ].currentState.eType );
+		}
+		return true;
+	}
+
 	void DoOnUpdate() override
 	{
 		Rml::String name;
@@ -1817,18 +1979,10 @@ public:
 			return;
 		}
 
-		// scan the known entities to see if the crosshair is sighted on one
-		CG_ScanForCrosshairEntity();
-
 		// draw the name of the player being looked at
-		alpha = CG_FadeAlpha( cg.crosshairEntityTime, CROSSHAIR_CLIENT_TIMEOUT );
-
-		if ( cg.crosshairEntityTime == cg.time )
-		{
-			alpha = 1.0f;
-		}
+		alpha = Alpha();
 
-		else if ( !alpha )
+		if ( !alpha )
 		{
 			Clear();
 			return;
@@ -1879,6 +2033,17 @@ public:
 	}
 
 private:
+	// fade of the target found by CG_ScanForCrosshairEntity
+	static float Alpha()
+	{
+		if ( cg.crosshairEntityTime == cg.time )
+		{
+			return 1.0f;
+		}
+
+		return CG_FadeAlpha( cg.crosshairEntityTime, CROSSHAIR_CLIENT_TIMEOUT );
+	}
+
 	void Clear()
 	{
 		if ( !name_.empty() )
@@ -1898,6 +2063,12 @@ public:
 	LevelshotElement( const Rml::String& tag ) :
 			HudElement( tag, ELEMENT_ALL ), mapIndex_( -1 ) {}
 
+	bool DeclareInputs( HudInputs& inputs ) override
+	{
+		inputs( rocketInfo.data.mapIndex )( rocketInfo.data.mapList.size() );
+		return true;
+	}
+
 	void DoOnUpdate() override
 	{
 		if ( rocketInfo.data.mapIndex < 0 ||
@@ -2115,6 +2286,54 @@ private:
 	}
 };
 
+class HudStatsElement : public HudElement
+{
+public:
+	HudStatsElement( const Rml::String& tag ) :
+			HudElement( tag, ELEMENT_ALL ),
+			nextRefresh_( 0 ),
+			shown_( false ) {}
+
+	void DoOnUpdate() override
+	{
+		if ( !cg_hudStats.Get() )
+		{
+			if ( shown_ )
+			{
+				SetInnerRML( "" );
+				hudElementStats.clear();
+				shown_ = false;
+			}
+			return;
+		}
+
+		int now = trap_Milliseconds();
+
+		if ( now < nextRefresh_ )
+		{
+			return;
+		}
+
+		nextRefresh_ = now + 500;
+		shown_ = true;
+
+		std::string innerRML;
+		for ( const auto &stats : hudElementStats )
+		{
+			int average = stats.second.updates ? stats.second.usec / stats.second.updates : 0;
+			innerRML += Str::Format( "%s: %d updated, %d skipped, %d us avg<br/>",
+			                         stats.first, stats.second.updates, stats.second.skipped, average );
+		}
+
+		SetInnerRML( innerRML );
+		hudElementStats.clear();
+	}
+
+private:
+	int nextRefresh_;
+	bool shown_;
+};
+
 class BeaconAgeElement : public TextHudElement
 {
 public:
@@ -3976,4 +4195,5 @@ void CG_Rocket_RegisterElements()
 	RegisterElement<NumSpawnsElement>( "numSpawns" );
 	RegisterElement<PlayerCountElement>( "playerCount" );
 	RegisterElement<BPVampireElement>( "bpVampire" );
+	RegisterElement<HudStatsElement>( "hud_stats" );
 }
@@ -28,6 +28,10 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "common/Common.h"
 #include "common/FileSystem.h"
 #include "cg_local.h"
+#include "shared/Parallel.h"
+#include "shared/parse.h"
+
+#include <deque>
 
 static Log::Logger logs = Log::Logger("cgame.trails", "[Trail Systems]");
 
@@ -36,6 +40,14 @@ static baseTrailBeam_t   baseTrailBeams[ MAX_BASETRAIL_BEAMS ];
 static int               numBaseTrailSystems = 0;
 static int               numBaseTrailBeams = 0;
 
+// What a job parsed from a trail file, before it is added to the above.
+// The deque keeps the parsed beams where they are pointed to.
+struct trailScript_t : cgScript_t
+{
+	std::vector<baseTrailSystem_t> systems;
+	std::deque<baseTrailBeam_t>    beams;
+};
+
 static trailSystem_t     trailSystems[ MAX_TRAIL_SYSTEMS ];
 static trailBeam_t       trailBeams[ MAX_TRAIL_BEAMS ];
 
@@ -705,12 +717,14 @@ CG_ParseTrailBeam
 Parse a trail beam
 ===============
 */
-static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const char **text_p )
+static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const char **text_p, cgScript_t &script )
 {
+	char tokenBuffer[ MAX_TOKEN_CHARS ];
+
 	// read optional parameters
 	while ( 1 )
 	{
-		const char *token = COM_Parse( text_p );
+		const char *token = COM_Parse_r( text_p, tokenBuffer );
 
 		if ( !*token )
 		{
@@ -719,7 +733,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 
 		if ( !Q_stricmp( token, "segments" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -731,14 +745,14 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 			if ( btb->numSegments >= MAX_TRAIL_BEAM_NODES )
 			{
 				btb->numSegments = MAX_TRAIL_BEAM_NODES - 1;
-				logs.Warn( "too many segments in trail beam" );
+				script.Warn( "too many segments in trail beam" );
 			}
 
 			continue;
 		}
 		else if ( !Q_stricmp( token, "width" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -747,7 +761,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 
 			btb->frontWidth = atof_neg( token, false );
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -767,7 +781,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 		}
 		else if ( !Q_stricmp( token, "alpha" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -776,7 +790,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 
 			btb->frontAlpha = atof_neg( token, false );
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -796,7 +810,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 		}
 		else if ( !Q_stricmp( token, "color" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -805,12 +819,12 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 
 			if ( !Q_stricmp( token, "{" ) )
 			{
-				if ( !CG_ParseColor( btb->frontColor, text_p ) )
+				if ( !CG_ParseColor( btb->frontColor, text_p, script ) )
 				{
 					break;
 				}
 
-				token = COM_Parse( text_p );
+				token = COM_Parse_r( text_p, tokenBuffer );
 
 				if ( !*token )
 				{
@@ -825,20 +839,20 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 				}
 				else if ( !Q_stricmp( token, "{" ) )
 				{
-					if ( !CG_ParseColor( btb->backColor, text_p ) )
+					if ( !CG_ParseColor( btb->backColor, text_p, script ) )
 					{
 						break;
 					}
 				}
 				else
 				{
-					logs.Warn( "missing '{'" );
+					script.Warn( "missing '{'" );
 					break;
 				}
 			}
 			else
 			{
-				logs.Warn( "missing '{'" );
+				script.Warn( "missing '{'" );
 				break;
 			}
 
@@ -846,7 +860,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 		}
 		else if ( !Q_stricmp( token, "segmentTime" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -858,7 +872,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 		}
 		else if ( !Q_stricmp( token, "fadeOutTime" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -870,7 +884,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 		}
 		else if ( !Q_stricmp( token, "shader" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -883,7 +897,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 		}
 		else if ( !Q_stricmp( token, "textureType" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -894,7 +908,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 			{
 				btb->textureType = TBTT_STRETCH;
 
-				token = COM_Parse( text_p );
+				token = COM_Parse_r( text_p, tokenBuffer );
 
 				if ( !*token )
 				{
@@ -903,7 +917,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 
 				btb->frontTextureCoord = atof_neg( token, false );
 
-				token = COM_Parse( text_p );
+				token = COM_Parse_r( text_p, tokenBuffer );
 
 				if ( !*token )
 				{
@@ -916,7 +930,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 			{
 				btb->textureType = TBTT_REPEAT;
 
-				token = COM_Parse( text_p );
+				token = COM_Parse_r( text_p, tokenBuffer );
 
 				if ( !*token )
 				{
@@ -933,11 +947,11 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 				}
 				else
 				{
-					logs.Warn( "unknown textureType clamp \"%s\"", token );
+					script.Warn( "unknown textureType clamp \"%s\"", token );
 					break;
 				}
 
-				token = COM_Parse( text_p );
+				token = COM_Parse_r( text_p, tokenBuffer );
 
 				if ( !*token )
 				{
@@ -948,7 +962,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 			}
 			else
 			{
-				logs.Warn( "unknown textureType \"%s\"", token );
+				script.Warn( "unknown textureType \"%s\"", token );
 				break;
 			}
 
@@ -957,7 +971,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 		else if ( !Q_stricmp( token, "realLight" ) )
 		{
 			btb->realLight = true;
-			Log::Warn( "Trail system %s: realLight keyword is deprecated, use a diffuseMap stage to light particles instead",
+			script.Warn( "Trail system %s: realLight keyword is deprecated, use a diffuseMap stage to light particles instead",
 				name );
 			continue;
 		}
@@ -965,11 +979,11 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 		{
 			if ( btb->numJitters == MAX_TRAIL_BEAM_JITTERS )
 			{
-				logs.Warn( "too many jitters" );
+				script.Warn( "too many jitters" );
 				break;
 			}
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -978,7 +992,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 
 			btb->jitters[ btb->numJitters ].magnitude = atof_neg( token, false );
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1001,7 +1015,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 		{
 			btb->dynamicLight = true;
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1010,7 +1024,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 
 			btb->dLightRadius = atof( token );
 
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1019,7 +1033,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 
 			if ( !Q_stricmp( token, "{" ) )
 			{
-				if ( !CG_ParseColor( btb->dLightColor, text_p ) )
+				if ( !CG_ParseColor( btb->dLightColor, text_p, script ) )
 				{
 					break;
 				}
@@ -1031,7 +1045,7 @@ static bool CG_ParseTrailBeam( baseTrailBeam_t *btb, const char* name, const cha
 		}
 		else
 		{
-			logs.Warn( "unknown token '%s' in trail beam", token );
+			script.Warn( "unknown token '%s' in trail beam", token );
 			return false;
 		}
 	}
@@ -1068,12 +1082,14 @@ CG_ParseTrailSystem
 Parse a trail system section
 ===============
 */
-static bool CG_ParseTrailSystem( baseTrailSystem_t *bts, const char **text_p, const char *name )
+static bool CG_ParseTrailSystem( baseTrailSystem_t *bts, const char **text_p, const char *name, trailScript_t &script )
 {
+	char tokenBuffer[ MAX_TOKEN_CHARS ];
+
 	// read optional parameters
 	while ( 1 )
 	{
-		const char *token = COM_Parse( text_p );
+		const char *token = COM_Parse_r( text_p, tokenBuffer );
 
 		if ( !*token )
 		{
@@ -1082,31 +1098,27 @@ static bool CG_ParseTrailSystem( baseTrailSystem_t *bts, const char **text_p, co
 
 		if ( !Q_stricmp( token, "{" ) )
 		{
-			CG_InitialiseBaseTrailBeam( &baseTrailBeams[ numBaseTrailBeams ] );
+			script.beams.emplace_back();
+			baseTrailBeam_t *btb = &script.beams.back();
+
+			CG_InitialiseBaseTrailBeam( btb );
 
-			if ( !CG_ParseTrailBeam( &baseTrailBeams[ numBaseTrailBeams ], name, text_p ) )
+			if ( !CG_ParseTrailBeam( btb, name, text_p, script ) )
 			{
-				logs.Warn( "failed to parse trail beam" );
+				script.Warn( "failed to parse trail beam" );
 				return false;
 			}
 
 			if ( bts->numBeams == MAX_BEAMS_PER_SYSTEM )
 			{
-				logs.Warn( "trail system has > %d beams", MAX_BEAMS_PER_SYSTEM );
-				return false;
-			}
-			else if ( numBaseTrailBeams == MAX_BASETRAIL_BEAMS )
-			{
-				logs.Warn( "maximum number of trail beams (%d) reached",
-				           MAX_BASETRAIL_BEAMS );
+				script.Warn( "trail system has > %d beams", MAX_BEAMS_PER_SYSTEM );
 				return false;
 			}
 			else
 			{
 				//start parsing beams again
-				bts->beams[ bts->numBeams ] = &baseTrailBeams[ numBaseTrailBeams ];
+				bts->beams[ bts->numBeams ] = btb;
 				bts->numBeams++;
-				numBaseTrailBeams++;
 			}
 
 			continue;
@@ -1117,7 +1129,7 @@ static bool CG_ParseTrailSystem( baseTrailSystem_t *bts, const char **text_p, co
 		}
 		else if ( !Q_stricmp( token, "lifeTime" ) )
 		{
-			token = COM_Parse( text_p );
+			token = COM_Parse_r( text_p, tokenBuffer );
 
 			if ( !*token )
 			{
@@ -1133,12 +1145,12 @@ static bool CG_ParseTrailSystem( baseTrailSystem_t *bts, const char **text_p, co
 		}
 		else if ( !Q_stricmp( token, "}" ) )
 		{
-			logs.WithoutSuppression().Notice( "Parsed trail system %s", name );
+			script.Notice( "Parsed trail system %s", name );
 			return true; //reached the end of this trail system
 		}
 		else
 		{
-			logs.Warn( "unknown token '%s' in trail system %s", token, bts->name );
+			script.Warn( "unknown token '%s' in trail system %s", token, bts->name );
 			return false;
 		}
 	}
@@ -1150,31 +1162,22 @@ static bool CG_ParseTrailSystem( baseTrailSystem_t *bts, const char **text_p, co
 ===============
 CG_ParseTrailFile
 
-Load the trail systems from a trail file
+Parse the trail systems of a trail file, in a job
 ===============
 */
-static bool CG_ParseTrailFile( const char *fileName )
+static bool CG_ParseTrailFile( trailScript_t &script )
 {
-	const char         *text_p;
-	int          i;
+	char         tokenBuffer[ MAX_TOKEN_CHARS ];
 	char         tsName[ MAX_QPATH ];
 	bool     tsNameSet = false;
 
-	std::error_code err;
-	std::string text = FS::PakPath::ReadFile( fileName, err );
-	if ( err )
-	{
-		Log::Warn( "couldn't read trail system file '%s': %s", fileName, err.message() );
-		return false;
-	}
-
 	// parse the text
-	text_p = text.c_str();
+	const char *text_p = script.text.c_str();
 
 	// read optional parameters
 	while ( 1 )
 	{
-		const char *token = COM_Parse( &text_p );
+		const char *token = COM_Parse_r( &text_p, tokenBuffer );
 
 		if ( !*token )
 		{
@@ -1185,43 +1188,25 @@ static bool CG_ParseTrailFile( const char *fileName )
 		{
 			if ( tsNameSet )
 			{
-				//check for name space clashes
-				for ( i = 0; i < numBaseTrailSystems; i++ )
-				{
-					if ( !Q_stricmp( baseTrailSystems[ i ].name, tsName ) )
-					{
-						logs.Warn( "a trail system is already named %s", tsName );
-						return false;
-					}
-				}
+				script.systems.emplace_back();
+				baseTrailSystem_t *bts = &script.systems.back();
 
-				Q_strncpyz( baseTrailSystems[ numBaseTrailSystems ].name, tsName, MAX_QPATH );
+				Q_strncpyz( bts->name, tsName, MAX_QPATH );
 
-				if ( !CG_ParseTrailSystem( &baseTrailSystems[ numBaseTrailSystems ], &text_p, tsName ) )
+				if ( !CG_ParseTrailSystem( bts, &text_p, tsName, script ) )
 				{
-					logs.Warn( "%s: failed to parse trail system %s", fileName, tsName );
+					script.Warn( "%s: failed to parse trail system %s", script.name, tsName );
+					script.systems.pop_back();
 					return false;
 				}
 
 				//start parsing trail systems again
 				tsNameSet = false;
-
-				if ( numBaseTrailSystems == MAX_BASETRAIL_SYSTEMS )
-				{
-					logs.Warn( "maximum number of trail systems (%d) reached",
-					           MAX_BASETRAIL_SYSTEMS );
-					return false;
-				}
-				else
-				{
-					numBaseTrailSystems++;
-				}
-
 				continue;
 			}
 			else
 			{
-				logs.Warn( "unnamed trail system" );
+				script.Warn( "unnamed trail system" );
 				return false;
 			}
 		}
@@ -1233,7 +1218,7 @@ static bool CG_ParseTrailFile( const char *fileName )
 		}
 		else
 		{
-			logs.Warn( "trail system already named" );
+			script.Warn( "trail system already named" );
 			return false;
 		}
 	}
@@ -1241,6 +1226,54 @@ static bool CG_ParseTrailFile( const char *fileName )
 	return true;
 }
 
+/*
+===============
+CG_AddTrailFile
+
+Add the trail systems parsed from a file, on the main thread
+===============
+*/
+static void CG_AddTrailFile( const trailScript_t &script )
+{
+	for ( const baseTrailSystem_t &parsed : script.systems )
+	{
+		//check for name space clashes, also with the other files
+		for ( int i = 0; i < numBaseTrailSystems; i++ )
+		{
+			if ( !Q_stricmp( baseTrailSystems[ i ].name, parsed.name ) )
+			{
+				logs.Warn( "a trail system is already named %s", parsed.name );
+				return;
+			}
+		}
+
+		if ( numBaseTrailSystems == MAX_BASETRAIL_SYSTEMS )
+		{
+			logs.Warn( "maximum number of trail systems (%d) reached",
+			           MAX_BASETRAIL_SYSTEMS );
+			return;
+		}
+
+		if ( numBaseTrailBeams + parsed.numBeams > MAX_BASETRAIL_BEAMS )
+		{
+			logs.Warn( "maximum number of trail beams (%d) reached",
+			           MAX_BASETRAIL_BEAMS );
+			return;
+		}
+
+		// copy the system, pointing it to the copies of its beams
+		baseTrailSystem_t *bts = &baseTrailSystems[ numBaseTrailSystems++ ];
+		*bts = parsed;
+
+		for ( int i = 0; i < bts->numBeams; i++ )
+		{
+			baseTrailBeam_t *btb = &baseTrailBeams[ numBaseTrailBeams++ ];
+			*btb = *bts->beams[ i ];
+			bts->beams[ i ] = btb;
+		}
+	}
+}
+
 /*
 ===============
 CG_LoadTrailSystems
@@ -1250,10 +1283,7 @@ Load trail system templates
 */
 void CG_LoadTrailSystems()
 {
-	int  i, numFiles, fileLen;
-	char fileList[ MAX_TRAIL_FILES * MAX_QPATH ];
-	char fileName[ MAX_QPATH ];
-	char *filePtr;
+	int  i;
 
 	//clear out the old
 	numBaseTrailSystems = 0;
@@ -1271,18 +1301,31 @@ void CG_LoadTrailSystems()
 		*btb = {};
 	}
 
-	//and bring in the new
-	numFiles = trap_FS_GetFileList( "scripts", ".trail",
-	                                fileList, MAX_TRAIL_FILES * MAX_QPATH );
-	filePtr = fileList;
+	//and bring in the new: the files are read here, parsed by jobs, and
+	//added in order
+	std::vector<trailScript_t> scripts;
+	for ( const std::string &fileName : CG_ScriptFiles( ".trail", MAX_TRAIL_FILES ) )
+	{
+		trailScript_t script;
+
+		if ( CG_ReadScript( script, fileName ) )
+		{
+			scripts.push_back( std::move( script ) );
+		}
+	}
+
+	Parallel::SetNumThreads( cg_workerThreads.Get() );
+	Parallel::For( scripts.size(), 2, [ &scripts ]( int begin, int end ) {
+		for ( int i = begin; i < end; i++ )
+		{
+			CG_ParseTrailFile( scripts[ i ] );
+		}
+	} );
 
-	for ( i = 0; i < numFiles; i++, filePtr += fileLen + 1 )
+	for ( trailScript_t &script : scripts )
 	{
-		fileLen = strlen( filePtr );
-		Q_strncpyz( fileName, "scripts/", sizeof fileName );
-		Q_strcat( fileName, sizeof fileName, filePtr );
-		// Log::Notice(_( "...loading '%s'"), fileName );
-		CG_ParseTrailFile( fileName );
+		script.Flush( logs );
+		CG_AddTrailFile( script );
 	}
 }
 
@@ -27,21 +27,100 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 // cg_utils.c -- utility functions
 
 #include "common/Common.h"
+#include "common/FileSystem.h"
 #include "cg_local.h"
+#include "shared/parse.h"
+
+/*
+===============
+cgScript_t::Flush
+
+Log the messages of the job that parsed the script
+===============
+*/
+void cgScript_t::Flush( Log::Logger &logger )
+{
+	for ( const auto &message : messages )
+	{
+		switch ( message.first )
+		{
+			case Log::Level::WARNING:
+				logger.Warn( "%s", message.second );
+				break;
+
+			case Log::Level::NOTICE:
+				logger.WithoutSuppression().Notice( "%s", message.second );
+				break;
+
+			default:
+				logger.Debug( "%s", message.second );
+				break;
+		}
+	}
+
+	messages.clear();
+}
+
+/*
+===============
+CG_ScriptFiles
+
+The names of the scripts/ files with this extension
+===============
+*/
+std::vector<std::string> CG_ScriptFiles( const char *extension, int maxFiles )
+{
+	std::vector<char> fileList( maxFiles * MAX_QPATH );
+	int numFiles = trap_FS_GetFileList( "scripts", extension, fileList.data(), static_cast<int>( fileList.size() ) );
+
+	std::vector<std::string> fileNames;
+	const char *filePtr = fileList.data();
+
+	for ( int i = 0; i < numFiles; i++ )
+	{
+		fileNames.push_back( Str::Format( "scripts/%s", filePtr ) );
+		filePtr += strlen( filePtr ) + 1;
+	}
+
+	return fileNames;
+}
+
+/*
+===============
+CG_ReadScript
+
+Read a script on the main thread, as the file system can't be used from jobs
+===============
+*/
+bool CG_ReadScript( cgScript_t &script, const std::string &fileName )
+{
+	std::error_code err;
+	script.name = fileName;
+	script.text = FS::PakPath::ReadFile( fileName, err );
+
+	if ( err )
+	{
+		Log::Warn( "couldn't read script '%s': %s", fileName, err.message() );
+		return false;
+	}
+
+	return true;
+}
 
 /*
 ===============
 CG_ParseColor
 ===============
 */
-bool CG_ParseColor( byte *c, const char **text_p )
+bool CG_ParseColor( byte *c, const char **text_p, cgScript_t &script )
 {
+	char       tokenBuffer[ MAX_TOKEN_CHARS ];
 	const char *token;
 	int  i;
 
 	for ( i = 0; i <= 2; i++ )
 	{
-		token = COM_Parse( text_p );
+		token = COM_Parse_r( text_p, tokenBuffer );
 
 		if ( !*token )
 		{
@@ -51,11 +130,11 @@ bool CG_ParseColor( byte *c, const char **text_p )
 		c[ i ] = ( int )( ( float ) 0xFF * atof_neg( token, false ) );
 	}
 
-	token = COM_Parse( text_p );
+	token = COM_Parse_r( text_p, tokenBuffer );
 
 	if ( strcmp( token, "}" ) )
 	{
-		Log::Warn( "missing '}'" );
+		script.Warn( "missing '}'" );
 		return false;
 	}
 
@@ -47,37 +47,58 @@ public:
 	~RocketDataGrid() { }
 	void GetRow( Rml::StringList& row, const Rml::String& table, int row_index, const Rml::StringList& columns )
 	{
-		if ( data.find( table ) == data.end() || data[table].size() <= (unsigned) row_index )
+		auto it = data.find( table );
+
+		if ( it == data.end() || it->second.size() <= (unsigned) row_index )
 		{
 			return;
 		}
 
+		Row &source = it->second[ row_index ];
+
 		for ( auto &&column : columns )
 		{
-			row.emplace_back( Rocket_QuakeToRML( Info_ValueForKey( data[ table ][ row_index ].c_str(), column.c_str() ), RP_EMOTICONS ) );
+			row.emplace_back( source.Cell( column ) );
 		}
 	}
 
 	int GetNumRows( const Rml::String& table )
 	{
-		return data[ table ].size();
+		auto it = data.find( table );
+		return it == data.end() ? 0 : it->second.size();
 	}
 
 	void AddRow( const char *table, const char *dataIn )
 	{
-		data[ table ].push_back( dataIn );
-		NotifyRowAdd( table, data[ table ].size() - 1, 1 );
+		std::vector<Row> &rows = data[ table ];
+		rows.emplace_back( dataIn );
+		NotifyRowAdd( table, rows.size() - 1, 1 );
+	}
+
+	void InsertRow( const char *table, const int row, const char *dataIn )
+	{
+		std::vector<Row> &rows = data[ table ];
+		rows.emplace( rows.begin() + row, dataIn );
+		NotifyRowAdd( table, row, 1 );
 	}
 
 	void ChangeRow( const char *table, const int row, const char *dataIn )
 	{
-		data[ table ][ row ] = dataIn;
+		Row &changed = data[ table ][ row ];
+
+		if ( changed.info == dataIn )
+		{
+			return;
+		}
+
+		changed = Row( dataIn );
 		NotifyRowChange( table, row, 1 );
 	}
 
 	void RemoveRow( const char *table, const int row )
 	{
-		data[ table ].erase( data[ table ].begin() + row - 1 );
+		std::vector<Row> &rows = data[ table ];
+		rows.erase( rows.begin() + row );
 		NotifyRowRemove( table, row, 1 );
 	}
 
@@ -89,7 +110,30 @@ public:
 
 
 private:
-	std::map<Rml::String, std::vector<Rml::String> > data;
+	// A row is kept as the infostring it was given, plus the values of the
+	// columns that were displayed already, converted to RML. Redraws then
+	// don't parse the infostring and convert colours and emoticons again.
+	struct Row
+	{
+		Rml::String info;
+		std::unordered_map<Rml::String, Rml::String> cells;
+
+		Row( const char *info ) : info( info ) { }
+
+		const Rml::String &Cell( const Rml::String &column )
+		{
+			auto it = cells.find( column );
+
+			if ( it == cells.end() )
+			{
+				it = cells.emplace( column, Rocket_QuakeToRML( Info_ValueForKey( info.c_str(), column.c_str() ), RP_EMOTICONS ) ).first;
+			}
+
+			return it->second;
+		}
+	};
+
+	std::unordered_map<Rml::String, std::vector<Row> > data;
 };
 
 #endif
@@ -36,6 +36,7 @@ Maryland 20850 USA.
 #include "rocket.h"
 #include <RmlUi/Core.h>
 #include "rocketDataGrid.h"
+#include "shared/Timing.h"
 #include <string>
 #include <map>
 
@@ -75,6 +76,19 @@ void Rocket_DSAddRow( const char *name, const char *table, const char *data )
 	ds->AddRow( table, data );
 }
 
+void Rocket_DSInsertRow( const char *name, const char *table, const int row, const char *data )
+{
+	RocketDataGrid *ds = FindDataSource( name );
+
+	if ( !ds )
+	{
+		Log::Warn( "Rocket_DSInsertRow: data source %s does not exist.", name );
+		return;
+	}
+
+	ds->InsertRow( table, row, data );
+}
+
 void Rocket_DSChangeRow( const char *name, const char *table, const int row, const char *data )
 {
 	RocketDataGrid *ds = FindDataSource( name );
@@ -113,3 +127,65 @@ void Rocket_DSClearTable( const char *name, const char *table )
 
 	ds->ClearTable( table );
 }
+
+class BenchmarkDataGridCmd : public Cmd::StaticCmd
+{
+public:
+	BenchmarkDataGridCmd() : StaticCmd( "benchmarkDataGrid",
+		"time filling and redrawing a data grid table: benchmarkDataGrid [rows] [redraws]" ) {}
+
+	void Run( const Cmd::Args &args ) const override
+	{
+		int rows = args.Argc() > 1 ? std::max( 1, atoi( args.Argv( 1 ).c_str() ) ) : 1000;
+		int redraws = args.Argc() > 2 ? std::max( 1, atoi( args.Argv( 2 ).c_str() ) ) : 10;
+		const Rml::StringList columns = { "name", "ping", "map", "players" };
+
+		std::vector<std::string> infos;
+		for ( int i = 0; i < rows; i++ )
+		{
+			infos.push_back( Str::Format( "\\name\\^%dPlayer [%d]^7 server\\ping\\%d\\map\\plat23\\players\\%d/24",
+			                              i % 10, i, 20 + i % 200, i % 25 ) );
+		}
+
+		RocketDataGrid grid( "benchmarkDataGrid" );
+
+		auto start = Timing::Now();
+		for ( const std::string &info : infos )
+		{
+			grid.AddRow( "default", info.c_str() );
+		}
+		int fillUsec = Timing::Elapsed( start );
+
+		// converting every cell on every redraw, as it used to be done
+		start = Timing::Now();
+		for ( int redraw = 0; redraw < redraws; redraw++ )
+		{
+			for ( const std::string &info : infos )
+			{
+				Rml::StringList row;
+				for ( const Rml::String &column : columns )
+				{
+					row.emplace_back( Rocket_QuakeToRML( Info_ValueForKey( info.c_str(), column.c_str() ), RP_EMOTICONS ) );
+				}
+			}
+		}
+		int convertUsec = Timing::Elapsed( start );
+
+		start = Timing::Now();
+		for ( int redraw = 0; redraw < redraws; redraw++ )
+		{
+			for ( int i = 0; i < rows; i++ )
+			{
+				Rml::StringList row;
+				grid.GetRow( row, "default", i, columns );
+			}
+		}
+		int redrawUsec = Timing::Elapsed( start );
+
+		Print( "%d rows, %d redraws", rows, redraws );
+		Print( "fill:                      %d us", fillUsec );
+		Print( "redraws converting cells:  %d us", convertUsec );
+		Print( "redraws from the grid:     %d us", redrawUsec );
+	}
+};
+static BenchmarkDataGridCmd benchmarkDataGridRegistration;
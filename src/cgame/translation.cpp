@@ -45,9 +45,11 @@ Maryland 20850 USA.
 static Log::Logger LOG(VM_STRING_PREFIX "translation");
 using namespace tinygettext;
 
-// Ugly char buffer
-static std::string gettextbuffer[ 4 ];
-static int num = -1;
+// Translated messages for the current language, keyed by msgid (with the
+// context or plural form folded in). Nodes are never moved, so returned
+// pointers stay valid until the language changes.
+static std::unordered_map<std::string, std::string> translationCache;
+static std::string translationKey;
 
 // Should be ROM but that doesn't work in gamelogic
 static Cvar::Cvar<std::string> trans_encodings("trans_encodings", "Supported values for 'language' cvar", Cvar::NONE, "");
@@ -249,6 +251,7 @@ static void Trans_SetLanguage( const char* lang )
 	}
 
 	trans_manager.set_language( bestLang );
+	translationCache.clear();
 
 	LOG.Notice( "Set language to %s_%s (%s)" , bestLang.get_language().c_str() , bestLang.get_country().c_str() , bestLang.get_name().c_str() );
 }
@@ -297,6 +300,27 @@ void Trans_Init()
 	Trans_SetLanguage( Cvar::GetValue( "language" ).c_str() );
 }
 
+/*
+============
+Trans_Cached
+
+Looks up translationKey in the cache, translating and inserting the message
+on a miss.
+============
+*/
+template<typename Translate>
+static const char* Trans_Cached( Translate translate )
+{
+	auto it = translationCache.find( translationKey );
+
+	if ( it == translationCache.end() )
+	{
+		it = translationCache.emplace( translationKey, translate() ).first;
+	}
+
+	return it->second.c_str();
+}
+
 const char* Trans_Gettext( const char *msgid )
 {
 	LOG.Debug( "translate[_]: %s", msgid );
@@ -305,9 +329,10 @@ const char* Trans_Gettext( const char *msgid )
 		return msgid;
 	}
 
-	num = ( num + 1 ) & 3;
-	gettextbuffer[ num ] = trans_manager.get_dictionary().translate( msgid );
-	return gettextbuffer[ num ].c_str();
+	translationKey.assign( msgid );
+	return Trans_Cached( [ msgid ] {
+		return trans_manager.get_dictionary().translate( msgid );
+	} );
 }
 
 const char* Trans_Pgettext( const char *ctxt, const char *msgid )
@@ -318,9 +343,13 @@ const char* Trans_Pgettext( const char *ctxt, const char *msgid )
 		return msgid;
 	}
 
-	num = ( num + 1 ) & 3;
-	gettextbuffer[ num ] = trans_manager.get_dictionary().translate_ctxt( ctxt, msgid );
-	return gettextbuffer[ num ].c_str();
+	// same separator as in .mo files, so it can't clash with a plain msgid
+	translationKey.assign( ctxt );
+	translationKey += '\x04';
+	translationKey += msgid;
+	return Trans_Cached( [ ctxt, msgid ] {
+		return trans_manager.get_dictionary().translate_ctxt( ctxt, msgid );
+	} );
 }
 
 const char* Trans_GettextPlural( const char *msgid, const char *msgid_plural, int number )
@@ -341,7 +370,18 @@ const char* Trans_GettextPlural( const char *msgid, const char *msgid_plural, in
 		return nullptr;
 	}
 
-	num = ( num + 1 ) & 3;
-	gettextbuffer[ num ] = trans_manager.get_dictionary().translate_plural( msgid, msgid_plural, number );
-	return gettextbuffer[ num ].c_str();
+	// Cache by plural form rather than by number so that counters don't grow
+	// the cache. Untranslated messages fall back on number == 1 instead of the
+	// form, so keep that apart as well.
+	const PluralForms forms = trans_manager.get_dictionary().get_plural_forms();
+	unsigned int form = forms ? forms.get_plural( number ) : ( number == 1 ? 0 : 1 );
+
+	translationKey.assign( msgid );
+	translationKey += '\0';
+	translationKey += msgid_plural;
+	translationKey += '\0';
+	translationKey += std::to_string( form * 2 + ( number == 1 ) );
+	return Trans_Cached( [ msgid, msgid_plural, number ] {
+		return trans_manager.get_dictionary().translate_plural( msgid, msgid_plural, number );
+	} );
 }
@@ -63,6 +63,167 @@ namespace Beacon //this should eventually become a class
 	static int RemoveSimilar( glm::vec3 const& origin, beaconType_t type, int data, int team, int owner,
 	                          int radius = 128.0f, int eFlags = 0, int eFlagsRelevant = 0 );
 
+	/**
+	 * @brief Keeps track of all beacons by team, type and owner, and of their location in a
+	 *        coarse horizontal grid, so that lookups only visit beacons that could match.
+	 *
+	 * The indexed fields never change during a beacon's lifetime, except for the location.
+	 */
+	namespace Registry
+	{
+		// Horizontal size of a spatial hash cell. Beacons are rarely searched for in large radii.
+		static const float CELL_SIZE = 512.0f;
+
+		static std::unordered_set<gentity_t*> all;
+		static std::vector<gentity_t*> byTeamType[ NUM_TEAMS ][ NUM_BEACON_TYPES ];
+		static std::unordered_map<int, std::vector<gentity_t*>> byOwner;
+		static std::unordered_map<uint64_t, std::vector<gentity_t*>> cells;
+		static uint64_t cellOf[ MAX_GENTITIES ];
+
+		static inline int CellCoord( float x )
+		{
+			return static_cast<int>( floorf( x / CELL_SIZE ) );
+		}
+
+		static inline uint64_t CellKey( int team, int type, int x, int y )
+		{
+			return ( static_cast<uint64_t>( team ) << 56 ) |
+			       ( static_cast<uint64_t>( type ) << 48 ) |
+			       ( static_cast<uint64_t>( static_cast<uint16_t>( x ) ) << 16 ) |
+			       static_cast<uint64_t>( static_cast<uint16_t>( y ) );
+		}
+
+		static inline uint64_t CellKey( gentity_t *ent )
+		{
+			return CellKey( ent->s.bc_team, ent->s.bc_type,
+			                CellCoord( ent->s.origin[ 0 ] ), CellCoord( ent->s.origin[ 1 ] ) );
+		}
+
+		static void Erase( std::vector<gentity_t*> &list, gentity_t *ent )
+		{
+			auto it = std::find( list.begin(), list.end(), ent );
+
+			if ( it != list.end() )
+			{
+				*it = list.back();
+				list.pop_back();
+			}
+		}
+
+		static void Clear()
+		{
+			all.clear();
+			byOwner.clear();
+			cells.clear();
+
+			for ( auto &teamLists : byTeamType )
+			{
+				for ( std::vector<gentity_t*> &list : teamLists )
+				{
+					list.clear();
+				}
+			}
+		}
+
+		static void Add( gentity_t *ent )
+		{
+			all.insert( ent );
+			byTeamType[ ent->s.bc_team ][ ent->s.bc_type ].push_back( ent );
+			byOwner[ ent->s.bc_owner ].push_back( ent );
+
+			cellOf[ ent->num() ] = CellKey( ent );
+			cells[ cellOf[ ent->num() ] ].push_back( ent );
+		}
+
+		static void Remove( gentity_t *ent )
+		{
+			if ( !all.erase( ent ) )
+				return;
+
+			Erase( byTeamType[ ent->s.bc_team ][ ent->s.bc_type ], ent );
+
+			auto owned = byOwner.find( ent->s.bc_owner );
+			if ( owned != byOwner.end() )
+			{
+				Erase( owned->second, ent );
+				if ( owned->second.empty() ) byOwner.erase( owned );
+			}
+
+			auto cell = cells.find( cellOf[ ent->num() ] );
+			if ( cell != cells.end() )
+			{
+				Erase( cell->second, ent );
+				if ( cell->second.empty() ) cells.erase( cell );
+			}
+		}
+
+		/**
+		 * @brief Updates the spatial index after a beacon was moved.
+		 */
+		static void Relocate( gentity_t *ent )
+		{
+			if ( !all.count( ent ) )
+				return;
+
+			uint64_t key = CellKey( ent );
+			uint64_t &oldKey = cellOf[ ent->num() ];
+
+			if ( key == oldKey )
+				return;
+
+			auto cell = cells.find( oldKey );
+			if ( cell != cells.end() )
+			{
+				Erase( cell->second, ent );
+				if ( cell->second.empty() ) cells.erase( cell );
+			}
+
+			cells[ key ].push_back( ent );
+			oldKey = key;
+		}
+
+		/**
+		 * @brief Calls a function for every beacon of a team and type in cells overlapping a radius.
+		 */
+		template<typename Func>
+		static void ForEachInRadius( int team, int type, glm::vec3 const& origin, float radius, Func f )
+		{
+			int x0 = CellCoord( origin.x - radius ), x1 = CellCoord( origin.x + radius );
+			int y0 = CellCoord( origin.y - radius ), y1 = CellCoord( origin.y + radius );
+
+			for ( int x = x0; x <= x1; x++ )
+			{
+				for ( int y = y0; y <= y1; y++ )
+				{
+					auto cell = cells.find( CellKey( team, type, x, y ) );
+					if ( cell == cells.end() )
+						continue;
+
+					for ( gentity_t *ent : cell->second )
+					{
+						f( ent );
+					}
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Resets the beacon registry. Must be called before any beacon is created.
+	 */
+	void Init()
+	{
+		Registry::Clear();
+	}
+
+	/**
+	 * @brief Removes a beacon entity that is about to be freed from the registry.
+	 */
+	void Unregister( gentity_t *ent )
+	{
+		Registry::Remove( ent );
+	}
+
 	/**
 	 * @brief A meaningless think function for beacons (everything is now handled in Beacon::Frame).
 	 */
@@ -120,16 +281,23 @@ namespace Beacon //this should eventually become a class
 						ent->tagScore = 0;
 					break;
 
-				case entityType_t::ET_BEACON:
-					if ( ent->s.bc_etime && level.time > ent->s.bc_etime )
-						Delete( ent );
-					continue;
-
 				default:
 					break;
 			}
 		}
 
+		std::vector<gentity_t*> expired;
+		for ( gentity_t *beacon : Registry::all )
+		{
+			if ( beacon->s.bc_etime && level.time > beacon->s.bc_etime )
+				expired.push_back( beacon );
+		}
+
+		for ( gentity_t *beacon : expired )
+		{
+			Delete( beacon );
+		}
+
 		nextframe = level.time + 100;
 	}
 
@@ -141,6 +309,8 @@ namespace Beacon //this should eventually become a class
 		VectorCopy( origin, ent->s.pos.trBase );
 		VectorCopy( origin, ent->r.currentOrigin );
 		VectorCopy( origin, ent->s.origin );
+
+		Registry::Relocate( ent );
 	}
 
 	/**
@@ -186,6 +356,8 @@ namespace Beacon //this should eventually become a class
 		ent->s.pos.trType = trType_t::TR_INTERPOLATE;
 		Move( ent, origin );
 
+		Registry::Add( ent );
+
 		return ent;
 	}
 
@@ -310,54 +482,98 @@ namespace Beacon //this should eventually become a class
 	}
 
 	/**
-	 * @brief Find a beacon matching a pattern.
-	 * @return An ET_BEACON entity or nullptr.
+	 * @brief Find all beacons matching a pattern.
+	 * @param similar Receives the matching ET_BEACON entities in entity number order.
+	 * @param firstOnly Whether to stop looking after the first match.
 	 */
-	static gentity_t *FindSimilar( glm::vec3 const& origin, beaconType_t type, int data, int team, int owner,
-	                               float radius, int eFlags, int eFlagsRelevant )
+	static void FindSimilar( glm::vec3 const& origin, beaconType_t type, int data, int team, int owner,
+	                         float radius, int eFlags, int eFlagsRelevant, std::vector<gentity_t*> &similar,
+	                         bool firstOnly )
 	{
 		int flags = BG_Beacon( type )->flags;
 
-		for ( gentity_t *ent = nullptr; (ent = G_IterateEntities(ent)); )
-		{
-			if ( ent->s.eType != entityType_t::ET_BEACON )
-				continue;
+		similar.clear();
+
+		if ( team < TEAM_NONE || team >= NUM_TEAMS )
+			return;
 
+		auto matches = [&]( gentity_t *ent )
+		{
 			if ( ent->s.bc_type != type )
-				continue;
+				return false;
 
 			if ( ( ent->s.eFlags & eFlagsRelevant ) != ( eFlags & eFlagsRelevant ) )
-				continue;
+				return false;
 
 			if( ent->s.bc_team != team )
-				continue;
+				return false;
 
 			if ( ( flags & BCF_DATA_UNIQUE ) && ent->s.bc_data != data )
-				continue;
+				return false;
 
 			if ( ent->s.eFlags & EF_BC_DYING )
-				continue;
+				return false;
 
 			if     ( flags & BCF_PER_TEAM )
 			{}
 			else if( flags & BCF_PER_PLAYER )
 			{
 				if( ent->s.bc_owner != owner )
-					continue;
+					return false;
 			}
 			else
 			{
 				if ( glm::distance( VEC2GLM( ent->s.origin ), origin ) > radius )
-					continue;
+					return false;
+			}
 
-				if ( !trap_InPVS( ent->s.origin, GLM4READ( origin ) ) )
-					continue;
+			return true;
+		};
+
+		auto consider = [&]( gentity_t *ent )
+		{
+			if ( matches( ent ) )
+				similar.push_back( ent );
+		};
+
+		if ( flags & BCF_PER_TEAM )
+		{
+			for ( gentity_t *ent : Registry::byTeamType[ team ][ type ] )
+				consider( ent );
+		}
+		else if ( flags & BCF_PER_PLAYER )
+		{
+			auto owned = Registry::byOwner.find( owner );
+			if ( owned != Registry::byOwner.end() )
+			{
+				for ( gentity_t *ent : owned->second )
+					consider( ent );
 			}
+		}
+		else
+		{
+			Registry::ForEachInRadius( team, type, origin, radius, consider );
+		}
+
+		// Preserve the order of a scan over all entities, then do the expensive PVS test last.
+		std::sort( similar.begin(), similar.end() );
+
+		if ( !( flags & ( BCF_PER_TEAM | BCF_PER_PLAYER ) ) )
+		{
+			auto end = similar.begin();
+			for ( gentity_t *ent : similar )
+			{
+				if ( firstOnly && end != similar.begin() )
+					break;
 
-			return ent;
+				if ( trap_InPVS( ent->s.origin, GLM4READ( origin ) ) )
+					*end++ = ent;
+			}
+			similar.erase( end, similar.end() );
 		}
 
-		return nullptr;
+		if ( firstOnly && similar.size() > 1 )
+			similar.resize( 1 );
 	}
 
 	/**
@@ -367,14 +583,14 @@ namespace Beacon //this should eventually become a class
 	static int RemoveSimilar( glm::vec3 const& origin, beaconType_t type, int data, int team, int owner,
 	                          int radius, int eFlags, int eFlagsRelevant )
 	{
-		gentity_t *ent;
-		int numRemoved = 0;
-		while ((ent = FindSimilar(origin, type, data, team, owner, radius, eFlags, eFlagsRelevant)))
+		std::vector<gentity_t*> similar;
+		FindSimilar( origin, type, data, team, owner, radius, eFlags, eFlagsRelevant, similar, false );
+
+		for ( gentity_t *ent : similar )
 		{
 			Delete( ent );
-			numRemoved++;
 		}
-		return numRemoved;
+		return similar.size();
 	}
 
 	/**
@@ -384,10 +600,14 @@ namespace Beacon //this should eventually become a class
 	gentity_t *MoveSimilar( glm::vec3 const& from, glm::vec3 const& to, beaconType_t type, int data,
 	                        int team, int owner, float radius, int eFlags, int eFlagsRelevant )
 	{
-		gentity_t *ent;
-		if ((ent = FindSimilar(from, type, data, team, owner, radius, eFlags, eFlagsRelevant)))
-			Move(ent, to);
-		return ent;
+		std::vector<gentity_t*> similar;
+		FindSimilar( from, type, data, team, owner, radius, eFlags, eFlagsRelevant, similar, true );
+
+		if ( similar.empty() )
+			return nullptr;
+
+		Move( similar.front(), to );
+		return similar.front();
 	}
 
 	/**
@@ -432,11 +652,8 @@ namespace Beacon //this should eventually become a class
 	 */
 	void PropagateAll()
 	{
-		for ( gentity_t *ent = nullptr; (ent = G_IterateEntities( ent )); )
+		for ( gentity_t *ent : Registry::all )
 		{
-			if ( ent->s.eType != entityType_t::ET_BEACON )
-				continue;
-
 			Propagate( ent );
 		}
 	}
@@ -448,14 +665,14 @@ namespace Beacon //this should eventually become a class
 	 */
 	void RemoveOrphaned( int clientNum )
 	{
-		for ( gentity_t *ent = nullptr; ( ent = G_IterateEntities( ent ) ); )
-		{
-			if ( ent->s.eType != entityType_t::ET_BEACON )
-				continue;
-
-			if ( ent->s.bc_owner != clientNum )
-				continue;
+		auto owned = Registry::byOwner.find( clientNum );
+		if ( owned == Registry::byOwner.end() )
+			return;
 
+		// Deleting beacons modifies the list.
+		std::vector<gentity_t*> orphans = owned->second;
+		for ( gentity_t *ent : orphans )
+		{
 			Delete( ent );
 		}
 	}
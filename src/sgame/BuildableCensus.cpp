@@ -0,0 +1,247 @@
+/*
+===========================================================================
+
+Unvanquished GPL Source Code
+Copyright (C) 2024 Unvanquished Developers
+
+This file is part of the Unvanquished GPL Source Code (Unvanquished Source Code).
+
+Unvanquished is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Unvanquished is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Unvanquished. If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+
+// BuildableCensus.cpp
+// keeps per-team buildable counts up to date as buildables change state, so
+// that queries don't have to walk over all entities
+
+#include "common/Common.h"
+#include "sg_local.h"
+#include "CBSE.h"
+
+static Log::Logger censusLogger("sgame.census");
+
+namespace BuildableCensus {
+	/**
+	 * @brief Number of buildables by team, type, state and power.
+	 */
+	static int counts[NUM_TEAMS][BA_NUM_BUILDABLES][NUM_STATES][2];
+
+	/**
+	 * @brief Nominal build point value of living buildables by team.
+	 */
+	static int aliveBuildPoints[NUM_TEAMS];
+
+	/**
+	 * @brief Nominal build point value of unpowered buildables by team, including dead ones.
+	 */
+	static int unpoweredBuildPoints[NUM_TEAMS];
+
+	/**
+	 * @brief All buildable entities by type, in order of registration.
+	 */
+	static std::vector<gentity_t*> entities[BA_NUM_BUILDABLES];
+
+	/**
+	 * @brief Entities with a MainBuildableComponent by team. Usually there is at most one.
+	 */
+	static std::vector<gentity_t*> mainBuildables[NUM_TEAMS];
+
+	static void Account(gentity_t *ent, entry_t entry, int sign) {
+		team_t team        = ent->buildableTeam;
+		int    buildable   = ent->s.modelindex;
+		int    buildPoints = BG_Buildable(buildable)->buildPoints;
+
+		ASSERT(team >= TEAM_NONE && team < NUM_TEAMS);
+		ASSERT(buildable > BA_NONE && buildable < BA_NUM_BUILDABLES);
+
+		counts[team][buildable][entry.state][entry.powered] += sign;
+
+		if (entry.state != DEAD) aliveBuildPoints[team]     += sign * buildPoints;
+		if (!entry.powered)      unpoweredBuildPoints[team] += sign * buildPoints;
+	}
+
+	static void Forget(std::vector<gentity_t*> &list, gentity_t *ent) {
+		auto it = std::find(list.begin(), list.end(), ent);
+
+		if (it == list.end()) {
+			censusLogger.Warn("Tried to remove %s from the census but it wasn't registered.", etos(ent));
+			return;
+		}
+
+		// Keep registration order so that lookups return the most recent entity.
+		list.erase(it);
+	}
+
+	void Init() {
+		memset(counts, 0, sizeof(counts));
+		memset(aliveBuildPoints, 0, sizeof(aliveBuildPoints));
+		memset(unpoweredBuildPoints, 0, sizeof(unpoweredBuildPoints));
+
+		for (std::vector<gentity_t*> &list : entities)       list.clear();
+		for (std::vector<gentity_t*> &list : mainBuildables) list.clear();
+	}
+
+	void Add(gentity_t *ent, entry_t entry) {
+		Account(ent, entry, 1);
+		entities[ent->s.modelindex].push_back(ent);
+	}
+
+	void Update(gentity_t *ent, entry_t from, entry_t to) {
+		if (from.state == to.state && from.powered == to.powered) return;
+
+		Account(ent, from, -1);
+		Account(ent, to, 1);
+	}
+
+	void Remove(gentity_t *ent, entry_t entry) {
+		Account(ent, entry, -1);
+		Forget(entities[ent->s.modelindex], ent);
+	}
+
+	void AddMainBuildable(gentity_t *ent) {
+		mainBuildables[ent->buildableTeam].push_back(ent);
+	}
+
+	void RemoveMainBuildable(gentity_t *ent) {
+		Forget(mainBuildables[ent->buildableTeam], ent);
+	}
+
+	int Count(team_t team, buildable_t buildable, state_t state) {
+		return counts[team][buildable][state][false] + counts[team][buildable][state][true];
+	}
+
+	int CountAlive(team_t team, buildable_t buildable) {
+		return Count(team, buildable, CONSTRUCTING) + Count(team, buildable, CONSTRUCTED);
+	}
+
+	int CountActive(team_t team, buildable_t buildable) {
+		return counts[team][buildable][CONSTRUCTED][true];
+	}
+
+	int AliveBuildPoints(team_t team) {
+		return aliveBuildPoints[team];
+	}
+
+	int UnpoweredBuildPoints(team_t team) {
+		return unpoweredBuildPoints[team];
+	}
+
+	gentity_t *Find(buildable_t buildable) {
+		const std::vector<gentity_t*> &list = entities[buildable];
+		return list.empty() ? nullptr : list.back();
+	}
+
+	gentity_t *MainBuildable(team_t team) {
+		if (!G_IsPlayableTeam(team)) return nullptr;
+
+		const std::vector<gentity_t*> &list = mainBuildables[team];
+		return list.empty() ? nullptr : list.back();
+	}
+
+	gentity_t *ActiveMainBuildable(team_t team) {
+		if (!G_IsPlayableTeam(team)) return nullptr;
+
+		const std::vector<gentity_t*> &list = mainBuildables[team];
+		for (auto it = list.rbegin(); it != list.rend(); ++it) {
+			if ((*it)->entity->Get<BuildableComponent>()->GetState() == BuildableComponent::CONSTRUCTED) {
+				return *it;
+			}
+		}
+		return nullptr;
+	}
+
+	/**
+	 * @brief Recounts all buildables from scratch and compares the result with the census.
+	 * @return Whether the census is consistent.
+	 */
+	bool Verify() {
+		static int recount[NUM_TEAMS][BA_NUM_BUILDABLES][NUM_STATES][2];
+		int recountAliveBP[NUM_TEAMS] = {};
+		int recountUnpoweredBP[NUM_TEAMS] = {};
+		size_t recountEntities[BA_NUM_BUILDABLES] = {};
+		size_t recountMain[NUM_TEAMS] = {};
+		bool consistent = true;
+
+		memset(recount, 0, sizeof(recount));
+
+		ForEntities<BuildableComponent>([&](Entity& entity, BuildableComponent& buildableComponent) {
+			gentity_t *ent  = entity.oldEnt;
+			team_t    team  = ent->buildableTeam;
+			int       type  = ent->s.modelindex;
+			int       cost  = BG_Buildable(type)->buildPoints;
+			entry_t   entry = buildableComponent.CensusEntry();
+
+			recount[team][type][entry.state][entry.powered]++;
+			if (entry.state != DEAD) recountAliveBP[team]     += cost;
+			if (!entry.powered)      recountUnpoweredBP[team] += cost;
+			recountEntities[type]++;
+
+			if (entity.Get<MainBuildableComponent>()) {
+				recountMain[team]++;
+
+				if (std::find(mainBuildables[team].begin(), mainBuildables[team].end(), ent) ==
+				    mainBuildables[team].end()) {
+					censusLogger.Warn("Main buildable %s is missing from the census.", etos(ent));
+					consistent = false;
+				}
+			}
+		});
+
+		for (int team = TEAM_NONE; team < NUM_TEAMS; team++) {
+			for (int type = BA_NONE + 1; type < BA_NUM_BUILDABLES; type++) {
+				for (int state = 0; state < NUM_STATES; state++) {
+					for (int powered = 0; powered < 2; powered++) {
+						int expected = recount[team][type][state][powered];
+						int actual   = counts[team][type][state][powered];
+
+						if (expected != actual) {
+							censusLogger.Warn("Census of %s (team %d, state %d, powered %d) is %d, should be %d.",
+							                  BG_Buildable(type)->name, team, state, powered, actual, expected);
+							consistent = false;
+						}
+					}
+				}
+			}
+
+			if (recountAliveBP[team] != aliveBuildPoints[team]) {
+				censusLogger.Warn("Census of alive build points of team %d is %d, should be %d.",
+				                  team, aliveBuildPoints[team], recountAliveBP[team]);
+				consistent = false;
+			}
+
+			if (recountUnpoweredBP[team] != unpoweredBuildPoints[team]) {
+				censusLogger.Warn("Census of unpowered build points of team %d is %d, should be %d.",
+				                  team, unpoweredBuildPoints[team], recountUnpoweredBP[team]);
+				consistent = false;
+			}
+
+			if (recountMain[team] != mainBuildables[team].size()) {
+				censusLogger.Warn("Census has %zu main buildables for team %d, should be %zu.",
+				                  mainBuildables[team].size(), team, recountMain[team]);
+				consistent = false;
+			}
+		}
+
+		for (int type = BA_NONE + 1; type < BA_NUM_BUILDABLES; type++) {
+			if (recountEntities[type] != entities[type].size()) {
+				censusLogger.Warn("Census has %zu entities of type %s, should be %zu.",
+				                  entities[type].size(), BG_Buildable(type)->name, recountEntities[type]);
+				consistent = false;
+			}
+		}
+
+		return consistent;
+	}
+}
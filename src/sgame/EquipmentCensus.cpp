@@ -0,0 +1,243 @@
+/*
+===========================================================================
+
+Unvanquished GPL Source Code
+Copyright (C) 2024 Unvanquished Developers
+
+This file is part of the Unvanquished GPL Source Code (Unvanquished Source Code).
+
+Unvanquished is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Unvanquished is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Unvanquished. If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+
+// EquipmentCensus.cpp
+// keeps per-team counts of player classes, weapons and upgrades up to date as
+// clients change, so that bots don't have to walk over all clients
+
+#include "common/Common.h"
+#include "sg_local.h"
+#include "CBSE.h"
+#include "Entities.h"
+
+static Log::Logger censusLogger("sgame.census");
+
+namespace EquipmentCensus {
+	/**
+	 * @brief What a client contributes to the counts.
+	 */
+	struct entry_t {
+		bool    counted;  // in use
+		team_t  team;
+		bool    bot;
+		bool    equipped; // spawned as a human, whose weapon and upgrades are counted
+		class_t cls;      // PCL_NONE unless alive
+		int     weapon;
+		int     items;
+	};
+
+	static entry_t entries[MAX_CLIENTS];
+
+	static int classes[NUM_TEAMS][PCL_NUM_CLASSES];
+	static int weapons[NUM_TEAMS][WP_NUM_WEAPONS];
+	static int upgrades[NUM_TEAMS][UP_NUM_UPGRADES];
+	static int bots[NUM_TEAMS];
+	static int botWeapons[NUM_TEAMS][WP_NUM_WEAPONS];
+
+	static entry_t Entry(const gentity_t *ent) {
+		entry_t entry = {};
+
+		if (!ent->inuse || !ent->client) {
+			return entry;
+		}
+
+		const playerState_t &ps = ent->client->ps;
+
+		entry.counted  = true;
+		entry.team     = static_cast<team_t>(ent->client->pers.team);
+		entry.bot      = ent->client->pers.isBot;
+		entry.equipped = ent->entity && ent->entity->Get<HumanClassComponent>();
+		entry.cls      = Entities::IsAlive(ent) ? static_cast<class_t>(ps.stats[STAT_CLASS]) : PCL_NONE;
+		entry.weapon   = ps.stats[STAT_WEAPON];
+		entry.items    = ps.stats[STAT_ITEMS];
+
+		return entry;
+	}
+
+	static bool SameEntry(const entry_t &a, const entry_t &b) {
+		return a.counted == b.counted && a.team == b.team && a.bot == b.bot && a.equipped == b.equipped &&
+		       a.cls == b.cls && a.weapon == b.weapon && a.items == b.items;
+	}
+
+	static void Account(const entry_t &entry, int sign) {
+		if (!entry.counted) return;
+
+		ASSERT(entry.team >= TEAM_NONE && entry.team < NUM_TEAMS);
+
+		if (entry.cls > PCL_NONE && entry.cls < PCL_NUM_CLASSES) {
+			classes[entry.team][entry.cls] += sign;
+		}
+
+		if (entry.bot) {
+			bots[entry.team] += sign;
+			if (entry.weapon > WP_NONE && entry.weapon < WP_NUM_WEAPONS) {
+				botWeapons[entry.team][entry.weapon] += sign;
+			}
+		}
+
+		if (entry.equipped) {
+			if (entry.weapon >= WP_NONE && entry.weapon < WP_NUM_WEAPONS) {
+				weapons[entry.team][entry.weapon] += sign;
+			}
+			for (int up = UP_NONE + 1; up < UP_NUM_UPGRADES; up++) {
+				if (entry.items & (1 << up)) upgrades[entry.team][up] += sign;
+			}
+		}
+	}
+
+	void Init() {
+		memset(entries, 0, sizeof(entries));
+		memset(classes, 0, sizeof(classes));
+		memset(weapons, 0, sizeof(weapons));
+		memset(upgrades, 0, sizeof(upgrades));
+		memset(bots, 0, sizeof(bots));
+		memset(botWeapons, 0, sizeof(botWeapons));
+	}
+
+	void Update(const gentity_t *ent) {
+		int clientNum = ent->num();
+		ASSERT(clientNum >= 0 && clientNum < MAX_CLIENTS);
+
+		entry_t entry = Entry(ent);
+		entry_t &old = entries[clientNum];
+
+		if (SameEntry(entry, old)) return;
+
+		Account(old, -1);
+		Account(entry, 1);
+		old = entry;
+	}
+
+	// The entry of a client to leave out of a team count, if it is counted there.
+	static const entry_t *Except(const gentity_t *except, team_t team) {
+		if (!except || !except->client) return nullptr;
+
+		const entry_t &entry = entries[except->num()];
+		return entry.counted && entry.team == team ? &entry : nullptr;
+	}
+
+	int CountClass(team_t team, class_t cls, const gentity_t *except) {
+		const entry_t *self = Except(except, team);
+		return classes[team][cls] - (self && self->cls == cls);
+	}
+
+	int CountWeapon(team_t team, weapon_t weapon, const gentity_t *except) {
+		const entry_t *self = Except(except, team);
+		return weapons[team][weapon] - (self && self->equipped && self->weapon == weapon);
+	}
+
+	int CountUpgrade(team_t team, upgrade_t upgrade, const gentity_t *except) {
+		const entry_t *self = Except(except, team);
+		return upgrades[team][upgrade] - (self && self->equipped && (self->items & (1 << upgrade)));
+	}
+
+	int CountBots(team_t team) {
+		return bots[team];
+	}
+
+	int CountBotsWithWeapon(team_t team, weapon_t weapon, const gentity_t *except) {
+		const entry_t *self = Except(except, team);
+		return botWeapons[team][weapon] - (self && self->bot && self->weapon == weapon);
+	}
+
+	/**
+	 * @brief Recounts all clients from scratch and compares the result with the census.
+	 * @return Whether the census is consistent.
+	 */
+	bool Verify() {
+		static int recountClasses[NUM_TEAMS][PCL_NUM_CLASSES];
+		static int recountWeapons[NUM_TEAMS][WP_NUM_WEAPONS];
+		static int recountUpgrades[NUM_TEAMS][UP_NUM_UPGRADES];
+		static int recountBotWeapons[NUM_TEAMS][WP_NUM_WEAPONS];
+		int recountBots[NUM_TEAMS] = {};
+		bool consistent = true;
+
+		memset(recountClasses, 0, sizeof(recountClasses));
+		memset(recountWeapons, 0, sizeof(recountWeapons));
+		memset(recountUpgrades, 0, sizeof(recountUpgrades));
+		memset(recountBotWeapons, 0, sizeof(recountBotWeapons));
+
+		for (int i = 0; i < level.maxclients; i++) {
+			entry_t entry = Entry(&g_entities[i]);
+
+			if (!SameEntry(entry, entries[i])) {
+				censusLogger.Warn("Census entry of client %d is out of date.", i);
+				consistent = false;
+			}
+
+			if (!entry.counted) continue;
+
+			if (entry.cls > PCL_NONE && entry.cls < PCL_NUM_CLASSES) recountClasses[entry.team][entry.cls]++;
+
+			if (entry.bot) {
+				recountBots[entry.team]++;
+				if (entry.weapon > WP_NONE && entry.weapon < WP_NUM_WEAPONS) {
+					recountBotWeapons[entry.team][entry.weapon]++;
+				}
+			}
+
+			if (entry.equipped) {
+				if (entry.weapon >= WP_NONE && entry.weapon < WP_NUM_WEAPONS) recountWeapons[entry.team][entry.weapon]++;
+				for (int up = UP_NONE + 1; up < UP_NUM_UPGRADES; up++) {
+					if (entry.items & (1 << up)) recountUpgrades[entry.team][up]++;
+				}
+			}
+		}
+
+		for (int team = TEAM_NONE; team < NUM_TEAMS; team++) {
+			if (recountBots[team] != bots[team]) {
+				censusLogger.Warn("Census has %d bots in team %d, should be %d.", bots[team], team, recountBots[team]);
+				consistent = false;
+			}
+
+			for (int cls = PCL_NONE + 1; cls < PCL_NUM_CLASSES; cls++) {
+				if (recountClasses[team][cls] != classes[team][cls]) {
+					censusLogger.Warn("Census of class %s in team %d is %d, should be %d.",
+					                  BG_Class(cls)->name, team, classes[team][cls], recountClasses[team][cls]);
+					consistent = false;
+				}
+			}
+
+			for (int weapon = WP_NONE; weapon < WP_NUM_WEAPONS; weapon++) {
+				if (recountWeapons[team][weapon] != weapons[team][weapon] ||
+				    recountBotWeapons[team][weapon] != botWeapons[team][weapon]) {
+					censusLogger.Warn("Census of weapon %d in team %d is %d (%d for bots), should be %d (%d).",
+					                  weapon, team, weapons[team][weapon], botWeapons[team][weapon],
+					                  recountWeapons[team][weapon], recountBotWeapons[team][weapon]);
+					consistent = false;
+				}
+			}
+
+			for (int up = UP_NONE + 1; up < UP_NUM_UPGRADES; up++) {
+				if (recountUpgrades[team][up] != upgrades[team][up]) {
+					censusLogger.Warn("Census of upgrade %s in team %d is %d, should be %d.",
+					                  BG_Upgrade(up)->name, team, upgrades[team][up], recountUpgrades[team][up]);
+					consistent = false;
+				}
+			}
+		}
+
+		return consistent;
+	}
+}
@@ -0,0 +1,82 @@
+/*
+===========================================================================
+
+Unvanquished GPL Source Code
+Copyright (C) 2024 Unvanquished Developers
+
+This file is part of the Unvanquished GPL Source Code (Unvanquished Source Code).
+
+Unvanquished is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Unvanquished is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Unvanquished. If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+
+#ifndef SGAME_SPATIAL_QUERIES_H_
+#define SGAME_SPATIAL_QUERIES_H_
+
+/*
+ * Variants of ForEntities that only visit entities close to a location.
+ *
+ * Candidates come from the world sectors, which are kept up to date whenever an
+ * entity is linked or unlinked, so unlinked entities are never visited. Entities
+ * are visited in order of their number, like ForEntities does.
+ */
+
+#include "CBSE.h"
+
+/**
+ * @brief Calls func for every linked entity with the given component whose bounding box
+ *        intersects the box.
+ */
+template <typename Component, typename FuncType>
+void ForEntitiesInBox(const glm::vec3& mins, const glm::vec3& maxs, FuncType func) {
+	int entityNums[MAX_GENTITIES];
+	int numEntities = trap_EntitiesInBox(GLM4READ(mins), GLM4READ(maxs), entityNums, MAX_GENTITIES);
+
+	std::sort(entityNums, entityNums + numEntities);
+
+	for (int i = 0; i < numEntities; i++) {
+		gentity_t *ent = &g_entities[entityNums[i]];
+
+		// A previous call may have freed the entity.
+		if (!ent->inuse || !ent->entity) continue;
+
+		Component* component = ent->entity->Get<Component>();
+
+		if (component) {
+			func(*ent->entity, *component);
+		}
+	}
+}
+
+/**
+ * @brief Calls func for every linked entity with the given component whose bounding box
+ *        comes within radius of origin.
+ * @note  This is a superset of the entities whose origin is within radius, callers that
+ *        care about the latter still need to check it.
+ */
+template <typename Component, typename FuncType>
+void ForEntitiesInRadius(const glm::vec3& origin, float radius, FuncType func) {
+	if (radius < 0.0f) return;
+
+	glm::vec3 extent(radius);
+
+	ForEntitiesInBox<Component>(origin - extent, origin + extent, [&](Entity& other, Component& component) {
+		if (G_DistanceToBBox(origin, other.oldEnt) > radius) return;
+
+		func(other, component);
+	});
+}
+
+#endif // SGAME_SPATIAL_QUERIES_H_
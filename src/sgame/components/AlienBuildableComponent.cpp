@@ -1,5 +1,6 @@
 #include "common/Common.h"
 #include "AlienBuildableComponent.h"
+#include "../SpatialQueries.h"
 #include "../Entities.h"
 #include <random>
 
@@ -29,7 +30,7 @@ void AlienBuildableComponent::Think(int /*timeDelta*/) {
 	float creepSize = (float)BG_Buildable((buildable_t)entity.oldEnt->s.modelindex)->creepSize;
 
 	// Slow close humans.
-	ForEntities<HumanClassComponent>([&] (Entity& other, HumanClassComponent&) {
+	ForEntitiesInRadius<HumanClassComponent>(VEC2GLM(entity.oldEnt->s.origin), creepSize, [&] (Entity& other, HumanClassComponent&) {
 		// TODO: Add LocationComponent.
 		if (G_Distance(entity.oldEnt, other.oldEnt) > creepSize) return;
 
@@ -12,6 +12,33 @@ BuildableComponent::BuildableComponent(Entity& entity, HealthComponent& r_Health
 
 	// TODO: Make power state a member variable.
 	entity.oldEnt->powered = true;
+
+	censusEntry = CensusEntry();
+	BuildableCensus::Add(entity.oldEnt, censusEntry);
+}
+
+BuildableComponent::~BuildableComponent() {
+	BuildableCensus::Remove(entity.oldEnt, censusEntry);
+}
+
+BuildableCensus::entry_t BuildableComponent::CensusEntry() {
+	BuildableCensus::state_t censusState;
+
+	if (!GetHealthComponent().Alive()) {
+		censusState = BuildableCensus::DEAD;
+	} else if (state == CONSTRUCTED) {
+		censusState = BuildableCensus::CONSTRUCTED;
+	} else {
+		censusState = BuildableCensus::CONSTRUCTING;
+	}
+
+	return { censusState, Powered() };
+}
+
+void BuildableComponent::UpdateCensus() {
+	BuildableCensus::entry_t newEntry = CensusEntry();
+	BuildableCensus::Update(entity.oldEnt, censusEntry, newEntry);
+	censusEntry = newEntry;
 }
 
 void BuildableComponent::HandlePrepareNetCode() {
@@ -53,6 +80,8 @@ void BuildableComponent::HandleDie(gentity_t* killer, meansOfDeath_t meansOfDeat
 
 	TeamComponent::team_t team = GetTeamComponent().Team();
 
+	UpdateCensus();
+
 	// TODO: Move animation code to BuildableComponent.
 	G_SetBuildableAnim(entity.oldEnt, Powered() ? BANIM_DESTROY : BANIM_DESTROY_UNPOWERED, true);
 	G_SetIdleBuildableAnim(entity.oldEnt, BANIM_DESTROYED);
@@ -100,6 +129,7 @@ void BuildableComponent::Think(int timeDelta) {
 				if (entity.oldEnt->creationTime + constructionTime < level.time) {
 					// Finish construction.
 					state = CONSTRUCTED;
+					UpdateCensus();
 
 					// Award momentum.
 					G_AddMomentumForBuilding(entity.oldEnt);
@@ -160,6 +190,8 @@ void BuildableComponent::SetPowerState(bool powered) {
 
 	entity.oldEnt->powered = powered;
 
+	UpdateCensus();
+
 	if (powered && !wasPowered) {
 		G_SetBuildableAnim(entity.oldEnt, BANIM_POWERUP, false);
 		G_SetIdleBuildableAnim(entity.oldEnt, BANIM_IDLE1);
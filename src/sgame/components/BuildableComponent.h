@@ -29,6 +29,8 @@ class BuildableComponent: public BuildableComponentBase {
 		 */
 		BuildableComponent(Entity& entity, HealthComponent& r_HealthComponent, ThinkingComponent& r_ThinkingComponent, TeamComponent& r_TeamComponent);
 
+		~BuildableComponent();
+
 		/**
 		 * @brief Handle the PrepareNetCode message.
 		 * @note This method is an interface for autogenerated code, do not modify its signature.
@@ -48,7 +50,12 @@ class BuildableComponent: public BuildableComponentBase {
 		void Think(int timeDelta);
 
 		lifecycle_t GetState() { return state; }
-		void SetState(lifecycle_t state) { this->state = state; }
+		void SetState(lifecycle_t state) { this->state = state; UpdateCensus(); }
+
+		/**
+		 * @return The buildable's current state as seen by the BuildableCensus.
+		 */
+		BuildableCensus::entry_t CensusEntry();
 
 		/**
 		 * @return Whether the buildable is currently marked for deconstruction.
@@ -96,8 +103,15 @@ class BuildableComponent: public BuildableComponentBase {
 		bool AnimationProtected() const { return (protectAnimationUntil > level.time); }
 
 	private:
+		/**
+		 * @brief Report a change of state or power to the BuildableCensus.
+		 */
+		void UpdateCensus();
+
 		lifecycle_t state;
 
+		BuildableCensus::entry_t censusEntry; /**< State last reported to the census. */
+
 		bool constructionHasFinished;
 
 		bool marked;
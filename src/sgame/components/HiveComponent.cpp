@@ -1,5 +1,6 @@
 #include "common/Common.h"
 #include "HiveComponent.h"
+#include "../SpatialQueries.h"
 #include "../Entities.h"
 #include "../CBSE.h"
 
@@ -54,7 +55,7 @@ void HiveComponent::Think(int /*timeDelta*/) {
 Entity* HiveComponent::FindTarget() {
 	Entity* target = nullptr;
 
-	ForEntities<HumanClassComponent>([&](Entity& candidate, HumanClassComponent&) {
+	ForEntitiesInRadius<HumanClassComponent>(VEC2GLM(entity.oldEnt->s.origin), HIVE_SENSE_RANGE, [&](Entity& candidate, HumanClassComponent&) {
 		// Check if target is valid and in sense range.
 		if (!TargetValid(candidate, true)) return;
 
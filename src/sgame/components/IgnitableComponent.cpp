@@ -24,6 +24,7 @@ along with Unvanquished Source Code.  If not, see <http://www.gnu.org/licenses/>
 
 #include "common/Common.h"
 #include "IgnitableComponent.h"
+#include "../SpatialQueries.h"
 
 static Log::Logger fireLogger("sgame.fire");
 
@@ -164,7 +165,7 @@ void IgnitableComponent::ConsiderStop(int timeDelta) {
 	float averagePostMinBurnTime = BASE_AVERAGE_BURN_TIME - MIN_BURN_TIME;
 
 	// Increase average burn time dynamically for burning entities in range.
-	ForEntities<IgnitableComponent>([&](Entity &other, IgnitableComponent &ignitable){
+	ForEntitiesInRadius<IgnitableComponent>(VEC2GLM(entity.oldEnt->s.origin), EXTRA_BURN_TIME_RADIUS, [&](Entity &other, IgnitableComponent &ignitable){
 		if (&other == &entity) return;
 		if (!ignitable.onFire) return;
 
@@ -204,7 +205,7 @@ void IgnitableComponent::ConsiderSpread(int /*timeDelta*/) {
 
 	fireLogger.Notice("Trying to spread.");
 
-	ForEntities<IgnitableComponent>([&](Entity &other, IgnitableComponent &ignitable){
+	ForEntitiesInRadius<IgnitableComponent>(VEC2GLM(entity.oldEnt->s.origin), SPREAD_RADIUS, [&](Entity &other, IgnitableComponent &ignitable){
 		if (&other == &entity) return;
 
 		// Don't re-ignite.
@@ -3,7 +3,13 @@
 
 MainBuildableComponent::MainBuildableComponent(Entity& entity, BuildableComponent& r_BuildableComponent)
 	: MainBuildableComponentBase(entity, r_BuildableComponent), lastAttackWarnLevel(-1)
-{}
+{
+	BuildableCensus::AddMainBuildable(entity.oldEnt);
+}
+
+MainBuildableComponent::~MainBuildableComponent() {
+	BuildableCensus::RemoveMainBuildable(entity.oldEnt);
+}
 
 void MainBuildableComponent::HandleDamage(float /*amount*/, gentity_t* /*source*/, Util::optional<glm::vec3> /*location*/,
                                           Util::optional<glm::vec3> /*direction*/, int /*flags*/, meansOfDeath_t meansOfDeath) {
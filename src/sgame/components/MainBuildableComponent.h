@@ -18,6 +18,8 @@ class MainBuildableComponent: public MainBuildableComponentBase {
 		 */
 		MainBuildableComponent(Entity& entity, BuildableComponent& r_BuildableComponent);
 
+		~MainBuildableComponent();
+
 		/**
 		 * @brief Handle the Damage message.
 		 * @param amount
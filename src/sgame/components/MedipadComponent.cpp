@@ -118,6 +118,7 @@ void MedipadComponent::Think(int timeDelta)
 			if (!BG_InventoryContainsUpgrade(UP_MEDKIT, player->client->ps.stats))
 			{
 				BG_AddUpgradeToInventory(UP_MEDKIT, player->client->ps.stats);
+				EquipmentCensus::Update(player);
 			}
 		}
 
@@ -167,6 +168,7 @@ void MedipadComponent::Think(int timeDelta)
 			if (!BG_InventoryContainsUpgrade(UP_MEDKIT, client->ps.stats))
 			{
 				BG_AddUpgradeToInventory(UP_MEDKIT, client->ps.stats);
+				EquipmentCensus::Update(newTarget);
 			}
 		}
 	}
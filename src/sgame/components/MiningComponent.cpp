@@ -1,5 +1,6 @@
 #include "common/Common.h"
 #include "MiningComponent.h"
+#include "../SpatialQueries.h"
 #include "../Entities.h"
 
 MiningComponent::MiningComponent(Entity& entity, ThinkingComponent& r_ThinkingComponent)
@@ -67,7 +68,8 @@ MiningComponent::Efficiencies MiningComponent::FindEfficiencies(
 {
 	MiningComponent::Efficiencies efficiencies{ 1.0f, 1.0f };
 
-	ForEntities<MiningComponent>([&](Entity& other, MiningComponent& miningComponent) {
+	// Miners further away don't interfere.
+	ForEntitiesInRadius<MiningComponent>(location, 2.0f * RGS_RANGE, [&](Entity& other, MiningComponent& miningComponent) {
 		if (&miningComponent == skip) return;
 
 		// Do not consider dead neighbours, even when predicting, as they can never become active.
@@ -95,7 +97,7 @@ void MiningComponent::CalculateEfficiency() {
 }
 
 void MiningComponent::InformNeighbors() {
-	ForEntities<MiningComponent>([&] (Entity& other, MiningComponent& miningComponent) {
+	ForEntitiesInRadius<MiningComponent>(VEC2GLM(entity.oldEnt->s.origin), RGS_RANGE * 2.0f, [&] (Entity& other, MiningComponent& miningComponent) {
 		if (&other == &entity) return;
 		if (G_Distance(entity.oldEnt, other.oldEnt) > RGS_RANGE * 2.0f) return;
 
@@ -1,5 +1,6 @@
 #include "common/Common.h"
 #include "ReactorComponent.h"
+#include "../SpatialQueries.h"
 
 const float ReactorComponent::ATTACK_RANGE  = 200.0f;
 const float ReactorComponent::ATTACK_DAMAGE = 25.0f;
@@ -19,7 +20,7 @@ void ReactorComponent::Think(int timeDelta) {
 	float baseDamage = ATTACK_DAMAGE * ((float)timeDelta / 1000.0f);
 
 	// Zap close enemies.
-	ForEntities<AlienClassComponent>([&](Entity& other, AlienClassComponent&) {
+	ForEntitiesInRadius<AlienClassComponent>(VEC2GLM(entity.oldEnt->s.origin), ATTACK_RANGE, [&](Entity& other, AlienClassComponent&) {
 		// Respect the no-target flag.
 		if (other.oldEnt->flags & FL_NOTARGET) return;
 
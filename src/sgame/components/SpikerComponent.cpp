@@ -1,5 +1,6 @@
 #include "common/Common.h"
 #include "SpikerComponent.h"
+#include "../SpatialQueries.h"
 
 #include <glm/geometric.hpp>
 
@@ -70,7 +71,7 @@ void SpikerComponent::Think(int /*timeDelta*/) {
 	bool  sensing = false;
 
 	// Calculate expected damage to decide on the best moment to shoot.
-	ForEntities<HealthComponent>([&](Entity& other, HealthComponent& healthComponent) {
+	ForEntitiesInRadius<HealthComponent>(VEC2GLM(entity.oldEnt->s.origin), SPIKE_RANGE, [&](Entity& other, HealthComponent& healthComponent) {
 		if (G_Team(other.oldEnt) == TEAM_NONE)                            return;
 		if (G_OnSameTeam(entity.oldEnt, other.oldEnt))                    return;
 		if ((other.oldEnt->flags & FL_NOTARGET))                          return;
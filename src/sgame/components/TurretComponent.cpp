@@ -1,5 +1,6 @@
 #include "common/Common.h"
 #include "TurretComponent.h"
+#include "../SpatialQueries.h"
 #include <glm/gtx/norm.hpp>
 #include <glm/gtx/io.hpp>
 #include "../Entities.h"
@@ -63,7 +64,7 @@ Entity* TurretComponent::FindEntityTarget(std::function<bool(Entity&, Entity&)>
 
 	// Search best target.
 	// TODO: Iterate over all valid targets, do not assume they have to be clients.
-	ForEntities<ClientComponent>([&](Entity& candidate, ClientComponent&) {
+	ForEntitiesInRadius<ClientComponent>(VEC2GLM(entity.oldEnt->s.origin), range, [&](Entity& candidate, ClientComponent&) {
 		if (TargetValid(candidate, true)) {
 			if (!target || CompareTargets(candidate, *target->entity)) {
 				target = candidate.oldEnt;
@@ -40,6 +40,8 @@ Maryland 20850 USA.
 #include "shared/bg_public.h"
 #include "shared/lua/LuaLib.h"
 #include "shared/lua/Utils.h"
+#include "shared/lua/register_lua_extensions.h"
+#include "shared/Timing.h"
 #include "sgame/sg_local.h"
 
 using Shared::Lua::LuaLib;
@@ -48,6 +50,77 @@ namespace Lua {
 namespace {
 lua_State* L = nullptr;
 
+Cvar::Range<Cvar::Cvar<int>> g_lua_timeBudget(
+	"g_lua_timeBudget", "microseconds per frame Lua may run before scripts are aborted, 0 for no limit",
+	Cvar::NONE, 50000, 0, 10000000);
+Cvar::Range<Cvar::Cvar<int>> g_lua_instructionBudget(
+	"g_lua_instructionBudget", "Lua instructions per frame before scripts are aborted, 0 for no limit",
+	Cvar::NONE, 0, 0, INT_MAX);
+
+// How often the watchdog hook checks the budget.
+constexpr int HOOK_INSTRUCTIONS = 1000;
+
+// What Lua used in the current frame. Budgets aren't enforced while the level
+// is spawning, so that loading scripts may take as long as they need.
+struct
+{
+	int depth; // of nested budgeted calls
+	Timing::TimePoint start; // of the outermost budgeted call
+	int spent; // microseconds, not counting the running call
+	int instructions;
+	bool exceeded;
+	bool benchmarking;
+} budget;
+
+struct
+{
+	int frames;
+	int64_t time;
+	int maxTime;
+	int64_t instructions;
+	int aborts;
+} stats;
+
+// Counts the time Lua runs towards the frame budget.
+class BudgetedCall
+{
+   public:
+	BudgetedCall()
+	{
+		if ( budget.depth++ == 0 ) budget.start = Timing::Now();
+	}
+
+	~BudgetedCall()
+	{
+		if ( --budget.depth == 0 ) budget.spent += Timing::Elapsed( budget.start );
+	}
+};
+
+void WatchdogHook( lua_State* L, lua_Debug* ar )
+{
+	budget.instructions += HOOK_INSTRUCTIONS;
+
+	if ( level.spawning || budget.benchmarking ) return;
+
+	int time = budget.spent + ( budget.depth ? Timing::Elapsed( budget.start ) : 0 );
+	bool overTime = g_lua_timeBudget.Get() && time > g_lua_timeBudget.Get();
+	bool overInstructions = g_lua_instructionBudget.Get() && budget.instructions > g_lua_instructionBudget.Get();
+
+	if ( !overTime && !overInstructions ) return;
+
+	// Report once per frame, later scripts are aborted silently.
+	if ( !budget.exceeded )
+	{
+		lua_getinfo( L, "Sl", ar );
+		Log::Warn( "Lua exceeded its frame budget (%d us, %d instructions) at %s:%d",
+		           time, budget.instructions, ar->short_src, ar->currentline );
+		budget.exceeded = true;
+	}
+
+	stats.aborts++;
+	luaL_error( L, "frame budget exceeded" );
+}
+
 bool LoadCode( Str::StringRef code, Str::StringRef location )
 {
 	if ( luaL_loadbuffer( L, code.c_str(), code.size(), location.c_str() ) != 0 )
@@ -60,6 +133,7 @@ bool LoadCode( Str::StringRef code, Str::StringRef location )
 
 bool RunCode()
 {
+	BudgetedCall call;
 	if ( lua_pcall( L, 0, 0, 0 ) != 0 )
 	{
 		Shared::Lua::Report( L, "error executing Lua code:" );
@@ -183,10 +257,12 @@ void Initialize()
 	luaL_openlibs( L );
 	OverrideGlobalLuaFunctions();
 	BG_InitializeLuaConstants( L );
+	lua_sethook( L, WatchdogHook, LUA_MASKCOUNT, HOOK_INSTRUCTIONS );
 }
 
 void Shutdown()
 {
+	Shared::Lua::ClearTimers();
 	lua_close( L );
 	L = nullptr;
 }
@@ -196,6 +272,22 @@ lua_State* State()
 	return L;
 }
 
+void Frame( int time )
+{
+	// account for the previous frame, including commands run since then
+	stats.frames++;
+	stats.time += budget.spent;
+	stats.maxTime = std::max( stats.maxTime, budget.spent );
+	stats.instructions += budget.instructions;
+
+	budget.spent = 0;
+	budget.instructions = 0;
+	budget.exceeded = false;
+
+	BudgetedCall call;
+	Shared::Lua::UpdateTimers( time );
+}
+
 class LuaCommand : Cmd::StaticCmd
 {
    public:
@@ -237,4 +329,107 @@ class LuaCommand : Cmd::StaticCmd
 
 static LuaCommand luaCommand;
 
+class LuaStatsCmd : public Cmd::StaticCmd
+{
+   public:
+	LuaStatsCmd() : StaticCmd( "luaStats", 0, "print how much time server side Lua used: luaStats [reset]" ) {}
+
+	void Run( const Cmd::Args& args ) const override
+	{
+		if ( args.Argc() == 2 && args.Argv( 1 ) == "reset" )
+		{
+			stats = {};
+			return;
+		}
+
+		Print( "%d frames, %d microseconds in Lua on average, %d at most",
+		       stats.frames, stats.frames ? static_cast<int>( stats.time / stats.frames ) : 0, stats.maxTime );
+		Print( "%d instructions on average, %d scripts aborted by the watchdog",
+		       stats.frames ? static_cast<int>( stats.instructions / stats.frames ) : 0, stats.aborts );
+		Print( "%zu timers pending", Shared::Lua::PendingTimers() );
+	}
+};
+
+static LuaStatsCmd luaStatsCmdRegistration;
+
+class BenchmarkLuaCmd : public Cmd::StaticCmd
+{
+   public:
+	BenchmarkLuaCmd() : StaticCmd( "benchmarkLua", 0, "time common operations of server side Lua: benchmarkLua [iterations]" ) {}
+
+	void Run( const Cmd::Args& args ) const override
+	{
+		int iterations = 100000;
+		if ( args.Argc() > 1 )
+		{
+			iterations = std::max( 1, atoi( args.Argv( 1 ).c_str() ) );
+		}
+
+		if ( !L )
+		{
+			Print( "Lua is not initialized" );
+			return;
+		}
+
+		static const struct
+		{
+			const char* name;
+			const char* code;
+		} cases[] = {
+			{ "arithmetic", "local n = ... local x = 0 for i = 1, n do x = x + i % 7 end" },
+			{ "table writes", "local n = ... local t = {} for i = 1, n do t[ i % 64 + 1 ] = i end" },
+			{ "buildable lookup", "local n = ... local b = Unv.buildables for i = 1, n do local _ = b.telenode end" },
+			{ "buildable attribute", "local n = ... local b = Unv.buildables.telenode for i = 1, n do local _ = b.build_points end" },
+			{ "weapon iteration", "local n = ... for i = 1, n / 16 do for k, w in pairs( Unv.weapons ) do end end" },
+			{ "timer add", "local n = ... local f = function() end for i = 1, n do Timer.add( 0, f ) end" },
+		};
+
+		budget.benchmarking = true;
+
+		for ( const auto& c : cases )
+		{
+			if ( luaL_loadbuffer( L, c.code, strlen( c.code ), c.name ) != 0 )
+			{
+				Shared::Lua::Report( L, "error loading Lua benchmark:" );
+				continue;
+			}
+			lua_pushinteger( L, iterations );
+
+			auto start = Timing::Now();
+			if ( lua_pcall( L, 1, 0, 0 ) != 0 )
+			{
+				Shared::Lua::Report( L, "error running Lua benchmark:" );
+				continue;
+			}
+			Print( "%s: %d us", c.name, Timing::Elapsed( start ) );
+		}
+
+		// fire the timers added above, they are all due
+		auto start = Timing::Now();
+		Shared::Lua::UpdateTimers( level.time );
+		Print( "timer run: %d us", Timing::Elapsed( start ) );
+
+		// without the watchdog hook, to see what it costs
+		lua_sethook( L, nullptr, 0, 0 );
+		if ( luaL_loadbuffer( L, cases[ 0 ].code, strlen( cases[ 0 ].code ), cases[ 0 ].name ) == 0 )
+		{
+			lua_pushinteger( L, iterations );
+			start = Timing::Now();
+			if ( lua_pcall( L, 1, 0, 0 ) == 0 )
+			{
+				Print( "%s without watchdog: %d us", cases[ 0 ].name, Timing::Elapsed( start ) );
+			}
+			else
+			{
+				Shared::Lua::Report( L, "error running Lua benchmark:" );
+			}
+		}
+		lua_sethook( L, WatchdogHook, LUA_MASKCOUNT, HOOK_INSTRUCTIONS );
+
+		budget.benchmarking = false;
+	}
+};
+
+static BenchmarkLuaCmd benchmarkLuaCmdRegistration;
+
 }  // namespace Lua
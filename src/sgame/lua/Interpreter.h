@@ -46,6 +46,9 @@ void Shutdown();
 
 lua_State* State();
 
+// Runs the timers that are due and accounts for the time Lua used.
+void Frame(int time);
+
 bool ExecScript(Str::StringRef scriptPath);
 
 bool ExecCode(Str::StringRef code, Str::StringRef location);
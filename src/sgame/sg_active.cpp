@@ -799,6 +799,7 @@ static void G_ReplenishHumanHealth( gentity_t *self )
 			client->medKitIncrementTime = level.time + ( MEDKIT_STARTUP_TIME / MEDKIT_STARTUP_SPEED );
 
 			G_AddEvent( self, EV_MEDKIT_USED, 0 );
+			EquipmentCensus::Update( self );
 		}
 	}
 
@@ -2009,6 +2010,7 @@ static void ClientThink_real( gentity_t *self )
 		BG_RemoveUpgradeFromInventory( UP_GRENADE, client->ps.stats );
 
 		G_FireUpgrade( self, UP_GRENADE );
+		EquipmentCensus::Update( self );
 	}
 
 	// Throw human firebomb
@@ -2020,6 +2022,7 @@ static void ClientThink_real( gentity_t *self )
 		BG_RemoveUpgradeFromInventory( UP_FIREBOMB, client->ps.stats );
 
 		G_FireUpgrade( self, UP_FIREBOMB );
+		EquipmentCensus::Update( self );
 	}
 
 	// set speed
@@ -2274,6 +2277,22 @@ static void ClientThink_real( gentity_t *self )
 	}
 }
 
+/*
+==================
+G_GetUsercmd
+
+The last command of the client, which comes from the recording when replaying
+a game
+==================
+*/
+void G_GetUsercmd( int clientNum, usercmd_t *cmd )
+{
+	if ( !Replay::Usercmd( clientNum, cmd ) )
+	{
+		trap_GetUsercmd( clientNum, cmd );
+	}
+}
+
 /*
 ==================
 ClientThink
@@ -2286,7 +2305,7 @@ void ClientThink( int clientNum )
 	gentity_t *ent;
 
 	ent = g_entities + clientNum;
-	trap_GetUsercmd( clientNum, &ent->client->pers.cmd );
+	G_GetUsercmd( clientNum, &ent->client->pers.cmd );
 	if ( ent->client->pers.cmd.flags & UF_TYPING && !ent->client->pers.isBot && Entities::IsAlive( ent ) )
 	{
 		ent->client->ps.eFlags |= EF_TYPING;
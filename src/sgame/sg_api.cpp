@@ -59,6 +59,7 @@ void VM::VMInit() {
 }
 
 void VM::VMHandleSyscall(uint32_t id, Util::Reader reader) {
+	Replay::EngineCall engineCall;
 
 	int major = id >> 16;
 	int minor = id & 0xffff;
@@ -88,6 +89,12 @@ void VM::VMHandleSyscall(uint32_t id, Util::Reader reader) {
 
 		case GAME_CLIENT_CONNECT:
 			IPC::HandleMsg<GameClientConnectMsg>(VM::rootChannel, std::move(reader), [](int clientNum, bool firstTime, int isBot, bool& denied, std::string& reason) {
+				if (Replay::Ignores()) {
+					denied = true;
+					reason = "the server is replaying a recorded game";
+					return;
+				}
+				Replay::RecordConnect(clientNum, firstTime, isBot);
 				const char* deniedStr = isBot ? ClientBotConnect(clientNum, firstTime) : ClientConnect(clientNum, firstTime);
 				denied = deniedStr != nullptr;
 				if (denied)
@@ -97,30 +104,45 @@ void VM::VMHandleSyscall(uint32_t id, Util::Reader reader) {
 
 		case GAME_CLIENT_THINK:
 			IPC::HandleMsg<GameClientThinkMsg>(VM::rootChannel, std::move(reader), [](int clientNum) {
+				if (Replay::Ignores())
+					return;
+				Replay::RecordUsercmd(clientNum);
 				ClientThink(clientNum);
 			});
 			break;
 
 		case GAME_CLIENT_USERINFO_CHANGED:
 			IPC::HandleMsg<GameClientUserinfoChangedMsg>(VM::rootChannel, std::move(reader), [](int clientNum) {
+				if (Replay::Ignores())
+					return;
+				Replay::RecordUserinfoChanged(clientNum);
 				ClientUserinfoChanged(clientNum, false);
 			});
 			break;
 
 		case GAME_CLIENT_DISCONNECT:
 			IPC::HandleMsg<GameClientDisconnectMsg>(VM::rootChannel, std::move(reader), [](int clientNum) {
+				if (Replay::Ignores())
+					return;
+				Replay::RecordDisconnect(clientNum);
 				ClientDisconnect(clientNum);
 			});
 			break;
 
 		case GAME_CLIENT_BEGIN:
 			IPC::HandleMsg<GameClientBeginMsg>(VM::rootChannel, std::move(reader), [](int clientNum) {
+				if (Replay::Ignores())
+					return;
+				Replay::RecordBegin(clientNum);
 				ClientBegin(clientNum);
 			});
 			break;
 
 		case GAME_CLIENT_COMMAND:
 			IPC::HandleMsg<GameClientCommandMsg>(VM::rootChannel, std::move(reader), [](int clientNum, std::string command) {
+				if (Replay::Ignores())
+					return;
+				Replay::RecordClientCommand(clientNum, command);
 				Cmd::PushArgs(command);
 				ClientCommand(clientNum);
 				Cmd::PopArgs();
@@ -129,6 +151,11 @@ void VM::VMHandleSyscall(uint32_t id, Util::Reader reader) {
 
 		case GAME_RUN_FRAME:
 			IPC::HandleMsg<GameRunFrameMsg>(VM::rootChannel, std::move(reader), [](int levelTime) {
+				if (Replay::Ignores()) {
+					Replay::RunFrame();
+					return;
+				}
+				Replay::RecordFrame(levelTime);
 				G_RunFrame(levelTime);
 			});
 			break;
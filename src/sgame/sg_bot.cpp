@@ -27,6 +27,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "sg_bot_parse.h"
 #include "sg_bot_util.h"
 #include "Entities.h"
+#include "shared/Timing.h"
 
 Cvar::Modified<Cvar::Cvar<int>> g_bot_defaultFill("g_bot_defaultFill", "fills both teams with that number of bots at start of game", Cvar::NONE, 0);
 static Cvar::Range<Cvar::Cvar<int>> generateNeededMesh(
@@ -397,84 +398,245 @@ Bot Thinks
 
 static Cvar::Cvar<float> g_bot_jetpackTimeout("g_bot_jetpackTimeout", "time in milliseconds until a jetpack flight is aborted", Cvar::NONE, 10000);
 
-void G_BotThink( gentity_t *self )
-{
-	char buf[MAX_STRING_CHARS];
-	usercmd_t *botCmdBuffer;
+/*
+=======================
+Bot think scheduling
+
+With g_bot_thinkBudget set, perception and the behavior tree only run for as
+many bots per frame as fit in the budget. The other bots keep doing what their
+last think decided: their path is updated, and they keep steering along it and
+aiming at their enemy, but they don't pick new goals or actions until their
+turn comes. Bots that waited the longest go first, and bots that are fighting or
+close to a human player count their wait as longer.
+=======================
+*/
 
-	self->botMind->cmdBuffer = self->client->pers.cmd;
-	botCmdBuffer = &self->botMind->cmdBuffer;
+static Cvar::Range<Cvar::Cvar<int>> g_bot_thinkBudget(
+	"g_bot_thinkBudget", "microseconds per frame all bots may spend thinking, 0 for no limit",
+	Cvar::NONE, 0, 0, 1000000);
+static Cvar::Range<Cvar::Cvar<int>> g_bot_maxThinkInterval(
+	"g_bot_maxThinkInterval", "milliseconds after which a bot thinks even if g_bot_thinkBudget is exhausted",
+	Cvar::NONE, 250, 0, 5000);
 
-	//reset command buffer
-	usercmdClearButtons( botCmdBuffer->buttons );
+static struct
+{
+	int   frameTime = -1;         // level.time the schedule was made for
+	bool  thinks[ MAX_CLIENTS ];  // whether the bot runs a full think this frame
+	float cost[ MAX_CLIENTS ];    // running average of a full think, in microseconds
+	int   spent;                  // microseconds spent on full thinks this frame
+	bool  overrun;                // whether spent went over the budget this frame
+} botSchedule;
+
+static struct
+{
+	int     frames;
+	int     thinks;
+	int     skipped;
+	int     forced;       // thinks scheduled over budget because the bot waited too long
+	int     overruns;     // frames where thinking took longer than the budget
+	int     maxLatency;   // longest time between two thinks of a bot, in milliseconds
+	int64_t totalLatency;
+	int     latencySamples;
+} botScheduleStats;
+
+static bool BotNearHumanPlayer( gentity_t *self )
+{
+	static const float range = 1500.0f;
 
-	// for nudges, e.g. spawn blocking
-	glm::vec3 nudge = { 0, 0, 0 };
-	if ( botCmdBuffer->doubleTap != dtType_t::DT_NONE )
+	for ( int i = 0; i < level.maxclients; i++ )
 	{
-		nudge = { botCmdBuffer->forwardmove, botCmdBuffer->rightmove, botCmdBuffer->upmove };
+		gentity_t *ent = &g_entities[ i ];
+
+		if ( !ent->client || ent->client->pers.connected != CON_CONNECTED || ent->client->pers.isBot )
+		{
+			continue;
+		}
+
+		if ( !G_IsPlayableTeam( G_Team( ent ) ) || !Entities::IsAlive( ent ) )
+		{
+			continue;
+		}
+
+		if ( DistanceSquared( self->s.origin, ent->s.origin ) < Square( range ) )
+		{
+			return true;
+		}
 	}
 
-	botCmdBuffer->forwardmove = 0;
-	botCmdBuffer->rightmove = 0;
-	botCmdBuffer->upmove = 0;
-	botCmdBuffer->doubleTap = dtType_t::DT_NONE;
-	botCmdBuffer->flags = 0;
+	return false;
+}
 
-	//acknowledge recieved server commands
-	//MUST be done
-	while ( trap_BotGetServerCommand( self->num(), buf, sizeof( buf ) ) );
+static void BotScheduleThinks()
+{
+	struct candidate_t
+	{
+		int  clientNum;
+		int  priority;
+		bool forced;
+	};
 
-	BotSearchForEnemy( self );
+	BoundedVector<candidate_t, MAX_CLIENTS> candidates;
+	int budget = g_bot_thinkBudget.Get();
+	int maxInterval = g_bot_maxThinkInterval.Get();
 
-	// Populate transient caches
-	BotFindClosestBuildings( self );
-	BotFindDamagedFriendlyStructure( self );
-	BotCalculateStuckTime( self );
+	botSchedule.frameTime = level.time;
+	botSchedule.spent = 0;
+	botSchedule.overrun = false;
+	botScheduleStats.frames++;
 
-	//infinite funds cvar
-	if ( g_bot_infiniteFunds.Get() )
+	for ( int i = 0; i < level.maxclients; i++ )
 	{
-		G_AddCreditToClient( self->client, HUMAN_MAX_CREDITS, true );
+		gentity_t *ent = &g_entities[ i ];
+
+		botSchedule.thinks[ i ] = false;
+
+		if ( !ent->client || !ent->client->pers.isBot || !ent->botMind || !G_IsPlayableTeam( G_Team( ent ) ) )
+		{
+			continue;
+		}
+
+		if ( !budget )
+		{
+			botSchedule.thinks[ i ] = true;
+			continue;
+		}
+
+		int waited = level.time - ent->botMind->lastThink;
+		int priority = waited;
+
+		if ( level.time - ent->botMind->enemyLastSeen < 1000 )
+		{
+			priority *= 4;
+		}
+		else if ( BotNearHumanPlayer( ent ) )
+		{
+			priority *= 2;
+		}
+
+		candidates.append( { i, priority, waited >= maxInterval } );
 	}
 
-	//reset the user specified client number if the client disconnected
-	if ( self->botMind->userSpecifiedClientNum )
+	std::sort( candidates.begin(), candidates.end(), []( const candidate_t &a, const candidate_t &b ) {
+		return a.priority > b.priority;
+	} );
+
+	// always let at least one bot think so that an oversized think can't
+	// stall everyone
+	float planned = 0;
+	for ( const candidate_t &candidate : candidates )
 	{
-		int userSpecifiedClientNum = *self->botMind->userSpecifiedClientNum;
-		gentity_t *ent = &g_entities[ userSpecifiedClientNum ];
-		if ( !ent->client || ent->client->pers.connected == CON_DISCONNECTED )
+		float cost = botSchedule.cost[ candidate.clientNum ];
+
+		if ( planned + cost <= budget || planned == 0 )
 		{
-			self->botMind->userSpecifiedClientNum = Util::nullopt;
+			botSchedule.thinks[ candidate.clientNum ] = true;
+			planned += cost;
+		}
+		else if ( candidate.forced )
+		{
+			botSchedule.thinks[ candidate.clientNum ] = true;
+			planned += cost;
+			botScheduleStats.forced++;
 		}
 	}
 
-	self->botMind->blackboardTransient = 0;
+	// when enough bots think, the read-only part of perception is done for all
+	// of them at once
+	BoundedVector<gentity_t *, MAX_CLIENTS> thinkingBots;
+	for ( int i = 0; i < level.maxclients; i++ )
+	{
+		if ( botSchedule.thinks[ i ] )
+		{
+			thinkingBots.append( &g_entities[ i ] );
+		}
+	}
 
-	if ( !self->botMind->behaviorTree )
+	auto start = Timing::Now();
+	BotPerceiveAll( thinkingBots.begin(), static_cast<int>( thinkingBots.size() ) );
+	botSchedule.spent += Timing::Elapsed( start );
+}
+
+static bool BotScheduledToThink( gentity_t *self )
+{
+	if ( botSchedule.frameTime != level.time )
 	{
-		Log::Warn( "NULL behavior tree" );
-		return;
+		BotScheduleThinks();
 	}
 
-	// always update the path corridor
-	if ( self->botMind->goal.isValid() )
+	if ( !botSchedule.thinks[ self->num() ] )
 	{
-		botRouteTarget_t routeTarget;
-		BotTargetToRouteTarget( self, self->botMind->goal, &routeTarget );
-		G_BotUpdatePath( self->s.number, &routeTarget, &self->botMind->m_nav );
+		botScheduleStats.skipped++;
+		return false;
 	}
 
-	self->botMind->willSprint( false ); //let the BT decide that
-	AINodeStatus_t status =
-		self->botMind->behaviorTree->run( self, ( AIGenericNode_t * ) self->botMind->behaviorTree );
-	self->botMind->lastThink = level.time;
+	int lastThink = self->botMind->lastThink;
 
-	if ( traceClient.Get() == self->num() )
+	// the first think after spawning has no latency to speak of
+	if ( lastThink > 0 )
 	{
-		ShowRunningNode( self, status );
+		int latency = level.time - lastThink;
+		botScheduleStats.maxLatency = std::max( botScheduleStats.maxLatency, latency );
+		botScheduleStats.totalLatency += latency;
+		botScheduleStats.latencySamples++;
 	}
 
+	botScheduleStats.thinks++;
+	return true;
+}
+
+static void BotRecordThinkTime( gentity_t *self, Timing::TimePoint start )
+{
+	int us = Timing::Elapsed( start );
+	float &cost = botSchedule.cost[ self->num() ];
+	int budget = g_bot_thinkBudget.Get();
+
+	cost = cost ? 0.75f * cost + 0.25f * us : us;
+	botSchedule.spent += us;
+
+	if ( budget && botSchedule.spent > budget && !botSchedule.overrun )
+	{
+		botSchedule.overrun = true;
+		botScheduleStats.overruns++;
+	}
+}
+
+class BotThinkStatsCmd : public Cmd::StaticCmd
+{
+public:
+	BotThinkStatsCmd() : StaticCmd( "botThinkStats", 0, "print statistics about bot think scheduling" ) {}
+
+	void Run( const Cmd::Args& args ) const override
+	{
+		if ( args.Argc() > 1 && args.Argv( 1 ) == "reset" )
+		{
+			botScheduleStats = {};
+			return;
+		}
+
+		int frames = std::max( botScheduleStats.frames, 1 );
+		int samples = std::max( botScheduleStats.latencySamples, 1 );
+
+		Print( "budget: %d microseconds per frame, %d ms max interval", g_bot_thinkBudget.Get(), g_bot_maxThinkInterval.Get() );
+		Print( "frames: %d (%d over budget)", botScheduleStats.frames, botScheduleStats.overruns );
+		Print( "thinks: %d (%.2f per frame, %d forced), skipped: %d",
+		       botScheduleStats.thinks, botScheduleStats.thinks / float( frames ),
+		       botScheduleStats.forced, botScheduleStats.skipped );
+		Print( "latency: %.1f ms average, %d ms max",
+		       botScheduleStats.totalLatency / float( samples ), botScheduleStats.maxLatency );
+	}
+};
+static BotThinkStatsCmd botThinkStatsRegistration;
+
+/*
+=======================
+BotFinishCommand
+
+Per-frame reflexes applied on top of the bot's command, whether it was
+decided this frame or replayed from the last think.
+=======================
+*/
+static void BotFinishCommand( gentity_t *self, const glm::vec3 &nudge )
+{
 	// if we have a jetpack and are falling too fast: fire it
 	if ( G_Team( self ) == TEAM_HUMANS && BG_InventoryContainsUpgrade( UP_JETPACK, self->client->ps.stats ) )
 	{
@@ -516,6 +678,124 @@ void G_BotThink( gentity_t *self )
 			self->client->pers.cmd );
 }
 
+void G_BotThink( gentity_t *self )
+{
+	char buf[MAX_STRING_CHARS];
+	usercmd_t *botCmdBuffer;
+
+	// for nudges, e.g. spawn blocking
+	const usercmd_t &lastCmd = self->client->pers.cmd;
+	glm::vec3 nudge = { 0, 0, 0 };
+	if ( lastCmd.doubleTap != dtType_t::DT_NONE )
+	{
+		nudge = { lastCmd.forwardmove, lastCmd.rightmove, lastCmd.upmove };
+	}
+
+	if ( !BotScheduledToThink( self ) )
+	{
+		//acknowledge recieved server commands
+		//MUST be done
+		while ( trap_BotGetServerCommand( self->num(), buf, sizeof( buf ) ) );
+
+		// keep doing whatever was decided on the last think, toward where
+		// the goal is now
+		self->botMind->cmdBuffer.serverTime = lastCmd.serverTime;
+		self->botMind->cmdBuffer.doubleTap = dtType_t::DT_NONE;
+
+		if ( self->botMind->goal.isValid() )
+		{
+			botRouteTarget_t routeTarget;
+			BotTargetToRouteTarget( self, self->botMind->goal, &routeTarget );
+			G_BotUpdatePath( self->s.number, &routeTarget, &self->botMind->m_nav );
+
+			if ( self->botMind->movesToGoal )
+			{
+				BotMoveToGoal( self );
+			}
+
+			if ( self->botMind->aimsAtEnemy && self->botMind->goal.targetsValidEntity() )
+			{
+				BotAimAtEnemy( self );
+			}
+		}
+
+		BotFinishCommand( self, nudge );
+		return;
+	}
+
+	auto thinkStart = Timing::Now();
+
+	self->botMind->cmdBuffer = self->client->pers.cmd;
+	botCmdBuffer = &self->botMind->cmdBuffer;
+
+	//reset command buffer
+	usercmdClearButtons( botCmdBuffer->buttons );
+
+	botCmdBuffer->forwardmove = 0;
+	botCmdBuffer->rightmove = 0;
+	botCmdBuffer->upmove = 0;
+	botCmdBuffer->doubleTap = dtType_t::DT_NONE;
+	botCmdBuffer->flags = 0;
+
+	//acknowledge recieved server commands
+	//MUST be done
+	while ( trap_BotGetServerCommand( self->num(), buf, sizeof( buf ) ) );
+
+	// Populate transient caches, unless already done for all bots this frame
+	BotPerceive( self );
+	BotSearchForEnemy( self );
+	BotCalculateStuckTime( self );
+
+	//infinite funds cvar
+	if ( g_bot_infiniteFunds.Get() )
+	{
+		G_AddCreditToClient( self->client, HUMAN_MAX_CREDITS, true );
+	}
+
+	//reset the user specified client number if the client disconnected
+	if ( self->botMind->userSpecifiedClientNum )
+	{
+		int userSpecifiedClientNum = *self->botMind->userSpecifiedClientNum;
+		gentity_t *ent = &g_entities[ userSpecifiedClientNum ];
+		if ( !ent->client || ent->client->pers.connected == CON_DISCONNECTED )
+		{
+			self->botMind->userSpecifiedClientNum = Util::nullopt;
+		}
+	}
+
+	self->botMind->blackboardTransient = 0;
+
+	if ( !self->botMind->behaviorTree )
+	{
+		Log::Warn( "NULL behavior tree" );
+		return;
+	}
+
+	// always update the path corridor
+	if ( self->botMind->goal.isValid() )
+	{
+		botRouteTarget_t routeTarget;
+		BotTargetToRouteTarget( self, self->botMind->goal, &routeTarget );
+		G_BotUpdatePath( self->s.number, &routeTarget, &self->botMind->m_nav );
+	}
+
+	self->botMind->willSprint( false ); //let the BT decide that
+	self->botMind->movesToGoal = false;
+	self->botMind->aimsAtEnemy = false;
+	AINodeStatus_t status =
+		self->botMind->behaviorTree->run( self, ( AIGenericNode_t * ) self->botMind->behaviorTree );
+	self->botMind->lastThink = level.time;
+
+	if ( traceClient.Get() == self->num() )
+	{
+		ShowRunningNode( self, status );
+	}
+
+	BotRecordThinkTime( self, thinkStart );
+
+	BotFinishCommand( self, nudge );
+}
+
 void G_BotSpectatorThink( gentity_t *self )
 {
 	char buf[MAX_STRING_CHARS];
@@ -564,6 +844,7 @@ void G_BotSpectatorThink( gentity_t *self )
 	self->botMind->stuckPosition = {1.0e12f, 1.0e12f, 1.0e12f};
 	self->botMind->futureAimTime = 0;
 	self->botMind->futureAimTimeInterval = 0;
+	self->botMind->lastEnemyAim = level.time;
 	BotResetEnemyQueue( &self->botMind->enemyQueue );
 	self->botMind->enemyLastSeen = -999999;
 	self->botMind->exhausted = false;
@@ -800,6 +1081,8 @@ void G_Bot_ResetBehaviorState( botMemory_t &memory )
 	memory.lastNavconTime = 0;
 	memory.lastNavconDistance = 0;
 	memory.hasOffmeshGoal = false;
+	memory.movesToGoal = false;
+	memory.aimsAtEnemy = false;
 }
 
 // assumes bot is a bot, otherwise will crash.
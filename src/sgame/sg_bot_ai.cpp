@@ -1312,11 +1312,11 @@ buildable_t BotChooseBuildableToBuild( gentity_t *self )
 	buildable_t toBuild = BA_NONE;
 	if ( G_Team( self ) == TEAM_HUMANS )
 	{
-		if ( level.numBuildablesEstimate[ BA_H_REACTOR ] == 0 )
+		if ( BuildableCensus::CountAlive( G_Team( self ), BA_H_REACTOR ) == 0 )
 		{
 			toBuild = BA_H_REACTOR;
 		}
-		else if ( level.numBuildablesEstimate[ BA_H_DRILL ] == 0 && g_maxMiners.Get() != 0 )
+		else if ( BuildableCensus::CountAlive( G_Team( self ), BA_H_DRILL ) == 0 && g_maxMiners.Get() != 0 )
 		{
 			toBuild = BA_H_DRILL;
 		}
@@ -1324,11 +1324,11 @@ buildable_t BotChooseBuildableToBuild( gentity_t *self )
 		{
 			toBuild = BA_H_SPAWN;
 		}
-		else if ( level.numBuildablesEstimate[ BA_H_ARMOURY ] == 0 )
+		else if ( BuildableCensus::CountAlive( G_Team( self ), BA_H_ARMOURY ) == 0 )
 		{
 			toBuild = BA_H_ARMOURY;
 		}
-		else if ( level.numBuildablesEstimate[ BA_H_MEDISTAT ] == 0 )
+		else if ( BuildableCensus::CountAlive( G_Team( self ), BA_H_MEDISTAT ) == 0 )
 		{
 			toBuild = BA_H_MEDISTAT;
 		}
@@ -1344,11 +1344,11 @@ buildable_t BotChooseBuildableToBuild( gentity_t *self )
 	}
 	else if ( G_Team( self ) == TEAM_ALIENS )
 	{
-		if ( level.numBuildablesEstimate[ BA_A_OVERMIND ] == 0 )
+		if ( BuildableCensus::CountAlive( G_Team( self ), BA_A_OVERMIND ) == 0 )
 		{
 			toBuild = BA_A_OVERMIND;
 		}
-		else if ( level.numBuildablesEstimate[ BA_A_LEECH ] == 0 && g_maxMiners.Get() != 0 )
+		else if ( BuildableCensus::CountAlive( G_Team( self ), BA_A_LEECH ) == 0 && g_maxMiners.Get() != 0 )
 		{
 			toBuild = BA_A_LEECH;
 		}
@@ -1356,7 +1356,7 @@ buildable_t BotChooseBuildableToBuild( gentity_t *self )
 		{
 			toBuild = BA_A_SPAWN;
 		}
-		else if ( BG_BuildableUnlocked( BA_A_BOOSTER ) && level.numBuildablesEstimate[ BA_A_BOOSTER ] == 0 )
+		else if ( BG_BuildableUnlocked( BA_A_BOOSTER ) && BuildableCensus::CountAlive( G_Team( self ), BA_A_BOOSTER ) == 0 )
 		{
 			toBuild = BA_A_BOOSTER;
 		}
@@ -165,6 +165,7 @@ struct botMemory_t
 		int         futureAimTimeInterval;
 		glm::vec3   futureAimBaseDeltaAngles;
 		glm::vec3   futureAim;
+		int         lastEnemyAim; // last time the aim moved toward the enemy
 
 		enemyQueue_t enemyQueue;
 		int enemyLastSeen;
@@ -186,6 +187,10 @@ public:
 		int lastNavconTime;
 		int lastNavconDistance;
 		bool hasOffmeshGoal;
+
+		// what the last think did, which the frames without one carry on
+		bool movesToGoal;
+		bool aimsAtEnemy;
 	// }
 
 	// Reset every frame *while alive*. Reset when behavior changes. Settable by BT
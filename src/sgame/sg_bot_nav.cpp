@@ -1184,6 +1184,8 @@ bool BotMoveToGoal( gentity_t *self )
 	constexpr int softStuckThreshold = 5000; // 5s, something's fishy
 	int stuckTime = level.time - self->botMind->stuckTime;
 
+	self->botMind->movesToGoal = true;
+
 	// At start, ignore geometry, unless we seem stuck for too long.
 	// This avoids the following two bugs:
 	//
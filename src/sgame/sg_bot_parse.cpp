@@ -342,28 +342,44 @@ static AIValue_t numOurBuildings( gentity_t* self, const AIValue_t *params )
 		return AIBoxInt( 0 );
 	}
 
-	// fast track when counting spawns
-	if ( type == BA_H_SPAWN )
+	return AIBoxInt( BuildableCensus::CountAlive( G_Team( self ), static_cast<buildable_t>( type ) ) );
+}
+
+// Teammates with this class, weapon or upgrade, not counting the bot itself
+static AIValue_t numTeamClass( gentity_t *self, const AIValue_t *params )
+{
+	int cls = AIUnBoxInt( params[ 0 ] );
+	if ( cls <= PCL_NONE || cls >= PCL_NUM_CLASSES )
 	{
-		return AIBoxInt( level.team[ TEAM_HUMANS ].numSpawns );
+		Log::Warn( "invalid argument %d to 'numTeamClass' in behavior tree", cls );
+		return AIBoxInt( 0 );
 	}
-	else if ( type == BA_A_SPAWN )
+
+	return AIBoxInt( EquipmentCensus::CountClass( G_Team( self ), static_cast<class_t>( cls ), self ) );
+}
+
+static AIValue_t numTeamWeapon( gentity_t *self, const AIValue_t *params )
+{
+	int weapon = AIUnBoxInt( params[ 0 ] );
+	if ( weapon <= WP_NONE || weapon >= WP_NUM_WEAPONS )
 	{
-		return AIBoxInt( level.team[ TEAM_ALIENS ].numSpawns );
+		Log::Warn( "invalid argument %d to 'numTeamWeapon' in behavior tree", weapon );
+		return AIBoxInt( 0 );
 	}
 
-	team_t team = G_Team( self );
-	int count = 0;
-	ForEntities<BuildableComponent>( [&]( Entity &ent, BuildableComponent & ) {
-		if ( ent.oldEnt->s.modelindex == type
-		     && G_Team( ent.oldEnt ) == team
-		     && Entities::IsAlive( ent ) )
-		{
-			++count;
-		}
-	});
+	return AIBoxInt( EquipmentCensus::CountWeapon( G_Team( self ), static_cast<weapon_t>( weapon ), self ) );
+}
+
+static AIValue_t numTeamUpgrade( gentity_t *self, const AIValue_t *params )
+{
+	int upgrade = AIUnBoxInt( params[ 0 ] );
+	if ( upgrade <= UP_NONE || upgrade >= UP_NUM_UPGRADES )
+	{
+		Log::Warn( "invalid argument %d to 'numTeamUpgrade' in behavior tree", upgrade );
+		return AIBoxInt( 0 );
+	}
 
-	return AIBoxInt( count );
+	return AIBoxInt( EquipmentCensus::CountUpgrade( G_Team( self ), static_cast<upgrade_t>( upgrade ), self ) );
 }
 
 static AIValue_t aliveTime( gentity_t*self, const AIValue_t* )
@@ -526,6 +542,9 @@ static const struct AIConditionMap_s
 	{ "momentum",          momentum,          1 },
 	{ "myTimer",           myTimer,           0 },
 	{ "numOurBuildings",   numOurBuildings,   1 },
+	{ "numTeamClass",      numTeamClass,      1 },
+	{ "numTeamUpgrade",    numTeamUpgrade,    1 },
+	{ "numTeamWeapon",     numTeamWeapon,     1 },
 	{ "numUsersInTeam",    numUsersInTeam,    0 },
 	{ "percentAmmoClip",   percentAmmoClip,   0 },
 	{ "percentClips",      percentClips,      0 },
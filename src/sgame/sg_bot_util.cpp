@@ -30,6 +30,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "CBSE.h"
 #include "shared/bg_gameplay.h" // MIN_WALK_NORMAL
 #include "Entities.h"
+#include "sg_cm_world.h"
+#include "shared/Parallel.h"
+#include "shared/Timing.h"
 
 #include <glm/geometric.hpp>
 #include <glm/gtx/norm.hpp>
@@ -42,7 +45,6 @@ static Cvar::Cvar<int> g_bot_humanAimDelay = Cvar::Cvar<int>( "g_bot_humanAimDel
 //consider bot to be stuck if it does not move farther than this in some period of time
 constexpr float BOT_STUCK_RADIUS = 150.0f;
 
-static void ListTeamEquipment( gentity_t *self, unsigned int (&numUpgrades)[UP_NUM_UPGRADES], unsigned int (&numWeapons)[WP_NUM_WEAPONS] );
 static const int MIN_SKILL = 1;
 static const int MAX_SKILL = 9;
 static const int RANGE_SKILL = MAX_SKILL - MIN_SKILL;
@@ -674,10 +676,8 @@ int BotGetDesiredBuy( gentity_t *self, weapon_t &weapon, upgrade_t upgrades[], s
 	size_t numUpgrades = 0;
 	int usedSlots = 0;
 
-	unsigned int numTeamUpgrades[UP_NUM_UPGRADES] = {};
-	unsigned int numTeamWeapons[WP_NUM_WEAPONS] = {};
+	team_t team = G_Team( self );
 
-	ListTeamEquipment( self, numTeamUpgrades, numTeamWeapons );
 	weapon = WP_NONE;
 	for ( size_t i = 0; i < upgradesSize; ++i )
 	{
@@ -709,8 +709,8 @@ int BotGetDesiredBuy( gentity_t *self, weapon_t &weapon, upgrade_t upgrades[], s
 	//TODO this really needs more generic code, but that would require
 	//deeper refactoring (probably move equipments and classes into structs)
 	//and code to make bots _actually_ use other equipments.
-	int nbTeam = level.team[ G_Team( self ) ].numClients;
-	int nbRadars = numTeamUpgrades[UP_RADAR];
+	int nbTeam = level.team[ team ].numClients;
+	int nbRadars = EquipmentCensus::CountUpgrade( team, UP_RADAR, self );
 	bool teamNeedsRadar = 100 *  nbRadars / nbTeam < g_bot_radarRatio.Get();
 
 	auto buyRadar = [&]()
@@ -747,7 +747,8 @@ int BotGetDesiredBuy( gentity_t *self, weapon_t &weapon, upgrade_t upgrades[], s
 		if ( wp.canBuyNow() && usableCapital >= wp.price()
 				&& ( usedSlots & wp.slots() ) == 0 )
 		{
-			if ( wp.item == WP_FLAMER && numTeamWeapons[WP_FLAMER] > numTeamWeapons[WP_PULSE_RIFLE] )
+			if ( wp.item == WP_FLAMER && EquipmentCensus::CountWeapon( team, WP_FLAMER, self )
+			                             > EquipmentCensus::CountWeapon( team, WP_PULSE_RIFLE, self ) )
 			{
 				continue;
 			}
@@ -951,7 +952,180 @@ static float BotAimAngle( gentity_t *self, const glm::vec3 &pos )
 	return glm::degrees( glm::angle( glm::normalize( forward ), glm::normalize( ideal ) ) );
 }
 
+/*
+=======================
+Bot perception
+
+Perception is split in two phases. The first one only reads entity data, so
+it can run for all bots of a frame at once on worker threads: it finds the
+buildings each bot cares about and lists its possible enemies by priority.
+The second one traces to these enemies in BotFindBestEnemy, as traces must be
+done on the main thread. The result is the same as scoring and tracing the
+enemies one by one, as long as the world hasn't changed in between.
+=======================
+*/
+
+static Cvar::Cvar<int> g_bot_parallelPerceptionThreshold( "g_bot_parallelPerceptionThreshold",
+		"number of thinking bots from which their perception is computed in parallel, 0 to never do it",
+		Cvar::NONE, 4 );
+
+struct enemyCandidate_t
+{
+	gentity_t *ent;
+	float     score;
+};
+
+struct botPerception_t
+{
+	int  time = -1; // level.time of the last update
+	bool hasRadar;
+	std::vector<enemyCandidate_t> enemies; // by decreasing score, then entity number
+};
+
+static botPerception_t botPerceptions[ MAX_CLIENTS ];
+
+static void BotGatherPerception( gentity_t *self, botPerception_t &perception )
+{
+	team_t team = G_Team( self );
+	float  range = g_bot_aliensenseRange.Get();
+	float  fov = g_bot_fov.Get();
+
+	BotFindClosestBuildings( self );
+	BotFindDamagedFriendlyStructure( self );
+
+	perception.time = level.time;
+	perception.hasRadar = ( team == TEAM_ALIENS ) ||
+	                      ( team == TEAM_HUMANS && BG_InventoryContainsUpgrade( UP_RADAR, self->client->ps.stats ) );
+	perception.enemies.clear();
+
+	for ( gentity_t *target = g_entities; target < &g_entities[level.num_entities]; target++ )
+	{
+		if ( !BotEntityIsValidEnemyTarget( self, target ) )
+		{
+			continue;
+		}
+
+		if ( DistanceSquared( self->s.origin, target->s.origin ) > Square( range ) )
+		{
+			continue;
+		}
+
+		glm::vec3 vorigin = VEC2GLM( target->s.origin );
+		if ( target->s.eType == entityType_t::ET_PLAYER && self->client->pers.team == TEAM_HUMANS
+		    && BotAimAngle( self, vorigin ) > fov / 2 )
+		{
+			continue;
+		}
+
+		if ( target == self->botMind->goal.getTargetedEntity() )
+		{
+			continue;
+		}
+
+		float score = BotGetEnemyPriority( self, target );
+
+		// neither visible nor radar targets are picked without a positive score
+		if ( score > 0.0f )
+		{
+			perception.enemies.push_back( { target, score } );
+		}
+	}
+
+	// ties go to the lowest entity number, as when scanning in order
+	std::sort( perception.enemies.begin(), perception.enemies.end(),
+	           []( const enemyCandidate_t &a, const enemyCandidate_t &b ) {
+		return a.score != b.score ? a.score > b.score : a.ent < b.ent;
+	} );
+}
+
+static void BotGatherPerceptions( gentity_t *const *bots, int numBots, int parallelThreshold )
+{
+	Parallel::SetNumThreads( g_workerThreads.Get() );
+	Parallel::For( numBots, parallelThreshold > 0 ? parallelThreshold : INT_MAX, [ bots ]( int begin, int end ) {
+		for ( int i = begin; i < end; i++ )
+		{
+			BotGatherPerception( bots[ i ], botPerceptions[ bots[ i ]->num() ] );
+		}
+	} );
+}
+
+/*
+=======================
+BotPerceiveAll
+
+Runs the read-only phase of perception for these bots on worker threads, if
+there are enough of them. Perception gathered this way dates from before any
+of them thinks, so below the threshold nothing is done and each bot gathers
+its own when it thinks, from an up to date world.
+=======================
+*/
+void BotPerceiveAll( gentity_t *const *bots, int numBots )
+{
+	int threshold = g_bot_parallelPerceptionThreshold.Get();
+
+	if ( threshold <= 0 || numBots < threshold )
+	{
+		return;
+	}
+
+	BotGatherPerceptions( bots, numBots, threshold );
+}
+
+/*
+=======================
+BotPerceive
+
+Makes sure the read-only phase of perception is up to date for this frame.
+=======================
+*/
+void BotPerceive( gentity_t *self )
+{
+	botPerception_t &perception = botPerceptions[ self->num() ];
+
+	if ( perception.time != level.time )
+	{
+		BotGatherPerception( self, perception );
+	}
+}
+
 gentity_t* BotFindBestEnemy( gentity_t *self )
+{
+	BotPerceive( self );
+
+	const botPerception_t &perception = botPerceptions[ self->num() ];
+	gentity_t *bestInvisibleEnemy = nullptr;
+
+	for ( const enemyCandidate_t &candidate : perception.enemies )
+	{
+		// may have died since the list was made
+		if ( !BotEntityIsValidEnemyTarget( self, candidate.ent ) )
+		{
+			continue;
+		}
+
+		if ( BotEntityIsVisible( self, candidate.ent, MASK_OPAQUE ) )
+		{
+			return candidate.ent;
+		}
+
+		if ( !bestInvisibleEnemy )
+		{
+			bestInvisibleEnemy = candidate.ent;
+		}
+	}
+
+	return perception.hasRadar ? bestInvisibleEnemy : nullptr;
+}
+
+/*
+=======================
+BotFindBestEnemySerial
+
+The single-threaded enemy scan that perception replaces: it scores and traces
+each enemy in entity order. Kept as the reference for botPerceptionTest.
+=======================
+*/
+static gentity_t* BotFindBestEnemySerial( gentity_t *self )
 {
 	float bestVisibleEnemyScore = 0.0f;
 	float bestInvisibleEnemyScore = 0.0f;
@@ -1012,6 +1186,118 @@ gentity_t* BotFindBestEnemy( gentity_t *self )
 	}
 }
 
+/*
+=======================
+BotPerceptionTestCmd
+
+Checks that perception gathered on worker threads leads to the same enemy and
+buildings as the single-threaded BotFindBestEnemySerial, BotFindClosestBuildings
+and BotFindDamagedFriendlyStructure, and times both.
+=======================
+*/
+class BotPerceptionTestCmd : public Cmd::StaticCmd
+{
+public:
+	BotPerceptionTestCmd() : StaticCmd( "botPerceptionTest", 0,
+		"compare bot perception computed in parallel with the serial scan: botPerceptionTest [iterations]" ) {}
+
+	void Run( const Cmd::Args& args ) const override
+	{
+		int iterations = args.Argc() > 1 ? std::max( atoi( args.Argv( 1 ).c_str() ), 1 ) : 100;
+		std::vector<gentity_t *> bots;
+
+		for ( int i = 0; i < level.maxclients; i++ )
+		{
+			gentity_t *ent = &g_entities[ i ];
+
+			if ( ent->client && ent->client->pers.isBot && ent->botMind
+			     && G_IsPlayableTeam( G_Team( ent ) ) && Entities::IsAlive( ent ) )
+			{
+				bots.push_back( ent );
+			}
+		}
+
+		if ( bots.empty() )
+		{
+			Print( "no living bots" );
+			return;
+		}
+
+		struct result_t
+		{
+			gentity_t *enemy;
+			gentity_t *closest[ BA_NUM_BUILDABLES ];
+			gentity_t *damaged;
+		};
+
+		auto collect = [ &bots ]( std::vector<result_t> &results, gentity_t *( *findEnemy )( gentity_t * ) ) {
+			for ( size_t i = 0; i < bots.size(); i++ )
+			{
+				const botMemory_t &mind = *bots[ i ]->botMind;
+
+				results[ i ].enemy = findEnemy( bots[ i ] );
+				for ( int j = 0; j < BA_NUM_BUILDABLES; j++ )
+				{
+					results[ i ].closest[ j ] = mind.closestBuildings[ j ].ent;
+				}
+				results[ i ].damaged = mind.closestDamagedBuilding.ent;
+			}
+		};
+
+		std::vector<result_t> serial( bots.size() );
+		std::vector<result_t> parallel( bots.size() );
+
+		auto start = Timing::Now();
+		for ( int n = 0; n < iterations; n++ )
+		{
+			for ( gentity_t *bot : bots )
+			{
+				BotFindClosestBuildings( bot );
+				BotFindDamagedFriendlyStructure( bot );
+				BotFindBestEnemySerial( bot );
+			}
+		}
+		int serialUsec = Timing::Elapsed( start );
+		collect( serial, BotFindBestEnemySerial );
+
+		start = Timing::Now();
+		for ( int n = 0; n < iterations; n++ )
+		{
+			BotGatherPerceptions( bots.data(), static_cast<int>( bots.size() ), 1 );
+			for ( gentity_t *bot : bots )
+			{
+				BotFindBestEnemy( bot );
+			}
+		}
+		int parallelUsec = Timing::Elapsed( start );
+		collect( parallel, BotFindBestEnemy );
+
+		int mismatches = 0;
+		for ( size_t i = 0; i < bots.size(); i++ )
+		{
+			const result_t &a = serial[ i ];
+			const result_t &b = parallel[ i ];
+			bool same = a.enemy == b.enemy && a.damaged == b.damaged;
+
+			for ( int j = 0; same && j < BA_NUM_BUILDABLES; j++ )
+			{
+				same = a.closest[ j ] == b.closest[ j ];
+			}
+
+			if ( !same )
+			{
+				Print( "^1perception of %s^1 differs", bots[ i ]->client->pers.netname );
+				mismatches++;
+			}
+		}
+
+		Print( "%d bots, %d iterations, %d worker threads", static_cast<int>( bots.size() ), iterations, Parallel::NumThreads() );
+		Print( "serial:   %d us", serialUsec / iterations );
+		Print( "parallel: %d us%s", parallelUsec / iterations, mismatches ? " ^1(results differ)" : "" );
+	}
+};
+static BotPerceptionTestCmd botPerceptionTestRegistration;
+
 gentity_t* BotFindClosestEnemy( gentity_t *self )
 {
 	gentity_t* closestEnemy = nullptr;
@@ -1513,7 +1799,7 @@ bool BotTargetIsVisible( const gentity_t *self, botTarget_t target, int mask )
 		return false;
 	}
 
-	trap_Trace( &trace, muzzle, {}, {}, targetPos, self->num(), mask, 0 );
+	G_CM_CachedTrace( &trace, muzzle, targetPos, self->num(), mask );
 
 	if ( trace.surfaceFlags & SURF_NOIMPACT )
 	{
@@ -1616,6 +1902,8 @@ static int BotGetAimTime( gentity_t *self )
 // powerful against moving targets by the fact that the aim position is quite outdated at that point.
 void BotAimAtEnemy( gentity_t *self )
 {
+	self->botMind->aimsAtEnemy = true;
+
 	if ( self->botMind->futureAimTime < level.time )
 	{
 		int aimTime = self->botMind->futureAimTimeInterval = BotGetAimTime( self );
@@ -1657,7 +1945,7 @@ void BotAimAtEnemy( gentity_t *self )
 	// Without this, low-skill bots constantly aim above the target.
 	if ( BG_GetPlayerWeapon( &self->client->ps ) == WP_CHAINGUN && self->client->ps.weaponTime > 0 )
 	{
-		int timeDelta = level.time - self->botMind->lastThink;
+		int timeDelta = level.time - self->botMind->lastEnemyAim;
 		float degreesPerShot = BG_IsChaingunStabilized( &self->client->ps )
 			? STABILIZED_CHAINGUN_JITTER_PITCH_BIAS
 			: UNSTABILIZED_CHAINGUN_JITTER_PITCH_BIAS;
@@ -1666,6 +1954,8 @@ void BotAimAtEnemy( gentity_t *self )
 		self->botMind->futureAimBaseDeltaAngles[ PITCH ] = AngleSubtract(
 			self->botMind->futureAimBaseDeltaAngles[ PITCH ], -angleUpdate );
 	}
+
+	self->botMind->lastEnemyAim = level.time;
 }
 
 void BotAimAtLocation( gentity_t *self, const glm::vec3 &target )
@@ -1818,58 +2108,17 @@ bool PlayersBehindBotInSpawnQueue( gentity_t *self )
 	}
 }
 
-// Initializes numUpgrades and numWeapons arrays with team's current equipment
-// pre-condition:
-// * self points to a player which is inside a playable team
-// * numUpgrades memory is initialized
-// * numWeapons memory is initialized
-static void ListTeamEquipment( gentity_t *self, unsigned int (&numUpgrades)[UP_NUM_UPGRADES], unsigned int (&numWeapons)[WP_NUM_WEAPONS] )
-{
-	ASSERT( self );
-	const team_t team = static_cast<team_t>( self->client->pers.team );
-
-	ForEntities<HumanClassComponent>([&](Entity& ent, HumanClassComponent&) {
-		gentity_t* ally = ent.oldEnt;
-		if ( ally == self || ally->client->pers.team != team )
-		{
-			return;
-		}
-		++numWeapons[ally->client->ps.stats[STAT_WEAPON]];
-
-		// for all possible upgrades, check if current player already have it.
-		// this is very fragile, at best, since it will break if TEAM_ALIENS becomes
-		// able to have upgrades. Class is not considered, neither.
-		// last but not least, it's playing with bits.
-		int stat = ally->client->ps.stats[STAT_ITEMS];
-		for ( int up = UP_NONE + 1; up < UP_NUM_UPGRADES; ++up )
-		{
-			if ( stat & ( 1 << up ) )
-			{
-				++numUpgrades[up];
-			}
-		}
-	});
-}
-
 bool BotTeamateHasWeapon( gentity_t *self, int weapon )
 {
-	int botNumbers[MAX_CLIENTS];
-	int i;
-	int numBots = FindBots( botNumbers, MAX_CLIENTS, ( team_t ) self->client->pers.team );
+	team_t team = static_cast<team_t>( self->client->pers.team );
 
-	for ( i = 0; i < numBots; i++ )
+	// humans always have a blaster
+	if ( weapon == WP_BLASTER && team == TEAM_HUMANS )
 	{
-		gentity_t *bot = &g_entities[botNumbers[i]];
-		if ( bot == self )
-		{
-			continue;
-		}
-		if ( BG_InventoryContainsWeapon( weapon, bot->client->ps.stats ) )
-		{
-			return true;
-		}
+		return EquipmentCensus::CountBots( team ) > ( self->client->pers.isBot ? 1 : 0 );
 	}
-	return false;
+
+	return EquipmentCensus::CountBotsWithWeapon( team, static_cast<weapon_t>( weapon ), self ) > 0;
 }
 
 /*
@@ -2369,6 +2618,7 @@ bool BotBuyWeapon( gentity_t *self, weapon_t weapon )
 
 	//update ClientInfo
 	ClientUserinfoChanged( self->client->ps.clientNum, false );
+	EquipmentCensus::Update( self );
 	return true;
 }
 
@@ -2453,6 +2703,7 @@ bool BotBuyUpgrade( gentity_t *self, upgrade_t upgrade )
 
 	//update ClientInfo
 	ClientUserinfoChanged( self->client->ps.clientNum, false );
+	EquipmentCensus::Update( self );
 	return true;
 }
 
@@ -2496,6 +2747,8 @@ void BotSellWeapons( gentity_t *self )
 			G_ForceWeaponChange( self, WP_NONE );
 		}
 	}
+
+	EquipmentCensus::Update( self );
 }
 void BotSellUpgrades( gentity_t *self )
 {
@@ -2532,6 +2785,7 @@ void BotSellUpgrades( gentity_t *self )
 	}
 	//update ClientInfo
 	ClientUserinfoChanged( self->client->ps.clientNum, false );
+	EquipmentCensus::Update( self );
 }
 
 void BotSetSkillLevel( gentity_t *self, int skill )
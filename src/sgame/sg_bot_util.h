@@ -48,6 +48,8 @@ gentity_t* BotFindBestEnemy( gentity_t *self );
 void       BotFindClosestBuildings( gentity_t *self );
 bool   BotTeamateHasWeapon( gentity_t *self, int weapon );
 void       BotSearchForEnemy( gentity_t *self );
+void       BotPerceive( gentity_t *self );
+void       BotPerceiveAll( gentity_t *const *bots, int numBots );
 void       BotPain( gentity_t *self, gentity_t *attacker, int damage );
 botEntityAndDistance_t BotGetHealTarget( const gentity_t *self );
 
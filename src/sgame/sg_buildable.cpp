@@ -51,62 +51,28 @@ bool G_IsWarnableMOD(meansOfDeath_t mod) {
 	}
 }
 
-static gentity_t *FindBuildable(buildable_t buildable) {
-	gentity_t* found = nullptr;
-
-	ForEntities<BuildableComponent>([&](Entity& entity, BuildableComponent&) {
-		if (entity.oldEnt->s.modelindex == buildable) {
-			found = entity.oldEnt;
-		}
-	});
-
-	return found;
-}
-
-template<typename Component>
-static gentity_t *LookUpMainBuildable(bool requireActive)
-{
-	gentity_t *answer = nullptr;
-	ForEntities<Component>([&](Entity& entity, Component&) {
-		if (!requireActive ||
-		    entity.Get<BuildableComponent>()->GetState() == BuildableComponent::CONSTRUCTED)
-		{
-			answer = entity.oldEnt;
-		}
-	});
-	return answer;
-}
-
 gentity_t *G_Overmind() {
-	return LookUpMainBuildable<OvermindComponent>(false);
+	return BuildableCensus::MainBuildable(TEAM_ALIENS);
 }
 
 gentity_t *G_ActiveOvermind() {
-	return LookUpMainBuildable<OvermindComponent>(true);
+	return BuildableCensus::ActiveMainBuildable(TEAM_ALIENS);
 }
 
 gentity_t *G_Reactor() {
-	return LookUpMainBuildable<ReactorComponent>(false);
+	return BuildableCensus::MainBuildable(TEAM_HUMANS);
 }
 
 gentity_t *G_ActiveReactor() {
-	return LookUpMainBuildable<ReactorComponent>(true);
+	return BuildableCensus::ActiveMainBuildable(TEAM_HUMANS);
 }
 
 gentity_t *G_MainBuildable(team_t team) {
-	switch (team) {
-		case TEAM_ALIENS: return G_Overmind();
-		case TEAM_HUMANS: return G_Reactor();
-		default:          return nullptr;
-	}
+	return BuildableCensus::MainBuildable(team);
 }
 
 gentity_t *G_ActiveMainBuildable(team_t team) {
-	switch (team) {
-		case TEAM_ALIENS: return G_ActiveOvermind();
-		case TEAM_HUMANS: return G_ActiveReactor();
-		default:          return nullptr;
-	}
+	return BuildableCensus::ActiveMainBuildable(team);
 }
 
 /**
@@ -408,6 +374,12 @@ void G_UpdateBuildablePowerStates()
 		int unpoweredBuildableTotal = 0;
 		activeMainBuildable = G_ActiveMainBuildable(team);
 
+		// Without any unpowered buildables or a deficit there is nothing to switch.
+		if (activeMainBuildable && !BuildableCensus::UnpoweredBuildPoints(team) &&
+		    level.team[team].spentBudget <= (int)level.team[team].totalBudget) {
+			continue;
+		}
+
 		ForEntities<BuildableComponent>([&](Entity& entity, BuildableComponent& buildableComponent) {
 			if (G_Team(entity.oldEnt) != team) return;
 
@@ -1300,7 +1272,7 @@ itemBuildError_t G_CanBuild( gentity_t *ent, buildable_t buildable, int /*distan
 	// Can we only have one of these?
 	if ( BG_Buildable( buildable )->uniqueTest )
 	{
-		tempent = FindBuildable( buildable );
+		tempent = BuildableCensus::Find( buildable );
 
 		if ( tempent && !tempent->entity->Get<BuildableComponent>()->MarkedForDeconstruction() )
 		{
@@ -1101,7 +1101,11 @@ const char *ClientConnect( int clientNum, bool firstTime )
 
 	G_AddressParse( value, &client->pers.ip );
 
-	trap_GetPlayerPubkey( clientNum, pubkey, sizeof( pubkey ) );
+	// a replayed client isn't connected to the engine
+	if ( !Replay::Pubkey( clientNum, pubkey, sizeof( pubkey ) ) )
+	{
+		trap_GetPlayerPubkey( clientNum, pubkey, sizeof( pubkey ) );
+	}
 
 	if ( strlen( pubkey ) != RSA_STRING_LENGTH - 1 )
 	{
@@ -1699,7 +1703,7 @@ void ClientSpawn( gentity_t *ent, gentity_t *spawn, const vec3_t origin, const v
 	// the respawned flag will be cleared after the attack and jump keys come up
 	client->ps.pm_flags |= PMF_RESPAWNED;
 
-	trap_GetUsercmd( client->num(), &ent->client->pers.cmd );
+	G_GetUsercmd( client->num(), &ent->client->pers.cmd );
 	G_SetClientViewAngle( ent, spawn_angles );
 
 	if ( willBeAlive )
@@ -1780,6 +1784,8 @@ void ClientSpawn( gentity_t *ent, gentity_t *spawn, const vec3_t origin, const v
 	// (re)tag the client for its team
 	Beacon::DeleteTags( ent );
 	Beacon::Tag( ent, (team_t)ent->client->ps.persistant[ PERS_TEAM ], true );
+
+	EquipmentCensus::Update( ent );
 }
 
 /*
@@ -1836,6 +1842,7 @@ void ClientDisconnect( int clientNum )
 	G_FreeEntity(ent);
 	ent->classname = BG_strdup( "disconnected" );
 	ent->client = level.clients + clientNum;
+	EquipmentCensus::Update( ent );
 
 	trap_SetConfigstring( CS_PLAYERS + clientNum, "" );
 
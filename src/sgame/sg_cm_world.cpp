@@ -37,6 +37,7 @@ Maryland 20850 USA.
 #include "common/Common.h"
 #include "sg_local.h"
 #include "sg_cm_world.h"
+#include "shared/Timing.h"
 
 struct worldSector_t;
 struct worldEntity_t
@@ -47,6 +48,28 @@ struct worldEntity_t
 
 worldEntity_t wentities[ MAX_GENTITIES ];
 
+// incremented whenever an entity is linked or unlinked, so that cached
+// lists of entities in an area know when they have to be gathered again
+static int worldLinkCount;
+
+// bounds of the last entities that were linked or unlinked, so that cached
+// traces can tell whether anything changed near them
+struct worldChange_t
+{
+	vec3_t mins, maxs;
+};
+
+static const unsigned WORLD_CHANGES = 256; // power of two
+static worldChange_t worldChanges[ WORLD_CHANGES ];
+static unsigned worldChangeCount;
+
+static void G_CM_RecordWorldChange( const vec3_t mins, const vec3_t maxs )
+{
+	worldChange_t &change = worldChanges[ worldChangeCount++ & ( WORLD_CHANGES - 1 ) ];
+	VectorCopy( mins, change.mins );
+	VectorCopy( maxs, change.maxs );
+}
+
 static worldEntity_t *G_CM_WorldEntityForGentity( gentity_t *gEnt )
 {
 	if ( !gEnt || gEnt->num() < 0 || gEnt->num() >= MAX_GENTITIES )
@@ -121,33 +144,79 @@ static clipHandle_t G_CM_ClipHandleForEntity( const gentity_t *ent )
 
 /*
 =================
-G_CM_inPVS
+PVS lookups
 
-Also checks portalareas so that doors block sight
+Finding the cluster and area of a point walks down the BSP tree. Most
+visibility tests involve things that stay put (buildables, beacons, location
+entities), so the results are cached by exact position; the BSP doesn't change
+while the map is loaded.
 =================
 */
-bool G_CM_inPVS( const vec3_t p1, const vec3_t p2 )
+
+struct pvsCacheEntry_t
+{
+	vec3_t     point;
+	pvsPoint_t pvs;
+	bool       valid;
+};
+
+static const int PVS_CACHE_SIZE = 4096; // power of two
+static pvsCacheEntry_t pvsCache[ PVS_CACHE_SIZE ];
+
+static pvsPoint_t G_CM_ResolvePVSPoint( const vec3_t p )
+{
+	int leafnum = CM_PointLeafnum( p );
+
+	return { CM_LeafCluster( leafnum ), CM_LeafArea( leafnum ) };
+}
+
+pvsPoint_t G_CM_PVSPoint( const vec3_t p )
+{
+	uint32_t bits[ 3 ];
+	memcpy( bits, p, sizeof( bits ) );
+
+	uint32_t hash = ( bits[ 0 ] * 73856093u ) ^ ( bits[ 1 ] * 19349663u ) ^ ( bits[ 2 ] * 83492791u );
+	pvsCacheEntry_t &entry = pvsCache[ ( hash ^ ( hash >> 16 ) ) & ( PVS_CACHE_SIZE - 1 ) ];
+
+	if ( !entry.valid || memcmp( entry.point, p, sizeof( entry.point ) ) )
+	{
+		VectorCopy( p, entry.point );
+		entry.pvs = G_CM_ResolvePVSPoint( p );
+		entry.valid = true;
+	}
+
+	return entry.pvs;
+}
+
+/*
+=================
+G_CM_ClustersVisible
+
+Whether cluster2 is in the potentially visible set of cluster1
+=================
+*/
+bool G_CM_ClustersVisible( int cluster1, int cluster2 )
 {
-	int  leafnum;
-	int  cluster;
-	int  area1, area2;
-	byte *mask;
+	byte *mask = CM_ClusterPVS( cluster1 );
 
-	leafnum = CM_PointLeafnum( p1 );
-	cluster = CM_LeafCluster( leafnum );
-	area1 = CM_LeafArea( leafnum );
-	mask = CM_ClusterPVS( cluster );
+	return !mask || ( mask[ cluster2 >> 3 ] & ( 1 << ( cluster2 & 7 ) ) );
+}
 
-	leafnum = CM_PointLeafnum( p2 );
-	cluster = CM_LeafCluster( leafnum );
-	area2 = CM_LeafArea( leafnum );
+/*
+=================
+G_CM_inPVS
 
-	if ( mask && ( !( mask[ cluster >> 3 ] & ( 1 << ( cluster & 7 ) ) ) ) )
+Also checks portalareas so that doors block sight
+=================
+*/
+bool G_CM_inPVS( const pvsPoint_t &p1, const pvsPoint_t &p2 )
+{
+	if ( !G_CM_ClustersVisible( p1.cluster, p2.cluster ) )
 	{
 		return false;
 	}
 
-	if ( !CM_AreasConnected( area1, area2 ) )
+	if ( !CM_AreasConnected( p1.area, p2.area ) )
 	{
 		return false; // a door blocks sight
 	}
@@ -155,6 +224,11 @@ bool G_CM_inPVS( const vec3_t p1, const vec3_t p2 )
 	return true;
 }
 
+bool G_CM_inPVS( const vec3_t p1, const vec3_t p2 )
+{
+	return G_CM_inPVS( G_CM_PVSPoint( p1 ), G_CM_PVSPoint( p2 ) );
+}
+
 /*
 =================
 G_CM_inPVSIgnorePortals
@@ -164,27 +238,88 @@ Does NOT check portalareas
 */
 bool G_CM_inPVSIgnorePortals( const vec3_t p1, const vec3_t p2 )
 {
-	int  leafnum;
-	int  cluster;
-//	int             area1, area2; //unused
-	byte *mask;
-
-	leafnum = CM_PointLeafnum( p1 );
-	cluster = CM_LeafCluster( leafnum );
-//	area1 = CM_LeafArea(leafnum); //Doesn't modify anything.
+	return G_CM_ClustersVisible( G_CM_PVSPoint( p1 ).cluster, G_CM_PVSPoint( p2 ).cluster );
+}
 
-	mask = CM_ClusterPVS( cluster );
-	leafnum = CM_PointLeafnum( p2 );
-	cluster = CM_LeafCluster( leafnum );
-//	area2 = CM_LeafArea(leafnum); //Doesn't modify anything.
+class BenchmarkPVSCmd : public Cmd::StaticCmd
+{
+public:
+	BenchmarkPVSCmd() : StaticCmd( "benchmarkPVS", 0,
+		"time PVS tests between all linked entities, with and without the position cache: benchmarkPVS [iterations]" ) {}
 
-	if ( mask && ( !( mask[ cluster >> 3 ] & ( 1 << ( cluster & 7 ) ) ) ) )
+	void Run( const Cmd::Args& args ) const override
 	{
-		return false;
+		int iterations = args.Argc() > 1 ? std::max( 1, atoi( args.Argv( 1 ).c_str() ) ) : 10;
+
+		std::vector<const float *> origins;
+		for ( int i = 0; i < level.num_entities; i++ )
+		{
+			if ( g_entities[ i ].inuse && g_entities[ i ].r.linked )
+			{
+				origins.push_back( g_entities[ i ].r.currentOrigin );
+			}
+		}
+
+		int uncachedVisible = 0;
+		auto start = Timing::Now();
+		for ( int iteration = 0; iteration < iterations; iteration++ )
+		{
+			for ( const float *a : origins )
+			{
+				for ( const float *b : origins )
+				{
+					uncachedVisible += G_CM_inPVS( G_CM_ResolvePVSPoint( a ), G_CM_ResolvePVSPoint( b ) );
+				}
+			}
+		}
+		int uncachedUsec = Timing::Elapsed( start );
+
+		int cachedVisible = 0;
+		start = Timing::Now();
+		for ( int iteration = 0; iteration < iterations; iteration++ )
+		{
+			for ( const float *a : origins )
+			{
+				for ( const float *b : origins )
+				{
+					cachedVisible += G_CM_inPVS( a, b );
+				}
+			}
+		}
+		int cachedUsec = Timing::Elapsed( start );
+
+		int tests = iterations * static_cast<int>( origins.size() * origins.size() );
+		Print( "%d entities, %d tests", static_cast<int>( origins.size() ), tests );
+		Print( "uncached: %d us", uncachedUsec );
+		Print( "cached:   %d us%s", cachedUsec, uncachedVisible == cachedVisible ? "" : " ^1(results differ)" );
 	}
+};
+static BenchmarkPVSCmd benchmarkPVSRegistration;
 
-	return true;
-}
+struct traceCacheEntry_t
+{
+	vec3_t   start, end;
+	int      passEntityNum;
+	int      contentmask;
+	unsigned changeCount; // worldChangeCount the result is known to be valid at
+	int      time; // when it was traced
+	bool     valid;
+	trace_t  trace;
+};
+
+static const int TRACE_CACHE_SIZE = 1024; // power of two
+static traceCacheEntry_t traceCache[ TRACE_CACHE_SIZE ];
+
+// Results are reused for a few frames at most, in case an entity changes what
+// it collides with without being linked again.
+static const int TRACE_CACHE_MAX_AGE = 100;
+
+static struct
+{
+	int hits;
+	int revalidations;
+	int misses;
+} traceCacheStats;
 
 /*
 ========================
@@ -339,6 +474,9 @@ void G_CM_ClearWorld()
 	memset( sv_worldSectors, 0, sizeof( sv_worldSectors ) );
 	memset( wentities, 0, sizeof( wentities ) );
 	sv_numworldSectors = 0;
+	worldLinkCount++;
+	memset( pvsCache, 0, sizeof( pvsCache ) );
+	memset( traceCache, 0, sizeof( traceCache ) );
 
 	// get world map bounds
 	h = CM_InlineModel( 0 );
@@ -360,6 +498,7 @@ void G_CM_UnlinkEntity( gentity_t *gEnt )
 	worldEntity_t* went = G_CM_WorldEntityForGentity( gEnt );
 
 	gEnt->r.linked = false;
+	worldLinkCount++;
 
 	ws = went->worldSector;
 
@@ -369,6 +508,7 @@ void G_CM_UnlinkEntity( gentity_t *gEnt )
 	}
 
 	went->worldSector = nullptr;
+	G_CM_RecordWorldChange( gEnt->r.absmin, gEnt->r.absmax );
 
 	if ( ws->entities == went )
 	{
@@ -407,6 +547,8 @@ void G_CM_LinkEntity( gentity_t *gEnt )
 
 	worldEntity_t* went = G_CM_WorldEntityForGentity( gEnt );
 
+	worldLinkCount++;
+
 	if ( went->worldSector )
 	{
 		G_CM_UnlinkEntity( gEnt );  // unlink from old position
@@ -492,6 +634,8 @@ void G_CM_LinkEntity( gentity_t *gEnt )
 	gEnt->r.absmax[ 1 ] += 1;
 	gEnt->r.absmax[ 2 ] += 1;
 
+	G_CM_RecordWorldChange( gEnt->r.absmin, gEnt->r.absmax );
+
 	// link to PVS leafs
 	gEnt->r.numClusters = 0;
 	gEnt->r.lastCluster = 0;
@@ -695,6 +839,7 @@ struct moveclip_t
 	int         contentmask;
 	int         skipmask;
 	traceType_t collisionType;
+	bool        stopAtHit; // only whether anything is hit matters
 };
 
 /*
@@ -702,16 +847,13 @@ struct moveclip_t
 G_CM_ClipMoveToEntities
 ====================
 */
-static void G_CM_ClipMoveToEntities( moveclip_t *clip )
+static void G_CM_ClipMoveToEntityList( moveclip_t *clip, const int *touchlist, int num, bool checkBounds )
 {
-	int            i, num;
-	int            touchlist[ MAX_GENTITIES ];
+	int            i;
 	gentity_t *touch;
 	trace_t        trace;
 	clipHandle_t   clipHandle;
 
-	num = G_CM_AreaEntities( clip->boxmins, clip->boxmaxs, touchlist, MAX_GENTITIES );
-
 	for ( i = 0; i < num; i++ )
 	{
 		if ( clip->trace.allsolid )
@@ -719,8 +861,25 @@ static void G_CM_ClipMoveToEntities( moveclip_t *clip )
 			return;
 		}
 
+		if ( clip->stopAtHit && clip->trace.fraction < 1.0f )
+		{
+			return;
+		}
+
 		touch = &g_entities[ touchlist[ i ] ];
 
+		// the list may cover more than this move, so apply the same test as G_CM_AreaEntities
+		if ( checkBounds && ( !touch->r.linked
+		     || touch->r.absmin[ 0 ] > clip->boxmaxs[ 0 ]
+		     || touch->r.absmin[ 1 ] > clip->boxmaxs[ 1 ]
+		     || touch->r.absmin[ 2 ] > clip->boxmaxs[ 2 ]
+		     || touch->r.absmax[ 0 ] < clip->boxmins[ 0 ]
+		     || touch->r.absmax[ 1 ] < clip->boxmins[ 1 ]
+		     || touch->r.absmax[ 2 ] < clip->boxmins[ 2 ] ) )
+		{
+			continue;
+		}
+
 		// see if we should ignore this entity
 		if ( clip->passEntityNum != ENTITYNUM_NONE )
 		{
@@ -784,6 +943,14 @@ static void G_CM_ClipMoveToEntities( moveclip_t *clip )
 	}
 }
 
+static void G_CM_ClipMoveToEntities( moveclip_t *clip )
+{
+	int touchlist[ MAX_GENTITIES ];
+	int num = G_CM_AreaEntities( clip->boxmins, clip->boxmaxs, touchlist, MAX_GENTITIES );
+
+	G_CM_ClipMoveToEntityList( clip, touchlist, num, false );
+}
+
 /*
 ==================
 G_CM_Trace
@@ -863,6 +1030,240 @@ void G_CM_Trace( trace_t *results, const vec3_t start, const vec3_t mins2, const
 	*results = clip.trace;
 }
 
+/*
+==================
+G_CM_BeginTraceBatch
+
+Gathers the entities that could block a point trace from start to any point
+of the given area, so that traces sharing a start don't each search the world
+sectors again.
+==================
+*/
+void G_CM_BeginTraceBatch( traceBatch_t *batch, const vec3_t start, const vec3_t mins, const vec3_t maxs,
+                           int contentmask )
+{
+	vec3_t boxmins, boxmaxs;
+
+	VectorCopy( start, batch->start );
+	VectorCopy( mins, batch->mins );
+	VectorCopy( maxs, batch->maxs );
+	batch->contentmask = contentmask;
+
+	// same margin as in G_CM_Trace
+	for ( int i = 0; i < 3; i++ )
+	{
+		boxmins[ i ] = std::min( start[ i ], mins[ i ] ) - 1;
+		boxmaxs[ i ] = std::max( start[ i ], maxs[ i ] ) + 1;
+	}
+
+	batch->entities.resize( MAX_GENTITIES );
+	batch->entities.resize( G_CM_AreaEntities( boxmins, boxmaxs, batch->entities.data(), MAX_GENTITIES ) );
+	batch->linkCount = worldLinkCount;
+}
+
+static bool G_CM_BatchTrace( trace_t *results, traceBatch_t *batch, const vec3_t end, bool stopAtHit )
+{
+	moveclip_t clip{};
+
+	if ( end[ 0 ] < batch->mins[ 0 ] || end[ 1 ] < batch->mins[ 1 ] || end[ 2 ] < batch->mins[ 2 ]
+	     || end[ 0 ] > batch->maxs[ 0 ] || end[ 1 ] > batch->maxs[ 1 ] || end[ 2 ] > batch->maxs[ 2 ] )
+	{
+		G_CM_Trace( results, batch->start, nullptr, nullptr, end, ENTITYNUM_NONE, batch->contentmask, 0,
+		            traceType_t::TT_AABB );
+		return results->fraction == 1.0f;
+	}
+
+	// entities were linked or moved since the list was made
+	if ( batch->linkCount != worldLinkCount )
+	{
+		G_CM_BeginTraceBatch( batch, batch->start, batch->mins, batch->maxs, batch->contentmask );
+	}
+
+	CM_BoxTrace( &clip.trace, batch->start, end, vec3_origin, vec3_origin, 0, batch->contentmask, 0,
+	             traceType_t::TT_AABB );
+	clip.trace.entityNum = clip.trace.fraction == 1.0 ? ENTITYNUM_NONE : ENTITYNUM_WORLD;
+
+	if ( clip.trace.allsolid || ( stopAtHit && clip.trace.fraction < 1.0f ) )
+	{
+		*results = clip.trace;
+		return results->fraction == 1.0f;
+	}
+
+	clip.contentmask = batch->contentmask;
+	clip.start = batch->start;
+	VectorCopy( end, clip.end );
+	clip.mins = vec3_origin;
+	clip.maxs = vec3_origin;
+	clip.passEntityNum = ENTITYNUM_NONE;
+	clip.collisionType = traceType_t::TT_AABB;
+	clip.stopAtHit = stopAtHit;
+
+	for ( int i = 0; i < 3; i++ )
+	{
+		clip.boxmins[ i ] = std::min( batch->start[ i ], end[ i ] ) - 1;
+		clip.boxmaxs[ i ] = std::max( batch->start[ i ], end[ i ] ) + 1;
+	}
+
+	G_CM_ClipMoveToEntityList( &clip, batch->entities.data(), static_cast<int>( batch->entities.size() ), true );
+
+	*results = clip.trace;
+	return results->fraction == 1.0f;
+}
+
+/*
+==================
+G_CM_BatchTrace
+
+Same result as G_CM_Trace from the batch start to end with point bounds,
+no pass entity and no skipmask.
+==================
+*/
+void G_CM_BatchTrace( trace_t *results, traceBatch_t *batch, const vec3_t end )
+{
+	G_CM_BatchTrace( results, batch, end, false );
+}
+
+/*
+==================
+G_CM_BatchTraceClear
+
+Whether G_CM_BatchTrace to end would reach it, stopping at the first obstacle.
+==================
+*/
+bool G_CM_BatchTraceClear( traceBatch_t *batch, const vec3_t end )
+{
+	trace_t tr;
+	return G_CM_BatchTrace( &tr, batch, end, true );
+}
+
+/*
+==================
+G_CM_WorldChangedAlong
+
+Whether an entity was linked or unlinked near the segment from start to end
+since worldChangeCount was since.
+==================
+*/
+static bool G_CM_WorldChangedAlong( unsigned since, const vec3_t start, const vec3_t end )
+{
+	if ( worldChangeCount - since > WORLD_CHANGES )
+	{
+		return true; // some of the changes were forgotten
+	}
+
+	vec3_t mins, maxs;
+
+	// same margin as in G_CM_Trace
+	for ( int i = 0; i < 3; i++ )
+	{
+		mins[ i ] = std::min( start[ i ], end[ i ] ) - 1;
+		maxs[ i ] = std::max( start[ i ], end[ i ] ) + 1;
+	}
+
+	for ( unsigned i = since; i != worldChangeCount; i++ )
+	{
+		const worldChange_t &change = worldChanges[ i & ( WORLD_CHANGES - 1 ) ];
+
+		if ( change.mins[ 0 ] <= maxs[ 0 ] && change.mins[ 1 ] <= maxs[ 1 ] && change.mins[ 2 ] <= maxs[ 2 ]
+		     && change.maxs[ 0 ] >= mins[ 0 ] && change.maxs[ 1 ] >= mins[ 1 ] && change.maxs[ 2 ] >= mins[ 2 ] )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+==================
+G_CM_CachedTrace
+
+Same result as G_CM_Trace with point bounds and no skipmask. Line of sight
+checks between the same positions are repeated several times per frame by
+different users, so results are kept and reused until an entity is linked or
+unlinked near the trace.
+==================
+*/
+void G_CM_CachedTrace( trace_t *results, const vec3_t start, const vec3_t end, int passEntityNum, int contentmask )
+{
+	uint32_t bits[ 6 ];
+	memcpy( bits, start, 3 * sizeof( uint32_t ) );
+	memcpy( bits + 3, end, 3 * sizeof( uint32_t ) );
+
+	uint32_t hash = static_cast<uint32_t>( passEntityNum ) * 2654435761u ^ static_cast<uint32_t>( contentmask );
+	for ( uint32_t b : bits )
+	{
+		hash = ( hash ^ b ) * 16777619u;
+	}
+
+	traceCacheEntry_t &entry = traceCache[ ( hash ^ ( hash >> 16 ) ) & ( TRACE_CACHE_SIZE - 1 ) ];
+
+	if ( entry.valid && entry.passEntityNum == passEntityNum && entry.contentmask == contentmask
+	     && !memcmp( entry.start, start, sizeof( entry.start ) ) && !memcmp( entry.end, end, sizeof( entry.end ) )
+	     && level.time - entry.time <= TRACE_CACHE_MAX_AGE && level.time >= entry.time )
+	{
+		if ( entry.changeCount == worldChangeCount )
+		{
+			traceCacheStats.hits++;
+			*results = entry.trace;
+			return;
+		}
+
+		if ( !G_CM_WorldChangedAlong( entry.changeCount, start, end ) )
+		{
+			traceCacheStats.revalidations++;
+			entry.changeCount = worldChangeCount;
+			*results = entry.trace;
+			return;
+		}
+	}
+
+	traceCacheStats.misses++;
+
+	G_CM_Trace( results, start, nullptr, nullptr, end, passEntityNum, contentmask, 0, traceType_t::TT_AABB );
+
+	VectorCopy( start, entry.start );
+	VectorCopy( end, entry.end );
+	entry.passEntityNum = passEntityNum;
+	entry.contentmask = contentmask;
+	entry.changeCount = worldChangeCount;
+	entry.time = level.time;
+	entry.valid = true;
+	entry.trace = *results;
+}
+
+void G_CM_CachedTrace( trace_t *results, const glm::vec3 &start, const glm::vec3 &end, int passEntityNum,
+                       int contentmask )
+{
+	G_CM_CachedTrace( results, GLM4READ( start ), GLM4READ( end ), passEntityNum, contentmask );
+}
+
+class TraceCacheStatsCmd : public Cmd::StaticCmd
+{
+public:
+	TraceCacheStatsCmd() : StaticCmd( "traceCacheStats", 0,
+		"print how often line of sight traces were reused: traceCacheStats [reset]" ) {}
+
+	void Run( const Cmd::Args& args ) const override
+	{
+		if ( args.Argc() == 2 && args.Argv( 1 ) == "reset" )
+		{
+			traceCacheStats = {};
+			return;
+		}
+
+		int total = traceCacheStats.hits + traceCacheStats.revalidations + traceCacheStats.misses;
+		Print( "%d traces: %d reused, %d reused after checking changes nearby, %d traced",
+		       total, traceCacheStats.hits, traceCacheStats.revalidations, traceCacheStats.misses );
+
+		if ( total )
+		{
+			Print( "hit rate: %.1f%%", 100.0f * ( traceCacheStats.hits + traceCacheStats.revalidations ) / total );
+		}
+	}
+};
+static TraceCacheStatsCmd traceCacheStatsRegistration;
+
 static trace2_t ConvertTrace( const trace_t &tr, const vec3_t start, int entityNum )
 {
 	trace2_t result;
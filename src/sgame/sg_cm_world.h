@@ -87,6 +87,35 @@ void G_CM_Trace( trace_t *results, const vec3_t start, const vec3_t mins, const
 
 // passEntityNum, if isn't ENTITYNUM_NONE, will be explicitly excluded from clipping checks
 
+// Point traces sharing a start, such as the line of sight tests of splash
+// damage. The entities that could block them are gathered once for an area
+// containing all the ends, and gathered again if any entity is linked or
+// unlinked meanwhile. Results are the same as G_CM_Trace with point bounds,
+// ENTITYNUM_NONE as passEntityNum and no skipmask; ends outside of the area
+// just fall back to it.
+struct traceBatch_t
+{
+	vec3_t           start;
+	vec3_t           mins, maxs;
+	int              contentmask;
+	int              linkCount;
+	std::vector<int> entities;
+};
+
+void G_CM_BeginTraceBatch( traceBatch_t *batch, const vec3_t start, const vec3_t mins, const vec3_t maxs,
+                           int contentmask );
+void G_CM_BatchTrace( trace_t *results, traceBatch_t *batch, const vec3_t end );
+bool G_CM_BatchTraceClear( traceBatch_t *batch, const vec3_t end );
+
+// Point traces that are repeated between the same positions, such as line of
+// sight checks. Results are kept and reused until an entity is linked or
+// unlinked near the trace, for a few frames at most. Results are the same as
+// G_CM_Trace with point bounds and no skipmask.
+void G_CM_CachedTrace( trace_t *results, const vec3_t start, const vec3_t end, int passEntityNum,
+                       int contentmask );
+void G_CM_CachedTrace( trace_t *results, const glm::vec3 &start, const glm::vec3 &end, int passEntityNum,
+                       int contentmask );
+
 
 // G_Trace2: an alternative to trap_Trace (a.k.a. G_CM_Trace) with different startsolid semantics
 // In a standard trace, if there is a brush/entity/facet that overlaps the starting point but not
@@ -125,6 +154,19 @@ struct trace2_t
 trace2_t G_Trace2( const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end,
 		int passEntityNum, int contentmask, int skipmask, traceType_t type = traceType_t::TT_AABB );
 
+// PVS cluster and area of a point, cached by position
+struct pvsPoint_t
+{
+	int cluster;
+	int area;
+};
+
+pvsPoint_t G_CM_PVSPoint( const vec3_t p );
+
+bool G_CM_ClustersVisible( int cluster1, int cluster2 );
+
+bool G_CM_inPVS( const pvsPoint_t &p1, const pvsPoint_t &p2 );
+
 bool G_CM_inPVS( const vec3_t p1, const vec3_t p2 );
 
 bool G_CM_inPVSIgnorePortals( const vec3_t p1, const vec3_t p2 );
@@ -703,6 +703,7 @@ static void Cmd_Give_f( gentity_t *ent )
 			if ( team == TEAM_HUMANS )
 			{
 				BG_AddUpgradeToInventory( UP_MEDKIT, ent->client->ps.stats );
+				EquipmentCensus::Update( ent );
 			}
 		}
 		else
@@ -2678,6 +2679,7 @@ static void Cmd_Sell_f( gentity_t *ent )
 	{
 		ClientUserinfoChanged( ent->client->ps.clientNum, false );
 		ent->client->pers.infoChangeTime = level.time;
+		EquipmentCensus::Update( ent );
 	}
 }
 
@@ -2964,6 +2966,7 @@ static void Cmd_Buy_f( gentity_t *ent )
 	{
 		ClientUserinfoChanged( ent->client->ps.clientNum, false );
 		ent->client->pers.infoChangeTime = level.time;
+		EquipmentCensus::Update( ent );
 	}
 }
 
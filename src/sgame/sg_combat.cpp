@@ -28,6 +28,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "sg_local.h"
 #include "Entities.h"
 #include "CBSE.h"
+#include "sg_cm_world.h"
+#include "shared/Timing.h"
 
 Cvar::Cvar<float> g_rewardDestruction( "g_rewardDestruction", "Reward players when they destroy a building by momentum * g_rewardDestruction", Cvar::NONE, 10.f );
 // damage region data
@@ -740,6 +742,8 @@ void G_PlayerDie( gentity_t *self, gentity_t *inflictor, gentity_t *attacker, in
 	trap_LinkEntity( self );
 
 	self->client->pers.infoChangeTime = level.time;
+
+	EquipmentCensus::Update( self );
 }
 
 static int ParseDmgScript( damageRegion_t *regions, const char *buf )
@@ -956,6 +960,30 @@ void G_SelectiveDamage( gentity_t *targ, gentity_t * /*inflictor*/, gentity_t *a
 	}
 }
 
+/**
+ * @brief Points that G_CanDamage traces to, in order: the midpoint of the
+ *        target's bounds, then four points around it.
+ */
+static void G_CanDamageProbes( const gentity_t *targ, vec3_t probes[ 5 ] )
+{
+	static const float offsets[ 5 ][ 2 ] = { { 0, 0 }, { 15, 15 }, { 15, -15 }, { -15, 15 }, { -15, -15 } };
+	vec3_t midpoint;
+
+	// use the midpoint of the bounds instead of the origin, because
+	// bmodels may have their origin is 0,0,0
+	VectorAdd( targ->r.absmin, targ->r.absmax, midpoint );
+	VectorScale( midpoint, 0.5, midpoint );
+
+	// this should probably check in the plane of projection,
+	// rather than in world coordinate, and also include Z
+	for ( int i = 0; i < 5; i++ )
+	{
+		VectorCopy( midpoint, probes[ i ] );
+		probes[ i ][ 0 ] += offsets[ i ][ 0 ];
+		probes[ i ][ 1 ] += offsets[ i ][ 1 ];
+	}
+}
+
 /**
  * @brief Used for explosions and melee attacks.
  * @param targ
@@ -964,68 +992,188 @@ void G_SelectiveDamage( gentity_t *targ, gentity_t * /*inflictor*/, gentity_t *a
  */
 bool G_CanDamage( gentity_t *targ, const vec3_t origin )
 {
-	vec3_t  dest;
+	vec3_t  probes[ 5 ];
 	trace_t tr;
-	vec3_t  midpoint;
 
-	// use the midpoint of the bounds instead of the origin, because
-	// bmodels may have their origin is 0,0,0
-	VectorAdd( targ->r.absmin, targ->r.absmax, midpoint );
-	VectorScale( midpoint, 0.5, midpoint );
+	G_CanDamageProbes( targ, probes );
 
-	VectorCopy( midpoint, dest );
-	trap_Trace( &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID, 0 );
+	G_CM_CachedTrace( &tr, origin, probes[ 0 ], ENTITYNUM_NONE, MASK_SOLID );
 
 	if ( tr.fraction == 1.0  || tr.entityNum == targ->num() )
 	{
 		return true;
 	}
 
-	// this should probably check in the plane of projection,
-	// rather than in world coordinate, and also include Z
-	VectorCopy( midpoint, dest );
-	dest[ 0 ] += 15.0;
-	dest[ 1 ] += 15.0;
-	trap_Trace( &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID, 0 );
-
-	if ( tr.fraction == 1.0 )
+	for ( int i = 1; i < 5; i++ )
 	{
-		return true;
+		G_CM_CachedTrace( &tr, origin, probes[ i ], ENTITYNUM_NONE, MASK_SOLID );
+
+		if ( tr.fraction == 1.0 )
+		{
+			return true;
+		}
 	}
 
-	VectorCopy( midpoint, dest );
-	dest[ 0 ] += 15.0;
-	dest[ 1 ] -= 15.0;
-	trap_Trace( &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID, 0 );
+	return false;
+}
+
+/**
+ * @brief Prepares the line of sight tests of a splash at origin against the
+ *        listed entities, so that they share one search for blocking entities.
+ */
+static void G_BeginSplashTraces( traceBatch_t *batch, const vec3_t origin,
+                                 const int *entityList, int numListedEntities )
+{
+	vec3_t mins, maxs;
+	vec3_t probes[ 5 ];
+
+	VectorCopy( origin, mins );
+	VectorCopy( origin, maxs );
 
-	if ( tr.fraction == 1.0 )
+	for ( int e = 0; e < numListedEntities; e++ )
 	{
-		return true;
+		G_CanDamageProbes( &g_entities[ entityList[ e ] ], probes );
+
+		for ( const vec3_t &probe : probes )
+		{
+			AddPointToBounds( probe, mins, maxs );
+		}
 	}
 
-	VectorCopy( midpoint, dest );
-	dest[ 0 ] -= 15.0;
-	dest[ 1 ] += 15.0;
-	trap_Trace( &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID, 0 );
+	G_CM_BeginTraceBatch( batch, origin, mins, maxs, MASK_SOLID );
+}
+
+/**
+ * @brief G_CanDamage from the start of the batch, with the same result.
+ */
+static bool G_CanDamageBatched( gentity_t *targ, traceBatch_t *batch )
+{
+	vec3_t  probes[ 5 ];
+	trace_t tr;
+	bool    result = false;
+
+	G_CanDamageProbes( targ, probes );
+
+	G_CM_BatchTrace( &tr, batch, probes[ 0 ] );
 
-	if ( tr.fraction == 1.0 )
+	if ( tr.fraction == 1.0 || tr.entityNum == targ->num() )
 	{
-		return true;
+		result = true;
 	}
 
-	VectorCopy( midpoint, dest );
-	dest[ 0 ] -= 15.0;
-	dest[ 1 ] -= 15.0;
-	trap_Trace( &tr, origin, vec3_origin, vec3_origin, dest, ENTITYNUM_NONE, MASK_SOLID, 0 );
+	// the other probes only need to know whether anything is in the way
+	for ( int i = 1; i < 5 && !result; i++ )
+	{
+		result = G_CM_BatchTraceClear( batch, probes[ i ] );
+	}
 
-	if ( tr.fraction == 1.0 )
+#ifndef NDEBUG
+	if ( result != G_CanDamage( targ, batch->start ) )
 	{
-		return true;
+		Log::Warn( "Batched line of sight to %s disagrees with G_CanDamage.", etos( targ ) );
 	}
+#endif
 
-	return false;
+	return result;
 }
 
+/*
+=======================
+CanDamageTestCmd
+
+Checks that the batched line of sight tests of splash damage give the same
+results as G_CanDamage for every entity in range of a point, and times both.
+=======================
+*/
+class CanDamageTestCmd : public Cmd::StaticCmd
+{
+public:
+	CanDamageTestCmd() : StaticCmd( "canDamageTest", 0,
+		"compare the batched splash damage traces with G_CanDamage: canDamageTest <x> <y> <z> [radius] [iterations]" ) {}
+
+	void Run( const Cmd::Args& args ) const override
+	{
+		if ( args.Argc() < 4 )
+		{
+			PrintUsage( args, "<x> <y> <z> [radius] [iterations]" );
+			return;
+		}
+
+		vec3_t origin;
+		for ( int i = 0; i < 3; i++ )
+		{
+			origin[ i ] = atof( args.Argv( i + 1 ).c_str() );
+		}
+
+		float radius = args.Argc() > 4 ? std::max( atof( args.Argv( 4 ).c_str() ), 1.0 ) : 500.0f;
+		int iterations = args.Argc() > 5 ? std::max( atoi( args.Argv( 5 ).c_str() ), 1 ) : 100;
+
+		vec3_t mins, maxs;
+		for ( int i = 0; i < 3; i++ )
+		{
+			mins[ i ] = origin[ i ] - radius;
+			maxs[ i ] = origin[ i ] + radius;
+		}
+
+		int entityList[ MAX_GENTITIES ];
+		int numListedEntities = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+		std::vector<gentity_t *> targets;
+
+		for ( int e = 0; e < numListedEntities; e++ )
+		{
+			gentity_t *ent = &g_entities[ entityList[ e ] ];
+
+			if ( G_DistanceToBBox( VEC2GLM( origin ), ent ) < radius )
+			{
+				targets.push_back( ent );
+			}
+		}
+
+		std::vector<bool> expected( targets.size() );
+		std::vector<bool> batched( targets.size() );
+
+		auto start = Timing::Now();
+		for ( int n = 0; n < iterations; n++ )
+		{
+			for ( size_t i = 0; i < targets.size(); i++ )
+			{
+				expected[ i ] = G_CanDamage( targets[ i ], origin );
+			}
+		}
+		int serialUsec = Timing::Elapsed( start );
+
+		start = Timing::Now();
+		for ( int n = 0; n < iterations; n++ )
+		{
+			traceBatch_t traces;
+			G_BeginSplashTraces( &traces, origin, entityList, numListedEntities );
+
+			for ( size_t i = 0; i < targets.size(); i++ )
+			{
+				batched[ i ] = G_CanDamageBatched( targets[ i ], &traces );
+			}
+		}
+		int batchedUsec = Timing::Elapsed( start );
+
+		int mismatches = 0;
+		for ( size_t i = 0; i < targets.size(); i++ )
+		{
+			if ( expected[ i ] != batched[ i ] )
+			{
+				Print( "^1%s: G_CanDamage says %s, the batch says %s", etos( targets[ i ] ),
+				       expected[ i ] ? "visible" : "hidden", batched[ i ] ? "visible" : "hidden" );
+				mismatches++;
+			}
+		}
+
+		Print( "%d targets in range, %d iterations, %d mismatches",
+		       static_cast<int>( targets.size() ), iterations, mismatches );
+		Print( "G_CanDamage: %d us", serialUsec / iterations );
+		Print( "batched:     %d us", batchedUsec / iterations );
+	}
+};
+static CanDamageTestCmd canDamageTestRegistration;
+
 bool G_SelectiveRadiusDamage( const vec3_t origin, gentity_t *attacker, float damage,
                                   float radius, gentity_t *ignore, int mod, int ignoreTeam )
 {
@@ -1050,6 +1198,9 @@ bool G_SelectiveRadiusDamage( const vec3_t origin, gentity_t *attacker, float da
 
 	numListedEntities = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
 
+	traceBatch_t traces;
+	G_BeginSplashTraces( &traces, origin, entityList, numListedEntities );
+
 	for ( e = 0; e < numListedEntities; e++ )
 	{
 		ent = &g_entities[ entityList[ e ] ];
@@ -1074,7 +1225,7 @@ bool G_SelectiveRadiusDamage( const vec3_t origin, gentity_t *attacker, float da
 
 		points = damage * ( 1.0 - dist / radius );
 
-		if ( G_CanDamage( ent, origin ) && ent->client &&
+		if ( G_CanDamageBatched( ent, &traces ) && ent->client &&
 		     ent->client->pers.team != ignoreTeam )
 		{
 			hitClient = ent->Damage(points, attacker, VEC2GLM( origin ), Util::nullopt,
@@ -1110,6 +1261,9 @@ bool G_RadiusDamage( const vec3_t origin, gentity_t *attacker, float damage,
 
 	numListedEntities = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
 
+	traceBatch_t traces;
+	G_BeginSplashTraces( &traces, origin, entityList, numListedEntities );
+
 	for ( e = 0; e < numListedEntities; e++ )
 	{
 		ent = &g_entities[ entityList[ e ] ];
@@ -1129,7 +1283,7 @@ bool G_RadiusDamage( const vec3_t origin, gentity_t *attacker, float damage,
 
 		points = damage * ( 1.0 - dist / radius );
 
-		if ( G_CanDamage( ent, origin ) )
+		if ( G_CanDamageBatched( ent, &traces ) )
 		{
 			if ( testHit == TEAM_NONE )
 			{
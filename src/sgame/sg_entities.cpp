@@ -179,10 +179,15 @@ void G_FreeEntity( gentity_t *entity )
 
 	G_BotRemoveObstacle( entity->num() );
 
-	if ( entity->s.eType == entityType_t::ET_BEACON && entity->s.modelindex == BCT_TAG )
+	if ( entity->s.eType == entityType_t::ET_BEACON )
 	{
-		// It's possible that this happened before, but we need to be sure.
-		BaseClustering::Remove(entity);
+		Beacon::Unregister( entity );
+
+		if ( entity->s.modelindex == BCT_TAG )
+		{
+			// It's possible that this happened before, but we need to be sure.
+			BaseClustering::Remove(entity);
+		}
 	}
 
 	if ( entity->id != nullptr )
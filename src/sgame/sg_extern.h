@@ -58,6 +58,7 @@ extern  Cvar::Range<Cvar::Cvar<int>> g_gravity;
 extern Cvar::Cvar<float> g_speed;
 extern Cvar::Cvar<std::string> g_inactivity;
 extern Cvar::Cvar<int> g_debugMove;
+extern Cvar::Range<Cvar::Cvar<int>> g_workerThreads;
 extern Cvar::Cvar<bool> g_debugFire;
 extern Cvar::Cvar<std::string> g_motd;
 extern Cvar::Cvar<int> g_warmup;
@@ -33,6 +33,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "botlib/bot_api.h"
 #include "common/FileSystem.h"
 #include "lua/Interpreter.h"
+#include "shared/Timing.h"
 
 #define INTERMISSION_DELAY_TIME 1000
 
@@ -71,6 +72,10 @@ Cvar::Cvar<bool> g_lockTeamsAtStart("g_lockTeamsAtStart", "(internal use) lock t
 Cvar::Cvar<std::string> g_logFile("g_logFile", "sgame log file, relative to <homepath>/game/", Cvar::NONE, "games.log");
 Cvar::Cvar<int> g_logGameplayStatsFrequency("g_logGameplayStatsFrequency", "log gameplay stats every x seconds", Cvar::NONE, 10);
 Cvar::Cvar<bool> g_logFileSync("g_logFileSync", "flush g_logFile on every write", Cvar::NONE, false);
+Cvar::Cvar<int> g_randomSeed("g_randomSeed", "if not 0, seed for the game's random numbers instead of a random one, for reproducible benchmarks", Cvar::NONE, 0);
+Cvar::Range<Cvar::Cvar<int>> g_workerThreads(
+	"g_workerThreads", "number of threads helping the main thread with parallel work, 0 to disable",
+	Cvar::NONE, std::max(0, std::min(3, int(std::thread::hardware_concurrency()) - 1)), 0, 32);
 Cvar::Cvar<bool> g_allowVote("g_allowVote", "whether votes of any kind are allowed", Cvar::NONE, true);
 Cvar::Cvar<int> g_voteLimit("g_voteLimit", "max votes per player per round", Cvar::NONE, 5);
 Cvar::Cvar<int> g_extendVotesPercent("g_extendVotesPercent", "percentage required for extend timelimit vote", Cvar::NONE, 74);
@@ -474,6 +479,14 @@ G_InitGame
 */
 void G_InitGame( int levelTime, int randomSeed, bool inClient )
 {
+	if ( g_randomSeed.Get() )
+	{
+		randomSeed = g_randomSeed.Get();
+	}
+
+	// a replay brings its own
+	Replay::Init( levelTime, randomSeed );
+
 	srand( randomSeed );
 
 	Log::Notice( "------- Game Initialization -------" );
@@ -569,6 +582,10 @@ void G_InitGame( int levelTime, int randomSeed, bool inClient )
 	}
 	level.gentities = g_entities;
 
+	BuildableCensus::Init();
+	EquipmentCensus::Init();
+	Beacon::Init();
+
 	// initialize special entities
 	G_InitGentityMinimal( g_entities + ENTITYNUM_NONE );
 	G_InitGentityMinimal( g_entities + ENTITYNUM_WORLD );
@@ -741,6 +758,9 @@ static Cvar::Cvar<bool> g_pedanticShutdown(
 #endif // !BUILD_VM_IN_PROCESS
 void G_ShutdownGame( int /* restart */ )
 {
+	// before anything is torn down, as the state hash is recorded
+	Replay::Shutdown();
+
 	// in case of a map_restart
 	G_ClearVotes( true );
 	trap_SetConfigstring( CS_WINNER, "" );
@@ -751,6 +771,7 @@ void G_ShutdownGame( int /* restart */ )
 	{
 		G_LogPrintf( "ShutdownGame:" );
 		G_LogPrintf( "------------------------------------------------------------" );
+		G_LogFlush();
 		trap_FS_FCloseFile( level.logFile );
 		level.logFile = 0;
 	}
@@ -1564,6 +1585,64 @@ void G_AdminMessage( gentity_t *ent, const char *msg )
 	             msg );
 }
 
+// Lines for g_logFile are collected here and written once per frame instead
+// of with two writes each. Past the limit they are written right away.
+static std::string logBuffer;
+static const size_t LOG_BUFFER_LIMIT = 64 * 1024;
+
+static struct {
+	int lines;        // lines logged
+	int delayed;      // lines written at the next flush rather than right away
+	int flushes;      // writes to the log file
+	int earlyFlushes; // flushes because the buffer was full
+	int lostBytes;    // bytes that the file system didn't accept
+} logStats;
+
+/*
+=================
+G_LogFlush
+
+Write the buffered log lines to the logfile.
+=================
+*/
+void G_LogFlush()
+{
+	if ( logBuffer.empty() )
+	{
+		return;
+	}
+
+	if ( level.logFile )
+	{
+		int size = static_cast<int>( logBuffer.size() );
+		int written = trap_FS_Write( logBuffer.data(), size, level.logFile );
+
+		if ( written < size )
+		{
+			logStats.lostBytes += size - std::max( written, 0 );
+		}
+
+		logStats.flushes++;
+	}
+
+	logBuffer.clear();
+}
+
+class GameLogStatsCmd : public Cmd::StaticCmd
+{
+public:
+	GameLogStatsCmd() : StaticCmd( "gameLogStats", 0, "print statistics about writes to g_logFile" ) {}
+
+	void Run( const Cmd::Args& ) const override
+	{
+		Print( "lines: %d (%d delayed to the end of a frame)", logStats.lines, logStats.delayed );
+		Print( "writes: %d (%d because the buffer was full)", logStats.flushes, logStats.earlyFlushes );
+		Print( "bytes lost: %d", logStats.lostBytes );
+		Print( "buffered: %d bytes", static_cast<int>( logBuffer.size() ) );
+	}
+};
+static GameLogStatsCmd gameLogStatsRegistration;
+
 /*
 =================
 G_LogPrintf
@@ -1606,8 +1685,23 @@ void PRINTF_LIKE(1) G_LogPrintf( const char *fmt, ... )
 	}
 
 	Color::StripColors( string, decolored, sizeof( decolored ) );
-	trap_FS_Write( decolored, strlen( decolored ), level.logFile );
-    trap_FS_Write( "\n", 1, level.logFile );
+	logBuffer += decolored;
+	logBuffer += '\n';
+	logStats.lines++;
+
+	if ( g_logFileSync.Get() )
+	{
+		G_LogFlush();
+	}
+	else if ( logBuffer.size() >= LOG_BUFFER_LIMIT )
+	{
+		logStats.earlyFlushes++;
+		G_LogFlush();
+	}
+	else
+	{
+		logStats.delayed++;
+	}
 }
 
 /*
@@ -2181,6 +2275,156 @@ static void G_EvaluateAcceleration( gentity_t *ent, int msec )
 	VectorCopy( ent->acceleration, ent->oldAccel );
 }
 
+/*
+================
+Frame timings
+
+How long each G_RunFrame took, for benchmarking the server game. Frames are
+only timed from "frameStats start", or during a replay. Only a bounded number
+of frames is kept; the ones past it are counted.
+================
+*/
+struct frameTime_t
+{
+	int levelTime;
+	int usec;
+};
+
+static const size_t MAX_FRAME_TIMES = 1 << 18;
+static std::vector<frameTime_t> frameTimes;
+static int droppedFrameTimes;
+static bool recordFrameTimes;
+
+/*
+================
+G_RecordFrameTimes
+
+Starts timing frames, forgetting the previous ones, or stops
+================
+*/
+void G_RecordFrameTimes( bool record )
+{
+	if ( record )
+	{
+		frameTimes.clear();
+		droppedFrameTimes = 0;
+	}
+
+	recordFrameTimes = record;
+}
+
+struct frameTimer_t
+{
+	int levelTime;
+	bool recording = recordFrameTimes;
+	Timing::TimePoint start = recording ? Timing::Now() : Timing::TimePoint();
+
+	~frameTimer_t()
+	{
+		if ( !recording )
+		{
+			return;
+		}
+
+		if ( frameTimes.size() == MAX_FRAME_TIMES )
+		{
+			droppedFrameTimes++;
+			return;
+		}
+
+		frameTimes.push_back( { levelTime, Timing::Elapsed( start ) } );
+	}
+};
+
+class FrameStatsCmd : public Cmd::StaticCmd
+{
+public:
+	FrameStatsCmd() : StaticCmd( "frameStats", 0,
+		"print how long server frames took: frameStats [start | stop | reset | write <file>]" ) {}
+
+	void Run( const Cmd::Args& args ) const override
+	{
+		if ( args.Argc() == 2 && args.Argv( 1 ) == "start" )
+		{
+			G_RecordFrameTimes( true );
+			return;
+		}
+
+		if ( args.Argc() == 2 && args.Argv( 1 ) == "stop" )
+		{
+			G_RecordFrameTimes( false );
+			return;
+		}
+
+		if ( args.Argc() == 2 && args.Argv( 1 ) == "reset" )
+		{
+			frameTimes.clear();
+			droppedFrameTimes = 0;
+			return;
+		}
+
+		if ( args.Argc() == 3 && args.Argv( 1 ) == "write" )
+		{
+			Write( args.Argv( 2 ) );
+			return;
+		}
+
+		if ( args.Argc() != 1 )
+		{
+			PrintUsage( args, "[start | stop | reset | write <file>]" );
+			return;
+		}
+
+		if ( frameTimes.empty() )
+		{
+			Print( "No frames recorded" );
+			return;
+		}
+
+		std::vector<int> sorted;
+		int64_t total = 0;
+		for ( const frameTime_t &frame : frameTimes )
+		{
+			sorted.push_back( frame.usec );
+			total += frame.usec;
+		}
+		std::sort( sorted.begin(), sorted.end() );
+
+		auto percentile = [&]( int p ) {
+			return sorted[ std::min( sorted.size() - 1, sorted.size() * p / 100 ) ];
+		};
+
+		Print( "%d frames (%d not recorded)", static_cast<int>( sorted.size() ), droppedFrameTimes );
+		Print( "average %d us, median %d us, 95%% %d us, 99%% %d us, max %d us",
+		       static_cast<int>( total / static_cast<int64_t>( sorted.size() ) ),
+		       percentile( 50 ), percentile( 95 ), percentile( 99 ), sorted.back() );
+	}
+
+private:
+	void Write( const std::string &filename ) const
+	{
+		fileHandle_t f;
+
+		if ( trap_FS_FOpenFile( filename.c_str(), &f, fsMode_t::FS_WRITE ) < 0 || !f )
+		{
+			Print( "Couldn't open %s", filename );
+			return;
+		}
+
+		std::string text = "levelTime usec\n";
+		for ( const frameTime_t &frame : frameTimes )
+		{
+			text += Str::Format( "%d %d\n", frame.levelTime, frame.usec );
+		}
+
+		trap_FS_Write( text.data(), text.size(), f );
+		trap_FS_FCloseFile( f );
+
+		Print( "Wrote %d frame times to %s", static_cast<int>( frameTimes.size() ), filename );
+	}
+};
+static FrameStatsCmd frameStatsRegistration;
+
 /*
 ================
 G_RunFrame
@@ -2194,6 +2438,10 @@ void G_RunFrame( int levelTime )
 	gentity_t  *ent;
 	int        msec;
 	static int ptime3000 = 0;
+	frameTimer_t frameTimer{ levelTime };
+
+	// write what was logged since the last frame, including by commands
+	G_LogFlush();
 
 	// if we are waiting for the level to restart, do nothing
 	if ( level.restarted )
@@ -2269,8 +2517,6 @@ void G_RunFrame( int levelTime )
 
 	G_CheckPmoveParamChanges();
 
-	std::array<int, BA_NUM_BUILDABLES> numBuildables = {};
-
 	// go through all allocated objects
 	ent = &g_entities[ 0 ];
 	for ( i = 0; i < level.num_entities; i++, ent++ )
@@ -2313,7 +2559,6 @@ void G_RunFrame( int levelTime )
 				// TODO: Do buildables make any use of G_Physics' functionality apart from the call
 				//       to G_RunThink?
 				G_Physics( ent );
-				numBuildables[ ent->s.modelindex ]++;
 				continue;
 
 			case entityType_t::ET_CORPSE:
@@ -2390,6 +2635,7 @@ void G_RunFrame( int levelTime )
 	G_SpawnClients( TEAM_HUMANS );
 	G_UpdateZaps( msec );
 	Beacon::Frame( );
+	Lua::Frame( level.time );
 
 	G_PrepareEntityNetCode();
 
@@ -2414,7 +2660,10 @@ void G_RunFrame( int levelTime )
 	BotDebugDrawMesh();
 	G_BotUpdateObstacles();
 
-	level.numBuildablesEstimate = numBuildables;
+#ifndef NDEBUG
+	BuildableCensus::Verify();
+	EquipmentCensus::Verify();
+#endif
 }
 
 void G_PrepareEntityNetCode() {
@@ -33,6 +33,7 @@ void              G_UnlaggedClear( gentity_t *ent );
 void              G_UnlaggedCalc( int time, gentity_t *skipEnt );
 void              G_UnlaggedOn( gentity_t *attacker, const vec3_t muzzle, float range );
 void              G_UnlaggedOff();
+void              G_GetUsercmd( int clientNum, usercmd_t *cmd );
 void              ClientThink( int clientNum );
 void              ClientEndFrame( gentity_t *ent );
 void              G_RunClient( gentity_t *ent );
@@ -45,6 +46,8 @@ const char        *G_quoted_admin_name( gentity_t *ent );
 // Beacon.cpp
 namespace Beacon
 {
+	void Init();
+	void Unregister( gentity_t *ent );
 	void Frame();
 	void Move( gentity_t *ent, glm::vec3 const& origin );
 	gentity_t *New( glm::vec3 const& origin, beaconType_t type, int data, team_t team,
@@ -68,6 +71,54 @@ namespace Beacon
 	void DeleteTags( gentity_t *ent );
 }
 
+// BuildableCensus.cpp
+namespace BuildableCensus
+{
+	enum state_t
+	{
+		CONSTRUCTING,
+		CONSTRUCTED,
+		DEAD,
+
+		NUM_STATES
+	};
+
+	struct entry_t
+	{
+		state_t state;
+		bool    powered;
+	};
+
+	void Init();
+	void Add( gentity_t *ent, entry_t entry );
+	void Update( gentity_t *ent, entry_t from, entry_t to );
+	void Remove( gentity_t *ent, entry_t entry );
+	void AddMainBuildable( gentity_t *ent );
+	void RemoveMainBuildable( gentity_t *ent );
+	int Count( team_t team, buildable_t buildable, state_t state );
+	int CountAlive( team_t team, buildable_t buildable );
+	int CountActive( team_t team, buildable_t buildable );
+	int AliveBuildPoints( team_t team );
+	int UnpoweredBuildPoints( team_t team );
+	gentity_t *Find( buildable_t buildable );
+	gentity_t *MainBuildable( team_t team );
+	gentity_t *ActiveMainBuildable( team_t team );
+	bool Verify();
+}
+
+// EquipmentCensus.cpp
+namespace EquipmentCensus
+{
+	void Init();
+	void Update( const gentity_t *ent );
+	int CountClass( team_t team, class_t cls, const gentity_t *except = nullptr );
+	int CountWeapon( team_t team, weapon_t weapon, const gentity_t *except = nullptr );
+	int CountUpgrade( team_t team, upgrade_t upgrade, const gentity_t *except = nullptr );
+	int CountBots( team_t team );
+	int CountBotsWithWeapon( team_t team, weapon_t weapon, const gentity_t *except = nullptr );
+	bool Verify();
+}
+
 // sg_buildable.c
 bool              G_IsWarnableMOD(meansOfDeath_t mod);
 gentity_t         *G_Overmind();
@@ -220,6 +271,7 @@ void              FindIntermissionPoint();
 void              G_RunThink( gentity_t *ent );
 void              G_AdminMessage( gentity_t *ent, const char *string );
 void              G_LogPrintf( const char *fmt, ... ) PRINTF_LIKE(1);
+void              G_LogFlush();
 void              SendScoreboardMessageToAllClients();
 void              G_Vote( gentity_t *ent, team_t team, bool voting );
 void              G_ResetVote( team_t team );
@@ -228,6 +280,7 @@ void              G_CheckVote( team_t team );
 void              LogExit( const char *string );
 void              G_InitGame( int levelTime, int randomSeed, bool inClient );
 void              G_RunFrame( int levelTime );
+void              G_RecordFrameTimes( bool record );
 void              G_ShutdownGame( int restart );
 void              G_CheckPmoveParamChanges();
 void              G_SendClientPmoveParams(int client);
@@ -263,6 +316,34 @@ void              G_namelog_cleanup();
 // sg_physcis.c
 void              G_Physics( gentity_t *ent );
 
+// sg_replay.cpp
+namespace Replay
+{
+	// Counts the calls from the engine being handled, to tell its inputs
+	// from its answers to the calls of the game.
+	class EngineCall
+	{
+	public:
+		EngineCall();
+		~EngineCall();
+	};
+
+	void Init( int &levelTime, int &randomSeed );
+	void Shutdown();
+	bool Ignores();
+	void RecordConnect( int clientNum, bool firstTime, bool isBot );
+	void RecordBegin( int clientNum );
+	void RecordUserinfoChanged( int clientNum );
+	void RecordDisconnect( int clientNum );
+	void RecordClientCommand( int clientNum, Str::StringRef command );
+	void RecordConsoleCommand();
+	void RecordUsercmd( int clientNum );
+	void RecordFrame( int levelTime );
+	void RunFrame();
+	bool Pubkey( int clientNum, char *pubkey, int size );
+	bool Usercmd( int clientNum, usercmd_t *cmd );
+}
+
 // sg_session.c
 void              G_ReadSessionData( gclient_t *client );
 void              G_InitSessionData( gclient_t *client );
@@ -272,6 +353,7 @@ void              G_WriteSessionData();
 bool          ConsoleCommand();
 void              G_RegisterCommands();
 void              G_UnregisterCommands();
+uint64_t          G_StateHash();
 
 // sg_team.c
 bool              G_TeamFromString( const char *str, team_t &team );
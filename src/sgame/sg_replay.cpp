@@ -0,0 +1,798 @@
+/*
+===========================================================================
+
+Unvanquished GPL Source Code
+Copyright (C) 2024 Unvanquished Developers
+
+This file is part of the Unvanquished GPL Source Code (Unvanquished Source Code).
+
+Unvanquished is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Unvanquished is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Unvanquished. If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+
+
+// sg_replay.cpp
+// records the inputs the engine gives to the server game, and replays them in
+// place of the engine's, to benchmark the server game on a real match
+
+#include "common/Common.h"
+#include "sg_local.h"
+
+static Log::Logger replayLogger( "sgame.replay" );
+
+/*
+================
+Input recordings
+
+A recording holds what the engine feeds the game from the time the map is
+loaded: the level time and random seed, client connections, userinfo, client
+and console commands, usercmds, pings and the values of the cvars listed in
+g_replayCvars. Replaying it with the same build and map simulates the same
+game: each engine frame runs the next recorded frame, and the engine's own
+inputs are ignored. When the recording ends, the state hash is compared with
+the one at the end of the recorded game.
+
+Only the calls the engine makes on its own are inputs. The ones it makes while
+the game is calling it, such as the disconnection that follows trap_DropClient,
+happen again by themselves when replaying. Commands the game sends to the
+console are also executed by the engine later, and are recorded then.
+
+Replayed clients get their slot from trap_BotAllocateClient, so that the
+engine doesn't expect a network connection for them; the replay stops if the
+engine gives a different slot than in the recording. The engine doesn't get
+their usercmds either, so the game asks G_GetUsercmd for them, which answers
+with the last recorded one, as the engine would. Cvar changes are only
+seen at the next frame. Anything depending on wall time, such as
+g_bot_thinkBudget, makes the replay diverge.
+
+Each line of a recording is an event: a name, some numbers and possibly a
+string, which takes the rest of the line.
+================
+*/
+
+static Cvar::Cvar<std::string> g_recordInputs( "g_recordInputs",
+		"record the inputs of the game into this file, from when the map is loaded", Cvar::NONE, "" );
+static Cvar::Cvar<std::string> g_replayInputs( "g_replayInputs",
+		"replay the inputs recorded in this file instead of the engine's, when the map is loaded", Cvar::NONE, "" );
+static Cvar::Cvar<std::string> g_replayCvars( "g_replayCvars",
+		"cvars whose values are recorded with the inputs of the game", Cvar::NONE,
+		"timelimit g_speed g_gravity g_freeFundPeriod g_momentumHalfLife g_alienAllowBuilding g_humanAllowBuilding "
+		"g_bot_defaultFill g_bot_buildAliens g_bot_buildHumans g_bot_infiniteFunds" );
+static Cvar::Cvar<std::string> g_replayEndCommand( "g_replayEndCommand",
+		"console command run when a replay ends", Cvar::NONE, "" );
+
+static const int REPLAY_VERSION = 1;
+
+namespace Replay {
+	static int  engineCalls; // nesting of the calls from the engine being handled
+	static bool injecting;   // running a recorded input
+
+	static struct
+	{
+		fileHandle_t file;
+		std::string  buffer; // written out every frame
+		std::vector<std::pair<std::string, std::string>> cvars; // with their last recorded value
+		int          pings[ MAX_CLIENTS ];
+	} record;
+
+	static struct
+	{
+		bool        active;
+		bool        finished; // the game is frozen at the end of the recording
+		std::vector<std::string> lines;
+		size_t      nextLine;
+		int         pings[ MAX_CLIENTS ];
+		std::string pubkeys[ MAX_CLIENTS ];
+		bool        replayedCmds[ MAX_CLIENTS ]; // the usercmds come from the recording
+		usercmd_t   usercmds[ MAX_CLIENTS ];
+	} replay;
+
+	EngineCall::EngineCall()
+	{
+		engineCalls++;
+	}
+
+	EngineCall::~EngineCall()
+	{
+		engineCalls--;
+	}
+
+	// Whether the game is handling an input of the engine, rather than its
+	// answer to a call of the game.
+	static bool FromEngine()
+	{
+		return engineCalls == 1 && !injecting;
+	}
+
+	bool Ignores()
+	{
+		return replay.active && FromEngine();
+	}
+
+	static bool Recording()
+	{
+		return record.file && FromEngine();
+	}
+
+	/*
+	================
+	Recording
+	================
+	*/
+
+	// Reads the fields of an event one after the other.
+	class EventReader
+	{
+	public:
+		EventReader( const std::string &line ) : line( line ), pos( 0 ) {}
+
+		std::string Word()
+		{
+			size_t end = std::min( line.find( ' ', pos ), line.size() );
+			std::string word = line.substr( pos, end - pos );
+			pos = std::min( end + 1, line.size() );
+			return word;
+		}
+
+		int Int()
+		{
+			return atoi( Word().c_str() );
+		}
+
+		bool AtEnd() const
+		{
+			return pos >= line.size();
+		}
+
+		std::string Rest()
+		{
+			std::string rest = line.substr( pos );
+			pos = line.size();
+			return rest;
+		}
+
+	private:
+		const std::string &line;
+		size_t pos;
+	};
+
+
+	static void Write( const std::string &event )
+	{
+		record.buffer += event;
+		record.buffer += '\n';
+	}
+
+	// Events only hold one line, and the last string takes the rest of it.
+	static std::string Line( const std::string &text )
+	{
+		std::string line = text;
+		std::replace( line.begin(), line.end(), '\n', ' ' );
+		return line;
+	}
+
+	static std::string Userinfo( int clientNum )
+	{
+		char userinfo[ MAX_INFO_STRING ];
+		trap_GetUserinfo( clientNum, userinfo, sizeof( userinfo ) );
+		return userinfo;
+	}
+
+	static std::string ToHex( const void *data, size_t size )
+	{
+		static const char digits[] = "0123456789abcdef";
+		const byte *bytes = static_cast<const byte *>( data );
+		std::string hex;
+
+		for ( size_t i = 0; i < size; i++ )
+		{
+			hex += digits[ bytes[ i ] >> 4 ];
+			hex += digits[ bytes[ i ] & 15 ];
+		}
+
+		return hex;
+	}
+
+	static int HexValue( char c )
+	{
+		if ( c >= '0' && c <= '9' ) return c - '0';
+		if ( c >= 'a' && c <= 'f' ) return c - 'a' + 10;
+		return -1;
+	}
+
+	static bool FromHex( const std::string &hex, void *data, size_t size )
+	{
+		byte *bytes = static_cast<byte *>( data );
+
+		if ( hex.size() != 2 * size )
+		{
+			return false;
+		}
+
+		for ( size_t i = 0; i < size; i++ )
+		{
+			int high = HexValue( hex[ 2 * i ] );
+			int low = HexValue( hex[ 2 * i + 1 ] );
+
+			if ( high < 0 || low < 0 )
+			{
+				return false;
+			}
+
+			bytes[ i ] = static_cast<byte>( high << 4 | low );
+		}
+
+		return true;
+	}
+
+	static void RecordCvars( bool all )
+	{
+		for ( auto &cvar : record.cvars )
+		{
+			std::string value = Cvar::GetValue( cvar.first );
+
+			if ( all || value != cvar.second )
+			{
+				cvar.second = value;
+				Write( Str::Format( "cvar %s %s", cvar.first, Line( value ) ) );
+			}
+		}
+	}
+
+	static void StartRecording( int levelTime, int randomSeed )
+	{
+		const std::string &filename = g_recordInputs.Get();
+
+		if ( trap_FS_FOpenFile( filename.c_str(), &record.file, fsMode_t::FS_WRITE ) < 0 || !record.file )
+		{
+			replayLogger.Warn( "Couldn't open %s to record the game", filename );
+			record.file = 0;
+			return;
+		}
+
+		std::string names = g_replayCvars.Get();
+		for ( EventReader reader( names ); !reader.AtEnd(); )
+		{
+			std::string name = reader.Word();
+
+			if ( !name.empty() )
+			{
+				record.cvars.emplace_back( name, "" );
+			}
+		}
+
+		for ( int &ping : record.pings )
+		{
+			ping = -1;
+		}
+
+		Write( Str::Format( "replay %d %d %d %d %s", REPLAY_VERSION, static_cast<int>( sizeof( usercmd_t ) ),
+		                    levelTime, randomSeed, Cvar::GetValue( "mapname" ) ) );
+		RecordCvars( true );
+
+		replayLogger.Notice( "Recording the game into %s", filename );
+	}
+
+	static void StopRecording()
+	{
+		Write( Str::Format( "end %d %016llx", level.time, static_cast<unsigned long long>( G_StateHash() ) ) );
+		trap_FS_Write( record.buffer.data(), record.buffer.size(), record.file );
+		trap_FS_FCloseFile( record.file );
+
+		record.file = 0;
+		record.buffer.clear();
+		record.cvars.clear();
+	}
+
+	void RecordConnect( int clientNum, bool firstTime, bool isBot )
+	{
+		if ( !Recording() )
+		{
+			return;
+		}
+
+		if ( !firstTime )
+		{
+			std::string session = Cvar::GetValue( Str::Format( "session%i", clientNum ) );
+			Write( Str::Format( "session %d %s", clientNum, Line( session ) ) );
+		}
+
+		if ( !isBot )
+		{
+			char pubkey[ RSA_STRING_LENGTH ];
+			trap_GetPlayerPubkey( clientNum, pubkey, sizeof( pubkey ) );
+			Write( Str::Format( "pubkey %d %s", clientNum, Line( pubkey ) ) );
+		}
+
+		record.pings[ clientNum ] = -1;
+
+		Write( Str::Format( "connect %d %d %d %s", clientNum, firstTime ? 1 : 0, isBot ? 1 : 0,
+		                    Line( Userinfo( clientNum ) ) ) );
+	}
+
+	void RecordBegin( int clientNum )
+	{
+		if ( Recording() )
+		{
+			Write( Str::Format( "begin %d", clientNum ) );
+		}
+	}
+
+	void RecordUserinfoChanged( int clientNum )
+	{
+		if ( Recording() )
+		{
+			Write( Str::Format( "userinfo %d %s", clientNum, Line( Userinfo( clientNum ) ) ) );
+		}
+	}
+
+	void RecordDisconnect( int clientNum )
+	{
+		if ( Recording() )
+		{
+			Write( Str::Format( "disconnect %d", clientNum ) );
+		}
+	}
+
+	void RecordClientCommand( int clientNum, Str::StringRef command )
+	{
+		if ( Recording() )
+		{
+			Write( Str::Format( "command %d %s", clientNum, Line( command ) ) );
+		}
+	}
+
+	void RecordConsoleCommand()
+	{
+		if ( !Recording() )
+		{
+			return;
+		}
+
+		std::string command;
+		for ( int i = 0; i < trap_Argc(); i++ )
+		{
+			char arg[ MAX_STRING_CHARS ];
+			trap_Argv( i, arg, sizeof( arg ) );
+
+			if ( i )
+			{
+				command += ' ';
+			}
+			command += Cmd::Escape( arg );
+		}
+
+		Write( "console " + Line( command ) );
+	}
+
+	void RecordUsercmd( int clientNum )
+	{
+		if ( Recording() )
+		{
+			usercmd_t cmd;
+			trap_GetUsercmd( clientNum, &cmd );
+			Write( Str::Format( "usercmd %d %s", clientNum, ToHex( &cmd, sizeof( cmd ) ) ) );
+		}
+	}
+
+	void RecordFrame( int levelTime )
+	{
+		if ( !Recording() )
+		{
+			return;
+		}
+
+		RecordCvars( false );
+
+		// the engine sets them before each frame
+		for ( int i = 0; i < level.maxclients; i++ )
+		{
+			const gclient_t &client = level.clients[ i ];
+
+			if ( client.pers.connected != CON_DISCONNECTED && !client.pers.isBot
+			     && client.ps.ping != record.pings[ i ] )
+			{
+				record.pings[ i ] = client.ps.ping;
+				Write( Str::Format( "ping %d %d", i, client.ps.ping ) );
+			}
+		}
+
+		Write( Str::Format( "frame %d", levelTime ) );
+
+		trap_FS_Write( record.buffer.data(), record.buffer.size(), record.file );
+		record.buffer.clear();
+	}
+
+	/*
+	================
+	Replaying
+	================
+	*/
+
+	static void Finish()
+	{
+		replay.finished = true;
+		G_RecordFrameTimes( false );
+
+		if ( !g_replayEndCommand.Get().empty() )
+		{
+			trap_SendConsoleCommand( g_replayEndCommand.Get().c_str() );
+		}
+	}
+
+	static void Abort( Str::StringRef reason )
+	{
+		replayLogger.Warn( "Stopping the replay at line %d: %s", static_cast<int>( replay.nextLine ), reason );
+		Finish();
+	}
+
+	static bool StartReplay( int &levelTime, int &randomSeed )
+	{
+		const std::string &filename = g_replayInputs.Get();
+		fileHandle_t f;
+		int len = trap_FS_FOpenFile( filename.c_str(), &f, fsMode_t::FS_READ );
+
+		if ( len < 0 )
+		{
+			replayLogger.Warn( "Couldn't open the recording %s", filename );
+			return false;
+		}
+
+		std::string text( len, '\0' );
+		trap_FS_Read( &text[ 0 ], len, f );
+		trap_FS_FCloseFile( f );
+
+		replay.lines.clear();
+		for ( size_t start = 0; start < text.size(); )
+		{
+			size_t end = std::min( text.find( '\n', start ), text.size() );
+			replay.lines.push_back( text.substr( start, end - start ) );
+			start = end + 1;
+		}
+
+		if ( replay.lines.empty() )
+		{
+			replayLogger.Warn( "The recording %s is empty", filename );
+			return false;
+		}
+
+		EventReader header( replay.lines[ 0 ] );
+		std::string magic = header.Word();
+		int version = header.Int();
+		int usercmdSize = header.Int();
+		int recordedTime = header.Int();
+		int recordedSeed = header.Int();
+		std::string map = header.Rest();
+
+		if ( magic != "replay" || version != REPLAY_VERSION || usercmdSize != static_cast<int>( sizeof( usercmd_t ) ) )
+		{
+			replayLogger.Warn( "%s wasn't recorded by this version of the game", filename );
+			return false;
+		}
+
+		if ( map != Cvar::GetValue( "mapname" ) )
+		{
+			replayLogger.Warn( "%s was recorded on %s", filename, map );
+			return false;
+		}
+
+		levelTime = recordedTime;
+		randomSeed = recordedSeed;
+
+		for ( int i = 0; i < MAX_CLIENTS; i++ )
+		{
+			replay.pings[ i ] = -1;
+			replay.pubkeys[ i ].clear();
+			replay.replayedCmds[ i ] = false;
+		}
+
+		// the cvars have to be set before the game is initialized
+		for ( replay.nextLine = 1; replay.nextLine < replay.lines.size(); replay.nextLine++ )
+		{
+			EventReader event( replay.lines[ replay.nextLine ] );
+
+			if ( event.Word() != "cvar" )
+			{
+				break;
+			}
+
+			std::string name = event.Word();
+			Cvar::SetValue( name, event.Rest() );
+		}
+
+		replay.active = true;
+		replay.finished = false;
+		G_RecordFrameTimes( true );
+
+		replayLogger.Notice( "Replaying %s", filename );
+		return true;
+	}
+
+	static void ReplayConnect( int clientNum, bool firstTime, bool isBot, const std::string &userinfo )
+	{
+		int slot = trap_BotAllocateClient();
+
+		if ( slot != clientNum )
+		{
+			if ( slot >= 0 )
+			{
+				trap_DropClient( slot, "replay stopped" );
+			}
+
+			Abort( Str::Format( "client %d got slot %d", clientNum, slot ) );
+			return;
+		}
+
+		trap_SetUserinfo( clientNum, userinfo.c_str() );
+
+		// bots still send their usercmds to the engine
+		replay.replayedCmds[ clientNum ] = !isBot;
+		replay.usercmds[ clientNum ] = {};
+
+		const char *denied = isBot ? ClientBotConnect( clientNum, firstTime ) : ClientConnect( clientNum, firstTime );
+
+		if ( denied )
+		{
+			trap_DropClient( clientNum, denied );
+		}
+	}
+
+	static void ReplayDisconnect( int clientNum )
+	{
+		// the engine calls ClientDisconnect as it frees the slot
+		if ( level.clients[ clientNum ].pers.connected != CON_DISCONNECTED )
+		{
+			trap_DropClient( clientNum, "disconnected" );
+		}
+		else
+		{
+			ClientDisconnect( clientNum );
+		}
+
+		replay.pings[ clientNum ] = -1;
+		replay.replayedCmds[ clientNum ] = false;
+	}
+
+	static void ReplayUsercmd( int clientNum, const std::string &hex )
+	{
+		if ( !replay.replayedCmds[ clientNum ] || !FromHex( hex, &replay.usercmds[ clientNum ], sizeof( usercmd_t ) ) )
+		{
+			Abort( "bad usercmd" );
+			return;
+		}
+
+		ClientThink( clientNum );
+	}
+
+	static void ReplayEnd( EventReader &event )
+	{
+		int recordedTime = event.Int();
+		std::string recordedHash = event.Word();
+		std::string hash = Str::Format( "%016llx", static_cast<unsigned long long>( G_StateHash() ) );
+
+		if ( recordedTime == level.time && hash == recordedHash )
+		{
+			replayLogger.Notice( "Replay finished at level time %d, state hash %s as recorded", level.time, hash );
+		}
+		else
+		{
+			replayLogger.Warn( "Replay finished at level time %d, state hash %s, but recorded %d, %s",
+			                   level.time, hash, recordedTime, recordedHash );
+		}
+
+		Finish();
+	}
+
+	static bool ValidClient( int clientNum )
+	{
+		return clientNum >= 0 && clientNum < level.maxclients;
+	}
+
+	// Runs the next event, and returns whether it is a frame.
+	static bool ReplayEvent( const std::string &line )
+	{
+		EventReader event( line );
+		std::string name = event.Word();
+
+		if ( name == "frame" )
+		{
+			int levelTime = event.Int();
+
+			for ( int i = 0; i < level.maxclients; i++ )
+			{
+				gclient_t &client = level.clients[ i ];
+
+				if ( client.pers.connected == CON_DISCONNECTED || client.pers.isBot )
+				{
+					continue;
+				}
+
+				// nobody reads what is sent to them
+				char buf[ MAX_STRING_CHARS ];
+				while ( trap_BotGetServerCommand( i, buf, sizeof( buf ) ) );
+
+				if ( replay.pings[ i ] >= 0 )
+				{
+					client.ps.ping = replay.pings[ i ];
+				}
+			}
+
+			G_RunFrame( levelTime );
+			return true;
+		}
+
+		if ( name == "end" )
+		{
+			ReplayEnd( event );
+			return false;
+		}
+
+		if ( name == "cvar" )
+		{
+			std::string cvar = event.Word();
+			Cvar::SetValue( cvar, event.Rest() );
+			return false;
+		}
+
+		if ( name == "console" )
+		{
+			Cmd::PushArgs( event.Rest() );
+			ConsoleCommand();
+			Cmd::PopArgs();
+			return false;
+		}
+
+		int clientNum = event.Int();
+
+		if ( !ValidClient( clientNum ) )
+		{
+			Abort( Str::Format( "bad client number in %s", name ) );
+			return false;
+		}
+
+		if ( name == "usercmd" )
+		{
+			ReplayUsercmd( clientNum, event.Word() );
+		}
+		else if ( name == "ping" )
+		{
+			replay.pings[ clientNum ] = event.Int();
+		}
+		else if ( name == "session" )
+		{
+			trap_Cvar_Set( va( "session%i", clientNum ), event.Rest().c_str() );
+		}
+		else if ( name == "pubkey" )
+		{
+			replay.pubkeys[ clientNum ] = event.Rest();
+		}
+		else if ( name == "connect" )
+		{
+			bool firstTime = event.Int();
+			bool isBot = event.Int();
+			ReplayConnect( clientNum, firstTime, isBot, event.Rest() );
+		}
+		else if ( name == "begin" )
+		{
+			ClientBegin( clientNum );
+		}
+		else if ( name == "userinfo" )
+		{
+			trap_SetUserinfo( clientNum, event.Rest().c_str() );
+			ClientUserinfoChanged( clientNum, false );
+		}
+		else if ( name == "disconnect" )
+		{
+			ReplayDisconnect( clientNum );
+		}
+		else if ( name == "command" )
+		{
+			Cmd::PushArgs( event.Rest() );
+			ClientCommand( clientNum );
+			Cmd::PopArgs();
+		}
+		else
+		{
+			Abort( Str::Format( "unknown event %s", name ) );
+		}
+
+		return false;
+	}
+
+	void RunFrame()
+	{
+		injecting = true;
+
+		while ( !replay.finished )
+		{
+			if ( replay.nextLine >= replay.lines.size() )
+			{
+				Abort( "the recording ends before the end of the game" );
+				break;
+			}
+
+			if ( ReplayEvent( replay.lines[ replay.nextLine++ ] ) )
+			{
+				break;
+			}
+		}
+
+		injecting = false;
+	}
+
+	bool Pubkey( int clientNum, char *pubkey, int size )
+	{
+		if ( !replay.active )
+		{
+			return false;
+		}
+
+		Q_strncpyz( pubkey, replay.pubkeys[ clientNum ].c_str(), size );
+		return true;
+	}
+
+	bool Usercmd( int clientNum, usercmd_t *cmd )
+	{
+		if ( !replay.active || !replay.replayedCmds[ clientNum ] )
+		{
+			return false;
+		}
+
+		*cmd = replay.usercmds[ clientNum ];
+		return true;
+	}
+
+	/*
+	================
+	Init and shutdown
+	================
+	*/
+
+	void Init( int &levelTime, int &randomSeed )
+	{
+		if ( !g_replayInputs.Get().empty() && StartReplay( levelTime, randomSeed ) )
+		{
+			if ( !g_recordInputs.Get().empty() )
+			{
+				replayLogger.Warn( "Not recording the game while replaying one" );
+			}
+
+			return;
+		}
+
+		if ( !g_recordInputs.Get().empty() )
+		{
+			StartRecording( levelTime, randomSeed );
+		}
+	}
+
+	void Shutdown()
+	{
+		if ( record.file )
+		{
+			StopRecording();
+		}
+
+		if ( replay.active && !replay.finished )
+		{
+			replayLogger.Warn( "The game ended before the replay, at line %d", static_cast<int>( replay.nextLine ) );
+			G_RecordFrameTimes( false );
+		}
+
+		replay.active = false;
+		replay.lines.clear();
+		injecting = false;
+	}
+}
@@ -945,75 +945,124 @@ static char *G_AddSpawnVarToken( const char *string )
 
 /*
 ====================
-G_ParseSpawnVars
+Parsed entity definitions
 
-Parses a brace bounded set of key / value pairs out of the
-level's entity strings into level.spawnVars[]
+The entity string doesn't change while the map is loaded, so it is only
+tokenized for the first spawn; map restarts spawn from the parsed tokens.
+====================
+*/
+static struct {
+	const char       *source;   // entity string the tokens were parsed from
+	size_t           sourceLength;
+	std::string      tokens;    // keys and values, each followed by a NUL
+	std::vector<int> numPairs;  // number of key / value pairs of each entity
+} parsedEntities;
+
+/*
+====================
+G_ParseEntityString
+
+Parses the brace bounded sets of key / value pairs out of the
+level's entity string into parsedEntities
 
 This does not actually spawn an entity.
 ====================
 */
-static bool G_ParseSpawnVars( const char** entString )
+static void G_ParseEntityString( const char *entityString )
 {
-	level.numSpawnVars = 0;
-	level.numSpawnVarChars = 0;
-
-	const char* entityString = *entString;
 	const char* token;
 
-	// parse the opening brace
-	token = COM_Parse( &entityString );
-	if ( !token || token[0] == '\0' )
-	{
-		// end of spawn string
-		return false;
-	}
+	const char* source = entityString;
 
-	if ( token[ 0 ] != '{' )
-	{
-		Sys::Drop( "G_ParseSpawnVars: found %s when expecting {", token );
-	}
+	parsedEntities.source = nullptr;
+	parsedEntities.tokens.clear();
+	parsedEntities.numPairs.clear();
 
-	// go through all the key / value pairs
 	while ( 1 )
 	{
-		// parse key
+		// parse the opening brace
 		token = COM_Parse( &entityString );
-		if ( !token )
+		if ( !token || token[0] == '\0' )
 		{
-			Sys::Drop( "G_ParseSpawnVars: EOF without closing brace" );
+			// end of spawn string
+			parsedEntities.source = source;
+			parsedEntities.sourceLength = strlen( source );
+			return;
 		}
 
-		const std::string key { token };
-		if ( key[ 0 ] == '}' )
+		if ( token[ 0 ] != '{' )
 		{
-			break;
+			Sys::Drop( "G_ParseEntityString: found %s when expecting {", token );
 		}
 
-		// parse value
-		token = COM_Parse( &entityString );
-		if ( !token )
-		{
-			Sys::Drop( "G_ParseSpawnVars: EOF without closing brace" );
-		}
+		int numPairs = 0;
 
-		if ( token[ 0 ] == '}' )
+		// go through all the key / value pairs
+		while ( 1 )
 		{
-			Sys::Drop( "G_ParseSpawnVars: closing brace without data" );
-		}
+			// parse key
+			token = COM_Parse( &entityString );
+			if ( !token )
+			{
+				Sys::Drop( "G_ParseEntityString: EOF without closing brace" );
+			}
 
-		if ( level.numSpawnVars == MAX_SPAWN_VARS )
-		{
-			Sys::Drop( "G_ParseSpawnVars: MAX_SPAWN_VARS" );
+			if ( token[ 0 ] == '}' )
+			{
+				break;
+			}
+
+			if ( numPairs == MAX_SPAWN_VARS )
+			{
+				Sys::Drop( "G_ParseEntityString: MAX_SPAWN_VARS" );
+			}
+
+			// copy the key before the next token overwrites it
+			parsedEntities.tokens.append( token, strlen( token ) + 1 );
+
+			// parse value
+			token = COM_Parse( &entityString );
+			if ( !token )
+			{
+				Sys::Drop( "G_ParseEntityString: EOF without closing brace" );
+			}
+
+			if ( token[ 0 ] == '}' )
+			{
+				Sys::Drop( "G_ParseEntityString: closing brace without data" );
+			}
+
+			parsedEntities.tokens.append( token, strlen( token ) + 1 );
+			numPairs++;
 		}
 
-		level.spawnVars[ level.numSpawnVars ][ 0 ] = G_AddSpawnVarToken( key.c_str() );
-		level.spawnVars[ level.numSpawnVars ][ 1 ] = G_AddSpawnVarToken( token );
-		level.numSpawnVars++;
+		parsedEntities.numPairs.push_back( numPairs );
 	}
+}
 
-	*entString = entityString;
-	return true;
+/*
+====================
+G_LoadSpawnVars
+
+Fills level.spawnVars[] with the key / value pairs of the next
+parsed entity, advancing tokens past them
+====================
+*/
+static void G_LoadSpawnVars( int numPairs, const char **tokens )
+{
+	level.numSpawnVars = 0;
+	level.numSpawnVarChars = 0;
+
+	for ( int i = 0; i < numPairs; i++ )
+	{
+		const char *key = *tokens;
+		const char *value = key + strlen( key ) + 1;
+		*tokens = value + strlen( value ) + 1;
+
+		level.spawnVars[ level.numSpawnVars ][ 0 ] = G_AddSpawnVarToken( key );
+		level.spawnVars[ level.numSpawnVars ][ 1 ] = G_AddSpawnVarToken( value );
+		level.numSpawnVars++;
+	}
 }
 
 // The callbacks don't work until BG_InitAllConfigs()
@@ -1171,22 +1220,41 @@ void G_SpawnEntitiesFromString()
 	level.numSpawnVars = 0;
 	ResetAutomaticEntityIdState();
 
+	int startTime = Sys::Milliseconds();
+
+	const char* entityString = CM_EntityString();
+	bool parsed = parsedEntities.source != entityString || parsedEntities.sourceLength != strlen( entityString );
+	if ( parsed )
+	{
+		G_ParseEntityString( entityString );
+	}
+
+	int parseTime = Sys::Milliseconds() - startTime;
+
+	const std::vector<int> &numPairs = parsedEntities.numPairs;
+	const char *tokens = parsedEntities.tokens.c_str();
+
 	// the worldspawn is not an actual entity, but it still
 	// has a "spawn" function to perform any global setup
 	// needed by a level (setting configstrings or cvars, etc)
-	const char* entityString = CM_EntityString();
-	if ( !G_ParseSpawnVars( &entityString ) )
+	if ( numPairs.empty() )
 	{
 		Sys::Drop( "SpawnEntities: no entities" );
 	}
 
+	G_LoadSpawnVars( numPairs[ 0 ], &tokens );
 	SP_worldspawn();
 
-	// parse ents
-	while ( G_ParseSpawnVars( &entityString ) )
+	// spawn ents
+	for ( size_t i = 1; i < numPairs.size(); i++ )
 	{
+		G_LoadSpawnVars( numPairs[ i ], &tokens );
 		G_SpawnGEntityFromSpawnVars();
 	}
+
+	Log::Verbose( "Spawned %d entity definitions in %d ms (%s %d ms).",
+	              static_cast<int>( numPairs.size() ), Sys::Milliseconds() - startTime,
+	              parsed ? "parsing" : "reusing parsed definitions", parseTime );
 }
 
 void G_SpawnFakeEntities()
@@ -37,6 +37,7 @@ Maryland 20850 USA.
 #include "sg_spawn.h"
 #include "Entities.h"
 #include "CBSE.h"
+#include "shared/Timing.h"
 
 #define DEFAULT_FUNC_TRAIN_SPEED 100
 
@@ -67,6 +68,17 @@ struct pushed_t
 
 pushed_t pushed[ MAX_GENTITIES ], *pushed_p;
 
+static struct
+{
+	int pushes;     // calls to G_MoverPush
+	int candidates; // pushable entities in the swept box
+	int riders;     // standing on the pusher, so pushed without testing
+	int outside;    // rejected by the bounds of the pusher's final position
+	int clear;      // rejected by clipping against the pusher alone
+	int pushed;     // overlapping the pusher and pushed
+	int usec;       // time spent pushing
+} moverPushStats;
+
 /*
 ============
 G_TestEntityPosition
@@ -263,6 +275,71 @@ static bool G_TryPushingEntity( gentity_t *check, gentity_t *pusher, vec3_t move
 	return false;
 }
 
+/*
+============
+G_MoverPushRollback
+
+Move back all the entities pushed so far.
+============
+*/
+static void G_MoverPushRollback()
+{
+	static int earliestPush[ MAX_GENTITIES ];
+	pushed_t   *p;
+
+	// go backwards, so if the same entity was pushed
+	// twice, it goes back to the original position
+	for ( p = pushed_p - 1; p >= pushed; p-- )
+	{
+		VectorCopy( p->origin, p->ent->s.pos.trBase );
+		VectorCopy( p->angles, p->ent->s.apos.trBase );
+
+		if ( p->ent->client )
+		{
+			p->ent->client->ps.delta_angles[ YAW ] = p->deltayaw;
+			VectorCopy( p->origin, p->ent->client->ps.origin );
+		}
+
+		earliestPush[ p->ent->num() ] = static_cast<int>( p - pushed );
+	}
+
+	// link each entity once, in the order it was last linked when this
+	// was done per push, so that the world sectors end up the same
+	for ( p = pushed_p - 1; p >= pushed; p-- )
+	{
+		if ( earliestPush[ p->ent->num() ] == static_cast<int>( p - pushed ) )
+		{
+			trap_LinkEntity( p->ent );
+		}
+	}
+}
+
+/*
+============
+G_PusherOverlaps
+
+Whether the entity overlaps the pusher at the pusher's current position. This
+only clips against the pusher, instead of tracing through the whole world like
+G_TestEntityPosition does.
+============
+*/
+static bool G_PusherOverlaps( gentity_t *pusher, gentity_t *check )
+{
+	vec3_t mins, maxs;
+	const float *origin = check->client ? check->client->ps.origin : check->s.pos.trBase;
+
+	// a trace with the entity's clipmask wouldn't hit the pusher either
+	if ( !( check->clipmask & pusher->r.contents ) )
+	{
+		return false;
+	}
+
+	VectorAdd( origin, check->r.mins, mins );
+	VectorAdd( origin, check->r.maxs, maxs );
+
+	return trap_EntityContact( mins, maxs, pusher );
+}
+
 /*
 ============
 G_MoverPush
@@ -277,12 +354,12 @@ static bool G_MoverPush( gentity_t *pusher, vec3_t move, vec3_t amove, gentity_t
 	int       i, e;
 	gentity_t *check;
 	vec3_t    mins, maxs;
-	pushed_t  *p;
 	int       entityList[ MAX_GENTITIES ];
 	int       listedEntities;
 	vec3_t    totalMins, totalMaxs;
 
 	*obstacle = nullptr;
+	moverPushStats.pushes++;
 
 	// mins/maxs are the bounds at the destination
 	// totalMins / totalMaxs are the bounds for the entire move
@@ -325,9 +402,8 @@ static bool G_MoverPush( gentity_t *pusher, vec3_t move, vec3_t amove, gentity_t
 		}
 	}
 
-	// unlink the pusher so we don't get it in the entityList
-	trap_UnlinkEntity( pusher );
-
+	// the pusher itself is skipped below, so it doesn't need to be unlinked
+	// for this; linking it again at its final position is enough
 	listedEntities = trap_EntitiesInBox( totalMins, totalMaxs, entityList, MAX_GENTITIES );
 
 	// move the pusher to its final position
@@ -340,6 +416,11 @@ static bool G_MoverPush( gentity_t *pusher, vec3_t move, vec3_t amove, gentity_t
 	{
 		check = &g_entities[ entityList[ e ] ];
 
+		if ( check == pusher )
+		{
+			continue;
+		}
+
 		// only push items and players
 		if ( check->s.eType != entityType_t::ET_ITEM && check->s.eType != entityType_t::ET_BUILDABLE &&
 		     check->s.eType != entityType_t::ET_CORPSE && check->s.eType != entityType_t::ET_PLAYER &&
@@ -348,8 +429,14 @@ static bool G_MoverPush( gentity_t *pusher, vec3_t move, vec3_t amove, gentity_t
 			continue;
 		}
 
+		moverPushStats.candidates++;
+
 		// if the entity is standing on the pusher, it will definitely be moved
-		if ( check->s.groundEntityNum != pusher->num() )
+		if ( check->s.groundEntityNum == pusher->num() )
+		{
+			moverPushStats.riders++;
+		}
+		else
 		{
 			// see if the ent needs to be tested
 			if ( check->r.absmin[ 0 ] >= maxs[ 0 ]
@@ -359,15 +446,19 @@ static bool G_MoverPush( gentity_t *pusher, vec3_t move, vec3_t amove, gentity_t
 			     || check->r.absmax[ 1 ] <= mins[ 1 ]
 			     || check->r.absmax[ 2 ] <= mins[ 2 ] )
 			{
+				moverPushStats.outside++;
 				continue;
 			}
 
 			// see if the ent's bbox is inside the pusher's final position
 			// this does allow a fast moving object to pass through a thin entity...
-			if ( !G_TestEntityPosition( check ) )
+			if ( !G_PusherOverlaps( pusher, check ) )
 			{
+				moverPushStats.clear++;
 				continue;
 			}
+
+			moverPushStats.pushed++;
 		}
 
 		// the entity needs to be pushed
@@ -388,22 +479,7 @@ static bool G_MoverPush( gentity_t *pusher, vec3_t move, vec3_t amove, gentity_t
 		// save off the obstacle so we can call the block function (crush, etc)
 		*obstacle = check;
 
-		// move back any entities we already moved
-		// go backwards, so if the same entity was pushed
-		// twice, it goes back to the original position
-		for ( p = pushed_p - 1; p >= pushed; p-- )
-		{
-			VectorCopy( p->origin, p->ent->s.pos.trBase );
-			VectorCopy( p->angles, p->ent->s.apos.trBase );
-
-			if ( p->ent->client )
-			{
-				p->ent->client->ps.delta_angles[ YAW ] = p->deltayaw;
-				VectorCopy( p->origin, p->ent->client->ps.origin );
-			}
-
-			trap_LinkEntity( p->ent );
-		}
+		G_MoverPushRollback();
 
 		return false;
 	}
@@ -411,6 +487,29 @@ static bool G_MoverPush( gentity_t *pusher, vec3_t move, vec3_t amove, gentity_t
 	return true;
 }
 
+class MoverPushStatsCmd : public Cmd::StaticCmd
+{
+public:
+	MoverPushStatsCmd() : StaticCmd( "moverPushStats", 0,
+		"print how the entities near moving movers were tested: moverPushStats [reset]" ) {}
+
+	void Run( const Cmd::Args& args ) const override
+	{
+		if ( args.Argc() == 2 && args.Argv( 1 ) == "reset" )
+		{
+			moverPushStats = {};
+			return;
+		}
+
+		Print( "%d pushes in %d us, %d candidates:", moverPushStats.pushes, moverPushStats.usec, moverPushStats.candidates );
+		Print( "  %d riders", moverPushStats.riders );
+		Print( "  %d outside the final bounds", moverPushStats.outside );
+		Print( "  %d clear of the pusher", moverPushStats.clear );
+		Print( "  %d pushed", moverPushStats.pushed );
+	}
+};
+static MoverPushStatsCmd moverPushStatsRegistration;
+
 /*
 =================
 G_MoverGroup
@@ -429,6 +528,8 @@ static void G_MoverGroup( gentity_t *ent )
 	// if the move is blocked, all moved objects will be backed out
 	pushed_p = pushed;
 
+	auto start = Timing::Now();
+
 	for ( part = ent; part; part = part->mapEntity.groupChain )
 	{
 		if ( part->s.pos.trType == trType_t::TR_STATIONARY &&
@@ -449,6 +550,8 @@ static void G_MoverGroup( gentity_t *ent )
 		}
 	}
 
+	moverPushStats.usec += Timing::Elapsed( start );
+
 	if ( part )
 	{
 		// go back to the previous position
@@ -40,6 +40,7 @@ Maryland 20850 USA.
 #include "common/Common.h"
 #include "sg_local.h"
 #include "botlib/bot_api.h"
+#include "shared/Timing.h"
 
 #define IS_NON_NULL_VEC3(vec3tor) (vec3tor[0] || vec3tor[1] || vec3tor[2])
 
@@ -106,6 +107,174 @@ public:
 };
 static ShowBehaviorCmd showBehaviorRegistration;
 
+class BenchmarkNameLookupCmd : public Cmd::StaticCmd
+{
+public:
+	BenchmarkNameLookupCmd() : StaticCmd( "benchmarkNameLookup", 0,
+		"time the BG_*ByName lookups against a linear scan: benchmarkNameLookup [iterations]" ) {}
+
+	void Run( const Cmd::Args& args ) const override
+	{
+		int iterations = args.Argc() > 1 ? std::max( 1, atoi( args.Argv( 1 ).c_str() ) ) : 10000;
+
+		std::vector<std::string> names = { "nonexistent" };
+		for ( int i = BA_NONE + 1; i < BA_NUM_BUILDABLES; i++ )
+		{
+			names.push_back( BG_Buildable( i )->name );
+			names.push_back( BG_Buildable( i )->entityName );
+		}
+		for ( int i = PCL_NONE + 1; i < PCL_NUM_CLASSES; i++ )
+		{
+			names.push_back( BG_Class( i )->name );
+		}
+		for ( int i = WP_NONE + 1; i < WP_NUM_WEAPONS; i++ )
+		{
+			names.push_back( BG_Weapon( i )->name );
+		}
+		for ( int i = UP_NONE + 1; i < UP_NUM_UPGRADES; i++ )
+		{
+			names.push_back( BG_Upgrade( i )->name );
+		}
+
+		// the same lookups, done the way they used to be
+		int linearFound = 0;
+		auto start = Timing::Now();
+		for ( int iteration = 0; iteration < iterations; iteration++ )
+		{
+			for ( const std::string &name : names )
+			{
+				linearFound += LinearLookup( name.c_str() );
+			}
+		}
+		int linearUsec = Timing::Elapsed( start );
+
+		int hashedFound = 0;
+		start = Timing::Now();
+		for ( int iteration = 0; iteration < iterations; iteration++ )
+		{
+			for ( const std::string &name : names )
+			{
+				hashedFound += BG_BuildableByName( name.c_str() )->number != BA_NONE;
+				hashedFound += BG_ClassByName( name.c_str() )->number != PCL_NONE;
+				hashedFound += BG_WeaponByName( name.c_str() )->number != WP_NONE;
+				hashedFound += BG_UpgradeByName( name.c_str() )->number != UP_NONE;
+			}
+		}
+		int hashedUsec = Timing::Elapsed( start );
+
+		int lookups = iterations * static_cast<int>( names.size() ) * 4;
+		Print( "%d lookups", lookups );
+		Print( "linear: %d us (%d ns per lookup)", linearUsec, static_cast<int>( 1000LL * linearUsec / lookups ) );
+		Print( "hashed: %d us (%d ns per lookup)%s", hashedUsec, static_cast<int>( 1000LL * hashedUsec / lookups ),
+		       linearFound == hashedFound ? "" : " ^1(results differ)" );
+	}
+
+private:
+	static int LinearLookup( const char *name )
+	{
+		int found = 0;
+
+		for ( int i = BA_NONE + 1; i < BA_NUM_BUILDABLES; i++ )
+		{
+			if ( !Q_stricmp( BG_Buildable( i )->name, name ) || !Q_stricmp( BG_Buildable( i )->entityName, name ) )
+			{
+				found++;
+				break;
+			}
+		}
+		for ( int i = PCL_NONE + 1; i < PCL_NUM_CLASSES; i++ )
+		{
+			if ( !Q_stricmp( BG_Class( i )->name, name ) )
+			{
+				found++;
+				break;
+			}
+		}
+		for ( int i = WP_NONE + 1; i < WP_NUM_WEAPONS; i++ )
+		{
+			if ( !Q_stricmp( BG_Weapon( i )->name, name ) )
+			{
+				found++;
+				break;
+			}
+		}
+		for ( int i = UP_NONE + 1; i < UP_NUM_UPGRADES; i++ )
+		{
+			if ( !Q_stricmp( BG_Upgrade( i )->name, name ) )
+			{
+				found++;
+				break;
+			}
+		}
+
+		return found;
+	}
+};
+static BenchmarkNameLookupCmd benchmarkNameLookupRegistration;
+
+// FNV-1a
+static void Hash( uint64_t &hash, const void *data, size_t size )
+{
+	const byte *bytes = static_cast<const byte *>( data );
+
+	for ( size_t i = 0; i < size; i++ )
+	{
+		hash = ( hash ^ bytes[ i ] ) * 1099511628211ull;
+	}
+}
+
+/*
+=================
+G_StateHash
+
+A hash of the entity states and of the player states of connected clients,
+to check that two runs of the same inputs simulated the same game
+=================
+*/
+uint64_t G_StateHash()
+{
+	uint64_t hash = 14695981039346656037ull;
+
+	Hash( hash, &level.time, sizeof( level.time ) );
+
+	for ( int i = 0; i < level.num_entities; i++ )
+	{
+		const gentity_t *ent = &g_entities[ i ];
+
+		if ( !ent->inuse )
+		{
+			continue;
+		}
+
+		Hash( hash, &i, sizeof( i ) );
+		Hash( hash, &ent->s, sizeof( ent->s ) );
+		Hash( hash, ent->r.currentOrigin, sizeof( vec3_t ) );
+	}
+
+	for ( int i = 0; i < level.maxclients; i++ )
+	{
+		if ( level.clients[ i ].pers.connected == CON_CONNECTED )
+		{
+			Hash( hash, &level.clients[ i ].ps, sizeof( playerState_t ) );
+		}
+	}
+
+	return hash;
+}
+
+class StateHashCmd : public Cmd::StaticCmd
+{
+public:
+	StateHashCmd() : StaticCmd( "stateHash", 0,
+		"print a hash of the game state, to check that two runs of a benchmark simulated the same game" ) {}
+
+	void Run( const Cmd::Args& ) const override
+	{
+		Print( "level time %d, state hash %016llx", level.time, static_cast<unsigned long long>( G_StateHash() ) );
+	}
+};
+static StateHashCmd stateHashRegistration;
+
 static void Svcmd_EntityFire_f()
 {
 	char argument[ MAX_STRING_CHARS ];
@@ -858,6 +1027,14 @@ bool  ConsoleCommand()
 
 	trap_Argv( 0, cmd, sizeof( cmd ) );
 
+	if ( Replay::Ignores() )
+	{
+		Log::Notice( "ignoring %s while replaying a recorded game", cmd );
+		return true;
+	}
+
+	Replay::RecordConsoleCommand();
+
 	command = (struct svcmd*) bsearch( cmd, svcmds, ARRAY_LEN( svcmds ),
 	                   sizeof( struct svcmd ), cmdcmp );
 
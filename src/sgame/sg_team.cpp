@@ -293,6 +293,7 @@ void G_ChangeTeam( gentity_t *ent, team_t newTeam )
 		// We shouldn't call ClientSpawn if it hasn't entered the game.
 
 		ent->client->pers.team = newTeam;
+		EquipmentCensus::Update( ent );
 
 		// userinfo configstrings
 		ClientUserinfoChanged( ent->client->ps.clientNum, false );
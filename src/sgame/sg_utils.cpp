@@ -846,8 +846,7 @@ bool G_LineOfSight( const gentity_t *from, const gentity_t *to, int mask, bool u
 	}
 
 	trace_t trace;
-	trap_Trace( &trace, VEC2GLM( useTrajBase ? from->s.pos.trBase : from->s.origin ),
-	            glm::vec3(), glm::vec3(), VEC2GLM( to->s.origin ), from->num(), mask, 0 );
+	G_CM_CachedTrace( &trace, useTrajBase ? from->s.pos.trBase : from->s.origin, to->s.origin, from->num(), mask );
 
 	// Also check for fraction in case the mask is chosen so that the trace skips the target entity
 	return ( trace.entityNum == to->num() || trace.fraction == 1.0f );
@@ -0,0 +1,165 @@
+/*
+===========================================================================
+
+Unvanquished GPL Source Code
+Copyright (C) 2024 Unvanquished Developers
+
+This file is part of the Unvanquished GPL Source Code (Unvanquished Source Code).
+
+Unvanquished is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Unvanquished is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Unvanquished. If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+
+#include "common/Common.h"
+#include "Parallel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Parallel {
+	struct pool_t {
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable done;
+
+		int started = 0; // worker threads that exist
+		int wanted = 0;  // worker threads that take part in jobs
+
+		// the current job, guarded by mutex except for next
+		uint64_t generation = 0;
+		const std::function<void(int, int)> *job = nullptr;
+		int count = 0;
+		int chunk = 1;
+		int active = 0; // workers that haven't finished the current job
+		std::atomic<int> next{0};
+	};
+
+	// Never destroyed: the workers are detached and may outlive static destructors.
+	static pool_t &Pool() {
+		static pool_t *pool = new pool_t;
+		return *pool;
+	}
+
+	static thread_local bool inJob = false;
+
+	static void RunChunks(pool_t &pool) {
+		for (;;) {
+			int begin = pool.next.fetch_add(pool.chunk);
+
+			if (begin >= pool.count) {
+				return;
+			}
+
+			(*pool.job)(begin, std::min(begin + pool.chunk, pool.count));
+		}
+	}
+
+	// Runs the calling thread's share of the job, and whether it returns or
+	// throws, waits for the workers to be done with the job before it goes out
+	// of scope.
+	class JobScope {
+	public:
+		explicit JobScope(pool_t &pool) : pool_(pool) {
+			inJob = true;
+		}
+
+		~JobScope() {
+			inJob = false;
+
+			// if the job threw, the chunks nobody took are skipped
+			pool_.next = pool_.count;
+
+			std::unique_lock<std::mutex> lock(pool_.mutex);
+			pool_.done.wait(lock, [&] { return pool_.active == 0; });
+			pool_.job = nullptr;
+		}
+
+	private:
+		pool_t &pool_;
+	};
+
+	static void Worker(int index) {
+		pool_t &pool = Pool();
+		uint64_t seen = 0;
+
+		inJob = true;
+
+		std::unique_lock<std::mutex> lock(pool.mutex);
+		for (;;) {
+			pool.wake.wait(lock, [&] { return pool.generation != seen; });
+			seen = pool.generation;
+
+			if (index >= pool.wanted) {
+				continue;
+			}
+
+			lock.unlock();
+			RunChunks(pool);
+			lock.lock();
+
+			if (--pool.active == 0) {
+				pool.done.notify_one();
+			}
+		}
+	}
+
+	void SetNumThreads(int numThreads) {
+		pool_t &pool = Pool();
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		pool.wanted = std::max(numThreads, 0);
+	}
+
+	int NumThreads() {
+		pool_t &pool = Pool();
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		return pool.wanted;
+	}
+
+	void For(int count, int minParallelCount, const std::function<void(int, int)> &job) {
+		pool_t &pool = Pool();
+
+		if (count <= 0) {
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(pool.mutex);
+
+		if (inJob || pool.wanted == 0 || count < std::max(minParallelCount, 2)) {
+			lock.unlock();
+			job(0, count);
+			return;
+		}
+
+		while (pool.started < pool.wanted) {
+			std::thread(Worker, pool.started++).detach();
+		}
+
+		// A few chunks per thread so that uneven iterations even out
+		pool.job = &job;
+		pool.count = count;
+		pool.chunk = std::max(1, count / (4 * (pool.wanted + 1)));
+		pool.next = 0;
+		pool.active = pool.wanted;
+		pool.generation++;
+
+		lock.unlock();
+		pool.wake.notify_all();
+
+		JobScope scope(pool);
+		RunChunks(pool);
+	}
+}
@@ -0,0 +1,52 @@
+/*
+===========================================================================
+
+Unvanquished GPL Source Code
+Copyright (C) 2024 Unvanquished Developers
+
+This file is part of the Unvanquished GPL Source Code (Unvanquished Source Code).
+
+Unvanquished is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Unvanquished is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Unvanquished. If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+
+#ifndef SHARED_PARALLEL_H_
+#define SHARED_PARALLEL_H_
+
+#include <functional>
+
+/**
+ * A pool of worker threads that help the main thread with loops whose
+ * iterations are independent of each other.
+ */
+namespace Parallel {
+	/**
+	 * @brief Sets the number of worker threads in addition to the calling thread.
+	 *        With 0, everything runs on the calling thread. Workers are started when first needed.
+	 */
+	void SetNumThreads(int numThreads);
+
+	int NumThreads();
+
+	/**
+	 * @brief Calls job(begin, end) for consecutive ranges covering [0, count) and returns when
+	 *        all of them are done. The ranges are spread over the workers when there are at
+	 *        least minParallelCount iterations, otherwise the calling thread runs them all.
+	 * @note  Only the main thread may start jobs. Jobs started from within a job run serially.
+	 */
+	void For(int count, int minParallelCount, const std::function<void(int begin, int end)> &job);
+}
+
+#endif // SHARED_PARALLEL_H_
@@ -0,0 +1,49 @@
+/*
+===========================================================================
+
+Unvanquished GPL Source Code
+Copyright (C) 2024 Unvanquished Developers
+
+This file is part of the Unvanquished GPL Source Code (Unvanquished Source Code).
+
+Unvanquished is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Unvanquished is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Unvanquished. If not, see <http://www.gnu.org/licenses/>.
+
+===========================================================================
+*/
+
+#ifndef SHARED_TIMING_H_
+#define SHARED_TIMING_H_
+
+#include <chrono>
+
+/**
+ * Wall clock measurements for benchmark commands, statistics and time budgets.
+ */
+namespace Timing {
+	using Clock     = std::chrono::steady_clock;
+	using TimePoint = Clock::time_point;
+
+	inline TimePoint Now() {
+		return Clock::now();
+	}
+
+	/**
+	 * @brief Microseconds from start until now.
+	 */
+	inline int Elapsed(TimePoint start) {
+		return static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+	}
+}
+
+#endif // SHARED_TIMING_H_
@@ -31,10 +31,40 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "shared/CommonProxies.h"
 #include "bg_public.h"
 #include "parse.h"
+#include "Timing.h"
 
 // delayed translation - these strings may be passed to Trans_Gettext() later
 #define N_(x) x
 
+// Case-insensitive name to array index tables, so that the *ByName lookups
+// below don't have to compare against every entry.
+using nameIndex_t = std::unordered_map<std::string, int, Str::IHash, Str::IEqual>;
+
+template<typename T, size_t N>
+static nameIndex_t BG_BuildNameIndex( const T ( &data )[ N ], const char *T::*field )
+{
+	nameIndex_t index;
+
+	for ( size_t i = 0; i < N; i++ )
+	{
+		// keep the first entry on duplicates, as the linear scans did
+		index.emplace( data[ i ].*field, static_cast<int>( i ) );
+	}
+
+	return index;
+}
+
+static int BG_LookupName( const nameIndex_t &index, const char *name )
+{
+	if ( !name )
+	{
+		return -1;
+	}
+
+	auto it = index.find( name );
+	return it != index.end() ? it->second : -1;
+}
+
 struct buildableName_t
 {
 	buildable_t number;
@@ -77,16 +107,15 @@ BG_BuildableByName
 */
 const buildableAttributes_t *BG_BuildableByName( const char *name )
 {
-	for ( unsigned i = 0; i < bg_numBuildables; i++ )
+	static const nameIndex_t names = BG_BuildNameIndex( bg_buildableNameList, &buildableName_t::name );
+	int i = BG_LookupName( names, name );
+
+	if ( i < 0 )
 	{
-		if ( !Q_stricmp( bg_buildableList[ i ].name, name )
-				|| !Q_stricmp( bg_buildableList[ i ].entityName, name ) )
-		{
-			return &bg_buildableList[ i ];
-		}
+		return BG_BuildableByEntityName( name );
 	}
 
-	return &nullBuildable;
+	return &bg_buildableList[ i ];
 }
 
 /*
@@ -96,15 +125,10 @@ BG_BuildableByEntityName
 */
 const buildableAttributes_t *BG_BuildableByEntityName( const char *name )
 {
-	for ( unsigned i = 0; i < bg_numBuildables; i++ )
-	{
-		if ( !Q_stricmp( bg_buildableList[ i ].entityName, name ) )
-		{
-			return &bg_buildableList[ i ];
-		}
-	}
+	static const nameIndex_t classnames = BG_BuildNameIndex( bg_buildableNameList, &buildableName_t::classname );
+	int i = BG_LookupName( classnames, name );
 
-	return &nullBuildable;
+	return i < 0 ? &nullBuildable : &bg_buildableList[ i ];
 }
 
 /*
@@ -303,18 +327,10 @@ BG_ClassByName
 */
 const classAttributes_t *BG_ClassByName( const char *name )
 {
-	if ( name )
-	{
-		for ( unsigned i = 0; i < bg_numClasses; i++ )
-		{
-			if ( !Q_stricmp( bg_classList[ i ].name, name ) )
-			{
-				return &bg_classList[ i ];
-			}
-		}
-	}
+	static const nameIndex_t names = BG_BuildNameIndex( bg_classData, &classData_t::name );
+	int i = BG_LookupName( names, name );
 
-	return &nullClass;
+	return i < 0 ? &nullClass : &bg_classList[ i ];
 }
 
 /*
@@ -330,6 +346,9 @@ const classAttributes_t *BG_Class( int pClass )
 
 static classModelConfig_t bg_classModelConfigList[ PCL_NUM_CLASSES ];
 
+// human names come from the model configs, so this is filled when they are loaded
+static nameIndex_t bg_classModelConfigNames;
+
 /*
 ==============
 BG_ClassModelConfigByName
@@ -337,15 +356,11 @@ BG_ClassModelConfigByName
 */
 const classModelConfig_t *BG_ClassModelConfigByName( const char *name )
 {
-	if ( name )
+	int i = BG_LookupName( bg_classModelConfigNames, name );
+
+	if ( i >= 0 )
 	{
-		for ( unsigned i = 0; i < bg_numClasses; i++ )
-		{
-			if ( !Q_stricmp( bg_classModelConfigList[ i ].humanName, name ) )
-			{
-				return &bg_classModelConfigList[ i ];
-			}
-		}
+		return &bg_classModelConfigList[ i ];
 	}
 
 	return &nullClassModelConfig;
@@ -515,6 +530,8 @@ BG_InitClassModelConfigs
 */
 static void BG_InitClassModelConfigs()
 {
+	bg_classModelConfigNames.clear();
+
 	for ( int i = PCL_NONE; i < PCL_NUM_CLASSES; i++ )
 	{
 		classModelConfig_t *cc = &bg_classModelConfigList[ i ];
@@ -524,6 +541,11 @@ static void BG_InitClassModelConfigs()
 
 		// HACK: For now, all alien models are nonseg while humans are segmented. Remove this.
 		cc->segmented = cc->modelName[0] && BG_Class( i )->team == TEAM_ALIENS;
+
+		if ( cc->humanName )
+		{
+			bg_classModelConfigNames.emplace( cc->humanName, i );
+		}
 	}
 }
 
@@ -569,15 +591,10 @@ static const weaponAttributes_t nullWeapon {};
 
 weapon_t BG_WeaponNumberByName( const char *name )
 {
-	for ( unsigned i = 0; i < bg_numWeapons; i++ )
-	{
-		if ( !Q_stricmp( bg_weaponsData[ i ].name, name ) )
-		{
-			return bg_weaponsData[ i ].number;
-		}
-	}
+	static const nameIndex_t names = BG_BuildNameIndex( bg_weaponsData, &weaponData_t::name );
+	int i = BG_LookupName( names, name );
 
-	return ( weapon_t )0;
+	return i < 0 ? ( weapon_t )0 : bg_weaponsData[ i ].number;
 }
 
 const weaponAttributes_t *BG_WeaponByName( const char *name )
@@ -671,15 +688,10 @@ BG_UpgradeByName
 */
 const upgradeAttributes_t *BG_UpgradeByName( const char *name )
 {
-	for ( unsigned i = 0; i < bg_numUpgrades; i++ )
-	{
-		if ( !Q_stricmp( bg_upgrades[ i ].name, name ) )
-		{
-			return &bg_upgrades[ i ];
-		}
-	}
+	static const nameIndex_t names = BG_BuildNameIndex( bg_upgradesData, &upgradeData_t::name );
+	int i = BG_LookupName( names, name );
 
-	return &nullUpgrade;
+	return i < 0 ? &nullUpgrade : &bg_upgrades[ i ];
 }
 
 /*
@@ -755,15 +767,10 @@ BG_MissileByName
 */
 const missileAttributes_t *BG_MissileByName( const char *name )
 {
-	for ( unsigned i = 0; i < bg_numMissiles; i++ )
-	{
-		if ( !Q_stricmp( bg_missiles[ i ].name, name ) )
-		{
-			return &bg_missiles[ i ];
-		}
-	}
+	static const nameIndex_t names = BG_BuildNameIndex( bg_missilesData, &missileData_t::name );
+	int i = BG_LookupName( names, name );
 
-	return &nullMissile;
+	return i < 0 ? &nullMissile : &bg_missiles[ i ];
 }
 
 /*
@@ -871,8 +878,6 @@ static const meansOfDeathData_t bg_meansOfDeathData[] =
 	{ MOD_BUILDLOG_REVERT, "MOD_BUILDLOG_REVERT" },
 };
 
-static const size_t bg_numMeansOfDeath = ARRAY_LEN( bg_meansOfDeathData );
-
 /*
 ==============
 BG_MeansOfDeathByName
@@ -880,15 +885,10 @@ BG_MeansOfDeathByName
 */
 meansOfDeath_t BG_MeansOfDeathByName( const char *name )
 {
-	for ( unsigned i = 0; i < bg_numMeansOfDeath; i++ )
-	{
-		if ( !Q_stricmp( bg_meansOfDeathData[ i ].name, name ) )
-		{
-			return bg_meansOfDeathData[ i ].number;
-		}
-	}
+	static const nameIndex_t names = BG_BuildNameIndex( bg_meansOfDeathData, &meansOfDeathData_t::name );
+	int i = BG_LookupName( names, name );
 
-	return MOD_UNKNOWN;
+	return i < 0 ? MOD_UNKNOWN : bg_meansOfDeathData[ i ].number;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -925,11 +925,10 @@ BG_BeaconByName
 */
 const beaconAttributes_t *BG_BeaconByName( const char *name )
 {
-	for ( unsigned i = 0; i < bg_numBeacons; i++ )
-		if ( !Q_stricmp( bg_beacons[ i ].name, name ) )
-			return bg_beacons + i;
+	static const nameIndex_t names = BG_BuildNameIndex( bg_beaconsData, &beaconData_t::name );
+	int i = BG_LookupName( names, name );
 
-	return nullptr;
+	return i < 0 ? nullptr : bg_beacons + i;
 }
 
 /*
@@ -975,6 +974,578 @@ static void BG_InitBeaconAttributes()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/*
+================
+Config cache
+
+Parsing the config files is most of BG_InitAllConfigs, and they rarely change
+between two games. So the parsed records are saved to a cache file in the home
+path, which is loaded with a single read next time if none of the files they
+were parsed from changed.
+
+A source file is identified by the pak it comes from, with its checksum. Files
+from directories and unversioned paks can change without their pak doing so,
+so configs read from them are not cached. Missing files are remembered too, as
+adding one changes the configs.
+
+The strings duplicated with BG_strdup are saved as offsets into a blob, and
+duplicated again when loading. The names pointing to the static tables above
+are set again from them. On cgame, handles don't outlive the VM, so the media
+registered by the parsers is saved by name and registered again.
+================
+*/
+
+static Cvar::Cvar<bool> bg_configCache( VM_STRING_PREFIX "configCache",
+	"save the parsed game configs to load them faster next time", Cvar::NONE, true );
+
+static const int CONFIG_CACHE_VERSION = 1;
+
+static std::string BG_ConfigCacheFile()
+{
+	return Str::Format( "cache/%sconfigs.dat", VM_STRING_PREFIX );
+}
+
+// How a string of a config record is freed by BG_UnloadAllConfigs
+enum class configString_t
+{
+	OWNED,         // duplicated
+	OWNED_OR_EMPTY // duplicated, or "" which isn't freed
+};
+
+template<typename F>
+static void BG_ConfigStrings( buildableAttributes_t &ba, F &&f )
+{
+	f( ba.humanName, configString_t::OWNED );
+	f( ba.info, configString_t::OWNED );
+	f( ba.icon, configString_t::OWNED );
+}
+
+template<typename F>
+static void BG_ConfigStrings( buildableModelConfig_t &, F && )
+{
+}
+
+template<typename F>
+static void BG_ConfigStrings( classAttributes_t &ca, F &&f )
+{
+	f( ca.info, configString_t::OWNED_OR_EMPTY );
+	f( ca.icon, configString_t::OWNED );
+	f( ca.fovCvar, configString_t::OWNED_OR_EMPTY );
+}
+
+template<typename F>
+static void BG_ConfigStrings( classModelConfig_t &cc, F &&f )
+{
+	f( const_cast<const char *&>( cc.humanName ), configString_t::OWNED );
+}
+
+template<typename F>
+static void BG_ConfigStrings( weaponAttributes_t &wa, F &&f )
+{
+	f( wa.humanName, configString_t::OWNED );
+	f( wa.info, configString_t::OWNED_OR_EMPTY );
+}
+
+template<typename F>
+static void BG_ConfigStrings( upgradeAttributes_t &ua, F &&f )
+{
+	f( ua.humanName, configString_t::OWNED );
+	f( ua.info, configString_t::OWNED_OR_EMPTY );
+	f( ua.icon, configString_t::OWNED );
+}
+
+template<typename F>
+static void BG_ConfigStrings( missileAttributes_t &, F && )
+{
+}
+
+template<typename F>
+static void BG_ConfigStrings( beaconAttributes_t &ba, F &&f )
+{
+	f( ba.humanName, configString_t::OWNED );
+#ifdef BUILD_CGAME
+	for ( const char *&text : ba.text )
+	{
+		f( text, configString_t::OWNED );
+	}
+
+	f( ba.desc, configString_t::OWNED );
+#endif
+}
+
+// Sets the names that point to the static tables again
+static void BG_RestoreConfigNames()
+{
+	for ( unsigned i = 0; i < bg_numBuildables; i++ )
+	{
+		bg_buildableList[ i ].name = bg_buildableNameList[ i ].name;
+		bg_buildableList[ i ].entityName = bg_buildableNameList[ i ].classname;
+	}
+
+	for ( unsigned i = 0; i < bg_numClasses; i++ )
+	{
+		bg_classList[ i ].name = bg_classData[ i ].name;
+	}
+
+	for ( unsigned i = 0; i < bg_numWeapons; i++ )
+	{
+		bg_weapons[ i ].name = bg_weaponsData[ i ].name;
+	}
+
+	for ( unsigned i = 0; i < bg_numUpgrades; i++ )
+	{
+		bg_upgrades[ i ].name = bg_upgradesData[ i ].name;
+	}
+
+	for ( unsigned i = 0; i < bg_numMissiles; i++ )
+	{
+		bg_missiles[ i ].name = bg_missilesData[ i ].name;
+	}
+
+	for ( unsigned i = 0; i < bg_numBeacons; i++ )
+	{
+		bg_beacons[ i ].name = bg_beaconsData[ i ].name;
+	}
+
+	bg_classModelConfigNames.clear();
+
+	for ( int i = PCL_NONE; i < PCL_NUM_CLASSES; i++ )
+	{
+		if ( bg_classModelConfigList[ i ].humanName )
+		{
+			bg_classModelConfigNames.emplace( bg_classModelConfigList[ i ].humanName, i );
+		}
+	}
+}
+
+// The records holding media handles, which are saved as offsets into them
+static const struct {
+	void   *records;
+	size_t size;
+} configMediaTables[] = {
+	{ bg_missiles, sizeof( bg_missiles ) },
+	{ bg_beacons,  sizeof( bg_beacons ) },
+};
+
+/*
+================
+BG_ConfigSourceId
+
+Identifies the version of a file that configs are read from, or returns an
+empty string if it can't be identified without reading it.
+================
+*/
+static std::string BG_ConfigSourceId( const std::string &filename )
+{
+	const FS::LoadedPakInfo *pak = FS::PakPath::LocateFile( filename );
+
+	if ( !pak )
+	{
+		return "missing";
+	}
+
+	// only non-legacy paks have a meaningful checksum
+	if ( pak->type != FS::pakType_t::PAK_ZIP || pak->version.empty() )
+	{
+		return "";
+	}
+
+	return Str::Format( "%s %s %08x", pak->name, pak->version, pak->realChecksum.value() );
+}
+
+// FNV-1a
+static std::string BG_ConfigCacheChecksum( const char *data, size_t size )
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for ( size_t i = 0; i < size; i++ )
+	{
+		hash = ( hash ^ static_cast<unsigned char>( data[ i ] ) ) * 1099511628211ULL;
+	}
+
+	return Str::Format( "%016llx", static_cast<unsigned long long>( hash ) );
+}
+
+struct configCacheWriter_t
+{
+	std::string data;
+	std::string strings;
+
+	void Bytes( const void *bytes, size_t size )
+	{
+		data.append( static_cast<const char *>( bytes ), size );
+	}
+
+	void Int( int value )
+	{
+		Bytes( &value, sizeof( value ) );
+	}
+
+	void String( Str::StringRef string )
+	{
+		Int( string.size() );
+		Bytes( string.data(), string.size() );
+	}
+
+	// offset into the string blob, or -1 for nullptr
+	void BlobString( const char *string )
+	{
+		if ( !string )
+		{
+			Int( -1 );
+			return;
+		}
+
+		Int( strings.size() );
+		strings.append( string, strlen( string ) + 1 );
+	}
+
+	template<typename T>
+	void Table( T *records, size_t count )
+	{
+		Int( count );
+		Int( sizeof( T ) );
+		Bytes( records, count * sizeof( T ) );
+
+		for ( size_t i = 0; i < count; i++ )
+		{
+			BG_ConfigStrings( records[ i ], [ this ]( const char *&field, configString_t ) {
+				BlobString( field );
+			} );
+		}
+	}
+};
+
+struct configCacheReader_t
+{
+	const char *pos;
+	const char *end;
+	bool ok = true;
+
+	void Bytes( void *bytes, size_t size )
+	{
+		if ( !ok || size > static_cast<size_t>( end - pos ) )
+		{
+			ok = false;
+			return;
+		}
+
+		memcpy( bytes, pos, size );
+		pos += size;
+	}
+
+	int Int()
+	{
+		int value = 0;
+		Bytes( &value, sizeof( value ) );
+		return value;
+	}
+
+	std::string String()
+	{
+		int size = Int();
+
+		if ( !ok || size < 0 || size > end - pos )
+		{
+			ok = false;
+			return "";
+		}
+
+		std::string string( pos, size );
+		pos += size;
+		return string;
+	}
+};
+
+// A table read from the cache, only copied to the records once all of them
+// were read
+template<typename T>
+struct configCacheTable_t
+{
+	std::vector<T>   records;
+	std::vector<int> strings;
+
+	bool Read( configCacheReader_t &in, size_t count )
+	{
+		if ( in.Int() != static_cast<int>( count ) || in.Int() != static_cast<int>( sizeof( T ) ) )
+		{
+			return false;
+		}
+
+		records.resize( count );
+		in.Bytes( records.data(), count * sizeof( T ) );
+
+		for ( T &record : records )
+		{
+			BG_ConfigStrings( record, [ & ]( const char *&, configString_t ) {
+				strings.push_back( in.Int() );
+			} );
+		}
+
+		return in.ok;
+	}
+
+	bool Valid( const std::string &blob ) const
+	{
+		for ( int offset : strings )
+		{
+			if ( offset < -1 || offset >= static_cast<int>( blob.size() ) )
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void Restore( T *destination, const std::string &blob ) const
+	{
+		size_t next = 0;
+
+		for ( size_t i = 0; i < records.size(); i++ )
+		{
+			destination[ i ] = records[ i ];
+
+			BG_ConfigStrings( destination[ i ], [ & ]( const char *&field, configString_t kind ) {
+				int offset = strings[ next++ ];
+
+				if ( offset < 0 )
+				{
+					field = nullptr;
+				}
+				else if ( kind == configString_t::OWNED_OR_EMPTY && !blob[ offset ] )
+				{
+					field = "";
+				}
+				else
+				{
+					field = BG_strdup( &blob[ offset ] );
+				}
+			} );
+		}
+	}
+};
+
+static std::string BG_ConfigCacheHeader()
+{
+	return Str::Format( "unvconfigs %d %s %s", CONFIG_CACHE_VERSION, VM_STRING_PREFIX, PRODUCT_VERSION );
+}
+
+/*
+================
+BG_SaveConfigCache
+
+Saves the configs that were just parsed from these files
+================
+*/
+static void BG_SaveConfigCache( const std::vector<std::string> &files, const std::vector<configMedia_t> &media )
+{
+	configCacheWriter_t out;
+
+	out.Int( files.size() );
+	for ( const std::string &filename : files )
+	{
+		std::string id = BG_ConfigSourceId( filename );
+
+		if ( id.empty() )
+		{
+			Log::Verbose( "Not caching the game configs, as %s isn't in a versioned pak.", filename );
+			return;
+		}
+
+		out.String( filename );
+		out.String( id );
+	}
+
+	out.Table( bg_buildableList, bg_numBuildables );
+	out.Table( bg_buildableModelConfigList, BA_NUM_BUILDABLES );
+	out.Table( bg_classList, bg_numClasses );
+	out.Table( bg_classModelConfigList, PCL_NUM_CLASSES );
+	out.Table( bg_weapons, bg_numWeapons );
+	out.Table( bg_upgrades, bg_numUpgrades );
+	out.Table( bg_missiles, bg_numMissiles );
+	out.Table( bg_beacons, bg_numBeacons );
+	out.String( BG_SaveConfigVars() );
+
+	out.Int( media.size() );
+	for ( const configMedia_t &m : media )
+	{
+		const char *handle = reinterpret_cast<const char *>( m.handle );
+		int table;
+
+		for ( table = 0; table < static_cast<int>( ARRAY_LEN( configMediaTables ) ); table++ )
+		{
+			const char *records = static_cast<const char *>( configMediaTables[ table ].records );
+
+			if ( handle >= records && handle < records + configMediaTables[ table ].size )
+			{
+				break;
+			}
+		}
+
+		if ( table == static_cast<int>( ARRAY_LEN( configMediaTables ) ) )
+		{
+			Log::Warn( "Not caching the game configs, as the %s handle isn't in a config record.", m.name );
+			return;
+		}
+
+		out.Int( table );
+		out.Int( handle - static_cast<const char *>( configMediaTables[ table ].records ) );
+		out.Int( static_cast<int>( m.type ) );
+		out.Int( m.flags );
+		out.String( m.name );
+	}
+
+	out.String( out.strings );
+
+	std::string header = BG_ConfigCacheHeader();
+	std::string checksum = BG_ConfigCacheChecksum( out.data.data(), out.data.size() );
+
+	fileHandle_t f;
+	if ( trap_FS_FOpenFile( BG_ConfigCacheFile().c_str(), &f, fsMode_t::FS_WRITE_VIA_TEMPORARY ) < 0 )
+	{
+		Log::Warn( "Couldn't write the game config cache %s", BG_ConfigCacheFile() );
+		return;
+	}
+
+	trap_FS_Write( header.c_str(), header.size() + 1, f );
+	trap_FS_Write( checksum.c_str(), checksum.size() + 1, f );
+	trap_FS_Write( out.data.data(), out.data.size(), f );
+	trap_FS_FCloseFile( f );
+}
+
+/*
+================
+BG_LoadConfigCache
+
+Loads the configs from the cache if their files didn't change since it was saved
+================
+*/
+static bool BG_LoadConfigCache()
+{
+	fileHandle_t f;
+	int length = trap_FS_FOpenFile( BG_ConfigCacheFile().c_str(), &f, fsMode_t::FS_READ );
+
+	if ( length <= 0 )
+	{
+		if ( length == 0 )
+		{
+			trap_FS_FCloseFile( f );
+		}
+
+		return false;
+	}
+
+	std::string file( length, '\0' );
+	trap_FS_Read( &file[ 0 ], length, f );
+	trap_FS_FCloseFile( f );
+
+	// "header\0checksum\0data"
+	std::string header = BG_ConfigCacheHeader();
+	size_t dataStart = header.size() + 1 + 16 + 1;
+
+	if ( file.size() < dataStart || file.compare( 0, header.size() + 1, header.c_str(), header.size() + 1 ) )
+	{
+		Log::Verbose( "The game config cache is from another version." );
+		return false;
+	}
+
+	configCacheReader_t in{ file.data() + dataStart, file.data() + file.size() };
+	std::string checksum = BG_ConfigCacheChecksum( in.pos, in.end - in.pos );
+
+	if ( file.compare( header.size() + 1, 16, checksum ) )
+	{
+		Log::Warn( "The game config cache %s is corrupt.", BG_ConfigCacheFile() );
+		return false;
+	}
+
+	int numFiles = in.Int();
+	for ( int i = 0; in.ok && i < numFiles; i++ )
+	{
+		std::string filename = in.String();
+		std::string id = in.String();
+
+		if ( in.ok && BG_ConfigSourceId( filename ) != id )
+		{
+			Log::Verbose( "The game configs changed since they were cached: %s.", filename );
+			return false;
+		}
+	}
+
+	configCacheTable_t<buildableAttributes_t>  buildables;
+	configCacheTable_t<buildableModelConfig_t> buildableModels;
+	configCacheTable_t<classAttributes_t>      classes;
+	configCacheTable_t<classModelConfig_t>     classModels;
+	configCacheTable_t<weaponAttributes_t>     weapons;
+	configCacheTable_t<upgradeAttributes_t>    upgrades;
+	configCacheTable_t<missileAttributes_t>    missiles;
+	configCacheTable_t<beaconAttributes_t>     beacons;
+
+	bool ok = in.ok
+	       && buildables.Read( in, bg_numBuildables )
+	       && buildableModels.Read( in, BA_NUM_BUILDABLES )
+	       && classes.Read( in, bg_numClasses )
+	       && classModels.Read( in, PCL_NUM_CLASSES )
+	       && weapons.Read( in, bg_numWeapons )
+	       && upgrades.Read( in, bg_numUpgrades )
+	       && missiles.Read( in, bg_numMissiles )
+	       && beacons.Read( in, bg_numBeacons );
+
+	std::string configVars = in.String();
+
+	std::vector<configMedia_t> media( std::max( in.Int(), 0 ) );
+	for ( configMedia_t &m : media )
+	{
+		int table = in.Int();
+		int offset = in.Int();
+
+		if ( table < 0 || table >= static_cast<int>( ARRAY_LEN( configMediaTables ) ) || offset < 0
+		     || offset + sizeof( int ) > configMediaTables[ table ].size )
+		{
+			ok = false;
+			break;
+		}
+
+		m.handle = reinterpret_cast<int *>( static_cast<char *>( configMediaTables[ table ].records ) + offset );
+		m.type = static_cast<configMediaType_t>( in.Int() );
+		m.flags = in.Int();
+		m.name = in.String();
+	}
+
+	std::string blob = in.String();
+
+	ok = ok && in.ok && ( blob.empty() || blob.back() == '\0' )
+	     && buildables.Valid( blob ) && buildableModels.Valid( blob ) && classes.Valid( blob ) && classModels.Valid( blob )
+	     && weapons.Valid( blob ) && upgrades.Valid( blob ) && missiles.Valid( blob ) && beacons.Valid( blob );
+
+	if ( !ok || !BG_LoadConfigVars( configVars ) )
+	{
+		Log::Warn( "The game config cache %s couldn't be read.", BG_ConfigCacheFile() );
+		return false;
+	}
+
+	buildables.Restore( bg_buildableList, blob );
+	buildableModels.Restore( bg_buildableModelConfigList, blob );
+	classes.Restore( bg_classList, blob );
+	classModels.Restore( bg_classModelConfigList, blob );
+	weapons.Restore( bg_weapons, blob );
+	upgrades.Restore( bg_upgrades, blob );
+	missiles.Restore( bg_missiles, blob );
+	beacons.Restore( bg_beacons, blob );
+	BG_RestoreConfigNames();
+
+#ifdef BUILD_CGAME
+	for ( const configMedia_t &m : media )
+	{
+		*m.handle = BG_RegisterConfigMedia( m.type, m.name.c_str(), m.flags );
+	}
+#endif
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 /*
 ================
 BG_InitAllConfigs
@@ -986,18 +1557,61 @@ bool config_loaded = false;
 
 void BG_InitAllConfigs()
 {
-	BG_InitBuildableAttributes();
-	BG_InitBuildableModelConfigs();
-	BG_InitClassAttributes();
-	BG_InitClassModelConfigs();
-	BG_InitWeaponAttributes();
-	BG_InitUpgradeAttributes();
-	BG_InitMissileAttributes();
-	BG_InitBeaconAttributes();
+	auto start = Timing::Now();
+
+	if ( bg_configCache.Get() && BG_LoadConfigCache() )
+	{
+		BG_CheckConfigVars();
+
+		config_loaded = true;
+
+		Log::Verbose( "Loaded game configs from the cache in %dus.", Timing::Elapsed( start ) );
+		return;
+	}
+
+	static const struct {
+		const char *name;
+		void ( *init )();
+	} steps[] = {
+		{ "buildables",       BG_InitBuildableAttributes },
+		{ "buildable models", BG_InitBuildableModelConfigs },
+		{ "classes",          BG_InitClassAttributes },
+		{ "class models",     BG_InitClassModelConfigs },
+		{ "weapons",          BG_InitWeaponAttributes },
+		{ "upgrades",         BG_InitUpgradeAttributes },
+		{ "missiles",         BG_InitMissileAttributes },
+		{ "beacons",          BG_InitBeaconAttributes },
+	};
+
+	// Report how the time is spent so that parsing can be compared with
+	// loading the cache.
+	std::string timings;
+	std::vector<std::string> files;
+	std::vector<configMedia_t> media;
+
+	BG_RecordConfigSources( &files, &media );
+
+	for ( const auto &step : steps )
+	{
+		auto stepStart = Timing::Now();
+		step.init();
+		timings += Str::Format( ", %s %dus", step.name, Timing::Elapsed( stepStart ) );
+	}
+
+	BG_RecordConfigSources( nullptr, nullptr );
 
 	BG_CheckConfigVars();
 
 	config_loaded = true;
+
+	int parsed = Timing::Elapsed( start );
+
+	if ( bg_configCache.Get() )
+	{
+		BG_SaveConfigCache( files, media );
+	}
+
+	Log::Verbose( "Parsed game configs in %dus%s, cached in %dus.", parsed, timings, Timing::Elapsed( start ) - parsed );
 }
 
 /*
@@ -1054,6 +1668,7 @@ void BG_UnloadAllConfigs()
     {
         BG_Free(BG_ClassModelConfig( i )->humanName);
     }
+    bg_classModelConfigNames.clear();
 
     for ( unsigned i = 0; i < bg_numWeapons; i++ )
     {
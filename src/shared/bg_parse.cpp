@@ -274,6 +274,112 @@ static configVar_t bg_configVars[] =
 
 static const size_t bg_numConfigVars = ARRAY_LEN( bg_configVars );
 
+// set while the config cache is being built
+static std::vector<std::string> *configFiles;
+static std::vector<configMedia_t> *configMedia;
+
+/*
+======================
+BG_RecordConfigSources
+
+Records the files that the parsers read, and the media they register, for the
+config cache. Stops with nullptr.
+======================
+*/
+
+void BG_RecordConfigSources( std::vector<std::string> *files, std::vector<configMedia_t> *media )
+{
+	configFiles = files;
+	configMedia = media;
+}
+
+/*
+======================
+BG_SaveConfigVars
+
+The config vars, with whether they were defined, for the config cache
+======================
+*/
+
+std::string BG_SaveConfigVars()
+{
+	std::string saved;
+
+	for ( const configVar_t &var : bg_configVars )
+	{
+		saved += var.defined ? '1' : '0';
+		saved.append( static_cast<const char *>( var.var ), 4 );
+	}
+
+	return saved;
+}
+
+/*
+======================
+BG_LoadConfigVars
+======================
+*/
+
+bool BG_LoadConfigVars( const std::string &saved )
+{
+	if ( saved.size() != 5 * bg_numConfigVars )
+	{
+		return false;
+	}
+
+	for ( size_t i = 0; i < bg_numConfigVars; i++ )
+	{
+		bg_configVars[ i ].defined = saved[ 5 * i ] == '1';
+		memcpy( bg_configVars[ i ].var, &saved[ 5 * i + 1 ], 4 );
+	}
+
+	return true;
+}
+
+#ifdef BUILD_CGAME
+/*
+======================
+BG_RegisterConfigMedia
+
+Registers the media named in a config
+======================
+*/
+
+int BG_RegisterConfigMedia( configMediaType_t type, const char *name, int flags )
+{
+	switch ( type )
+	{
+		case configMediaType_t::MODEL:
+			return trap_R_RegisterModel( name );
+
+		case configMediaType_t::SHADER:
+			return trap_R_RegisterShader( name, static_cast<RegisterShaderFlags_t>( flags ) );
+
+		case configMediaType_t::SOUND:
+			return trap_S_RegisterSound( name, false );
+
+		case configMediaType_t::PARTICLE_SYSTEM:
+			return CG_RegisterParticleSystem( name );
+
+		case configMediaType_t::TRAIL_SYSTEM:
+			return CG_RegisterTrailSystem( name );
+	}
+
+	return 0;
+}
+
+// Registers the media for a field of a config, remembering it for the cache
+static void BG_RegisterConfigHandle( int *handle, configMediaType_t type, const char *name, int flags = 0 )
+{
+	*handle = BG_RegisterConfigMedia( type, name, flags );
+
+	if ( configMedia )
+	{
+		configMedia->push_back( { handle, type, name, flags } );
+	}
+}
+#endif
+
 /*
 ======================
 BG_ReadWholeFile
@@ -284,6 +390,11 @@ TODO: migrate callers to use FS::PakPath::ReadFile directly
 
 bool BG_ReadWholeFile( const char *filename, char *buffer, size_t size)
 {
+	if ( configFiles )
+	{
+		configFiles->push_back( filename );
+	}
+
 	std::error_code err;
 	std::string text = FS::PakPath::ReadFile( filename, err );
 	if ( err )
@@ -2124,7 +2235,7 @@ void BG_ParseMissileDisplayFile( const char *filename, missileAttributes_t *ma )
 		{
 			PARSE( text, token );
 #ifdef BUILD_CGAME
-			ma->model = trap_R_RegisterModel( token );
+			BG_RegisterConfigHandle( &ma->model, configMediaType_t::MODEL, token );
 #endif
 			defined |= MODEL;
 		}
@@ -2149,7 +2260,7 @@ void BG_ParseMissileDisplayFile( const char *filename, missileAttributes_t *ma )
 		{
 			PARSE( text, token );
 #ifdef BUILD_CGAME
-			ma->sound = trap_S_RegisterSound( token, false );
+			BG_RegisterConfigHandle( &ma->sound, configMediaType_t::SOUND, token );
 #endif
 			defined |= SOUND;
 		}
@@ -2182,7 +2293,7 @@ void BG_ParseMissileDisplayFile( const char *filename, missileAttributes_t *ma )
 		{
 			PARSE( text, token );
 #ifdef BUILD_CGAME
-			ma->sprite = trap_R_RegisterShader( token, RSF_SPRITE );
+			BG_RegisterConfigHandle( &ma->sprite, configMediaType_t::SHADER, token, RSF_SPRITE );
 #endif
 			defined |= SPRITE;
 			ma->usesSprite = true;
@@ -2198,7 +2309,7 @@ void BG_ParseMissileDisplayFile( const char *filename, missileAttributes_t *ma )
 		{
 			PARSE( text, token );
 #ifdef BUILD_CGAME
-			ma->particleSystem = CG_RegisterParticleSystem( token );
+			BG_RegisterConfigHandle( &ma->particleSystem, configMediaType_t::PARTICLE_SYSTEM, token );
 #endif
 			defined |= PARTICLE_SYSTEM;
 		}
@@ -2206,7 +2317,7 @@ void BG_ParseMissileDisplayFile( const char *filename, missileAttributes_t *ma )
 		{
 			PARSE( text, token );
 #ifdef BUILD_CGAME
-			ma->trailSystem = CG_RegisterTrailSystem( token );
+			BG_RegisterConfigHandle( &ma->trailSystem, configMediaType_t::TRAIL_SYSTEM, token );
 #endif
 			defined |= TRAIL_SYSTEM;
 		}
@@ -2246,7 +2357,7 @@ void BG_ParseMissileDisplayFile( const char *filename, missileAttributes_t *ma )
 		{
 			PARSE( text, token );
 #ifdef BUILD_CGAME
-			ma->impactParticleSystem = CG_RegisterParticleSystem( token );
+			BG_RegisterConfigHandle( &ma->impactParticleSystem, configMediaType_t::PARTICLE_SYSTEM, token );
 #endif
 			defined |= IMPACT_PARTICLE;
 		}
@@ -2254,7 +2365,7 @@ void BG_ParseMissileDisplayFile( const char *filename, missileAttributes_t *ma )
 		{
 			PARSE( text, token );
 #ifdef BUILD_CGAME
-			ma->impactMark = trap_R_RegisterShader( token, RSF_DEFAULT );
+			BG_RegisterConfigHandle( &ma->impactMark, configMediaType_t::SHADER, token, RSF_DEFAULT );
 #endif
 			defined |= IMPACT_MARK;
 			ma->usesImpactMark = true;
@@ -2276,7 +2387,7 @@ void BG_ParseMissileDisplayFile( const char *filename, missileAttributes_t *ma )
 #ifdef BUILD_CGAME
 			if ( index >= 0 && index < 4 )
 			{
-				ma->impactSound[ index ] = trap_S_RegisterSound( token, false );
+				BG_RegisterConfigHandle( &ma->impactSound[ index ], configMediaType_t::SOUND, token );
 			}
 #endif
 			defined |= IMPACT_SOUND;
@@ -2291,7 +2402,7 @@ void BG_ParseMissileDisplayFile( const char *filename, missileAttributes_t *ma )
 #ifdef BUILD_CGAME
 			if ( index >= 0 && index < 4 )
 			{
-				ma->impactFleshSound[ index ] = trap_S_RegisterSound( token, false );
+				BG_RegisterConfigHandle( &ma->impactFleshSound[ index ], configMediaType_t::SOUND, token );
 			}
 #endif
 			defined |= IMPACT_FLESH_SND;
@@ -2408,7 +2519,7 @@ void BG_ParseBeaconAttributeFile( const char *filename, beaconAttributes_t *ba )
 			if( index < 0 || index >= 4 )
 				Log::Warn( "Invalid beacon icon index %i in %s", index, filename );
 			else
-				ba->icon[ 0 ][ index ] = trap_R_RegisterShader( token, (RegisterShaderFlags_t) ( RSF_2D | RSF_FITSCREEN ) );
+				BG_RegisterConfigHandle( &ba->icon[ 0 ][ index ], configMediaType_t::SHADER, token, RSF_2D | RSF_FITSCREEN );
 #endif
 		}
 		else if ( !Q_stricmp( token, "hlIcon" ) )
@@ -2422,21 +2533,21 @@ void BG_ParseBeaconAttributeFile( const char *filename, beaconAttributes_t *ba )
 			if( index < 0 || index >= 4 )
 				Log::Warn( "Invalid beacon highlighted icon index %i in %s", index, filename );
 			else
-				ba->icon[ 1 ][ index ] = trap_R_RegisterShader( token, (RegisterShaderFlags_t) ( RSF_2D | RSF_FITSCREEN ) );
+				BG_RegisterConfigHandle( &ba->icon[ 1 ][ index ], configMediaType_t::SHADER, token, RSF_2D | RSF_FITSCREEN );
 #endif
 		}
 		else if ( !Q_stricmp( token, "inSound" ) )
 		{
 			PARSE( text, token );
 #ifdef BUILD_CGAME
-			ba->inSound = trap_S_RegisterSound( token, false );
+			BG_RegisterConfigHandle( &ba->inSound, configMediaType_t::SOUND, token );
 #endif
 		}
 		else if ( !Q_stricmp( token, "outSound" ) )
 		{
 			PARSE( text, token );
 #ifdef BUILD_CGAME
-			ba->outSound = trap_S_RegisterSound( token, false );
+			BG_RegisterConfigHandle( &ba->outSound, configMediaType_t::SOUND, token );
 #endif
 		}
 		else if ( !Q_stricmp( token, "decayTime" ) )
@@ -1714,6 +1714,32 @@ void                      BG_ParseMissileAttributeFile( const char *filename, mi
 void                      BG_ParseMissileDisplayFile( const char *filename, missileAttributes_t *ma );
 void                      BG_ParseBeaconAttributeFile( const char *filename, beaconAttributes_t *ba );
 
+// What the config cache needs from the parsers: the files they read, the
+// config vars they set and, on cgame, the media they register, by name
+enum class configMediaType_t
+{
+	MODEL,
+	SHADER,
+	SOUND,
+	PARTICLE_SYSTEM,
+	TRAIL_SYSTEM
+};
+
+struct configMedia_t
+{
+	int               *handle;
+	configMediaType_t type;
+	std::string       name;
+	int               flags;
+};
+
+void                      BG_RecordConfigSources( std::vector<std::string> *files, std::vector<configMedia_t> *media );
+std::string               BG_SaveConfigVars();
+bool                      BG_LoadConfigVars( const std::string &saved );
+#ifdef BUILD_CGAME
+int                       BG_RegisterConfigMedia( configMediaType_t type, const char *name, int flags );
+#endif
+
 // bg_teamprogress.c
 #define NUM_UNLOCKABLES (WP_NUM_WEAPONS + UP_NUM_UPGRADES + BA_NUM_BUILDABLES + PCL_NUM_CLASSES)
 
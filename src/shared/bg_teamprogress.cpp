@@ -22,6 +22,8 @@ along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
 ===========================================================================
 */
 
+#include <bitset>
+
 #include "common/Common.h"
 #include "bg_public.h"
 
@@ -37,28 +39,49 @@ along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
 // definitions
 // -----------
 
+// 16 bit are available for transmission
+#define MAX_TEAM_UNLOCKABLES 16
+
 struct unlockable_t
 {
 	int      type;
 	int      num;
 	team_t   team;
-	bool     unlocked;
-	bool     statusKnown;
 	int      unlockThreshold;
 	int      lockThreshold;
+	int      teamBit; // position in the mask of the team, -1 if always unlocked
 };
 
 // ----
 // data
 // ----
 
-bool         unlockablesDataAvailable;
-int unlockablesTeamKnowledge; // bit mask of (1 << team)
+static bool unlockablesDataAvailable;
+static int  unlockablesTeamKnowledge; // bit mask of (1 << team)
+
+static unlockable_t unlockables[ NUM_UNLOCKABLES ];
+static bool         unlockablesBuilt;
+static int          unlockablesMask[ NUM_TEAMS ];
+
+static int unlockablesTypeOffset[ UNLT_NUM_UNLOCKABLETYPES ];
+
+// status of every item, indexed like unlockables
+static std::bitset<NUM_UNLOCKABLES> unlockedItems;
+static std::bitset<NUM_UNLOCKABLES> knownItems;
+
+// items of a team that have a threshold, by mask bit and by increasing threshold
+static int teamUnlockables[ NUM_TEAMS ][ MAX_TEAM_UNLOCKABLES ];
+static int teamUnlockablesByThreshold[ NUM_TEAMS ][ MAX_TEAM_UNLOCKABLES ];
+static int teamUnlockableCount[ NUM_TEAMS ];
 
-unlockable_t     unlockables[ NUM_UNLOCKABLES ];
-int              unlockablesMask[ NUM_TEAMS ];
+// settings the lock thresholds were derived from
+static float lastMomentumHalfLife;
+static float lastUnlockableMinTime;
 
-int              unlockablesTypeOffset[ UNLT_NUM_UNLOCKABLETYPES ];
+#ifdef BUILD_SGAME
+// momentum the status of the team's items was last evaluated with
+static float lastMomentum[ NUM_TEAMS ];
+#endif
 
 // -------------
 // local methods
@@ -153,14 +176,14 @@ static void InformUnlockableStatusChanges( int *statusChanges, int count )
 
 static bool Unlocked( unlockableType_t type, int itemNum )
 {
-	return unlockables[ unlockablesTypeOffset[ type ] + itemNum ].unlocked;
+	return unlockedItems[ unlockablesTypeOffset[ type ] + itemNum ];
 }
 
 static void CheckStatusKnowledge( unlockableType_t type, int itemNum )
 {
 	unlockable_t dummy;
 
-	if ( !unlockables[ unlockablesTypeOffset[ type ] + itemNum ].statusKnown )
+	if ( !knownItems[ unlockablesTypeOffset[ type ] + itemNum ] )
 	{
 		dummy.type = type;
 		dummy.num  = itemNum;
@@ -170,16 +193,16 @@ static void CheckStatusKnowledge( unlockableType_t type, int itemNum )
 	}
 }
 
-static float UnlockToLockThreshold( float unlockThreshold )
+/**
+ * Derives the lock thresholds from the unlock thresholds again if the settings they depend on
+ * have changed.
+ * @return Whether they have changed.
+ */
+static bool UpdateLockThresholds()
 {
 	float momentumHalfLife = 0.0f;
 	float unlockableMinTime  = 0.0f;
 
-	// maintain cache
-	static float lastMomentumHalfLife = 0.0f;
-	static float lastunlockableMinTime  = 0.0f;
-	static float lastMod                = 0.0f;
-
 	// retrieve relevant settings
 #ifdef BUILD_SGAME
 	momentumHalfLife = g_momentumHalfLife.Get();
@@ -190,86 +213,56 @@ static float UnlockToLockThreshold( float unlockThreshold )
 	unlockableMinTime  = cgs.unlockableMinTime;
 #endif
 
-	// a half life time of 0 means there is no decrease, so we don't need to alter thresholds
-	if ( momentumHalfLife <= 0.0f )
+	if ( lastMomentumHalfLife == momentumHalfLife && lastUnlockableMinTime == unlockableMinTime )
 	{
-		return unlockThreshold;
-	}
-
-	// do cache lookup
-	if ( lastMomentumHalfLife == momentumHalfLife &&
-	     lastunlockableMinTime  == unlockableMinTime  &&
-	     lastMod > 0.0f )
-	{
-		return lastMod * unlockThreshold;
+		return false;
 	}
 
 	lastMomentumHalfLife = momentumHalfLife;
-	lastunlockableMinTime  = unlockableMinTime;
-
-	// ln(2) ~= 0.6931472
-	lastMod = exp( -0.6931472f * ( unlockableMinTime / ( momentumHalfLife * 60.0f ) ) );
-
-	return lastMod * unlockThreshold;
-}
+	lastUnlockableMinTime  = unlockableMinTime;
 
-// ----------
-// BG methods
-// ----------
-
-void BG_InitUnlockackables()
-{
-	unlockablesDataAvailable = false;
-	unlockablesTeamKnowledge = 0;
+	// a half life time of 0 means there is no decrease, so we don't need to alter thresholds
+	float mod = 1.0f;
 
-	memset( unlockables, 0, sizeof( unlockables ) );
-	memset( unlockablesMask, 0, sizeof( unlockablesMask ) );
+	if ( momentumHalfLife > 0.0f )
+	{
+		// ln(2) ~= 0.6931472
+		mod = exp( -0.6931472f * ( unlockableMinTime / ( momentumHalfLife * 60.0f ) ) );
+	}
 
-	unlockablesTypeOffset[ UNLT_WEAPON ]    = 0;
-	unlockablesTypeOffset[ UNLT_UPGRADE ]   = WP_NUM_WEAPONS;
-	unlockablesTypeOffset[ UNLT_BUILDABLE ] = unlockablesTypeOffset[ UNLT_UPGRADE ]   + UP_NUM_UPGRADES;
-	unlockablesTypeOffset[ UNLT_CLASS ]     = unlockablesTypeOffset[ UNLT_BUILDABLE ] + BA_NUM_BUILDABLES;
+	for ( unlockable_t &unlockable : unlockables )
+	{
+		unlockable.lockThreshold = mod * unlockable.unlockThreshold;
+	}
 
-#ifdef BUILD_SGAME
-	G_UpdateUnlockables();
-#endif
+	return true;
 }
 
-void BG_ImportUnlockablesFromMask( int team, int mask )
+/**
+ * Fills in what doesn't change during a game: the items, their thresholds and their position in
+ * the masks. Items without a threshold are always unlocked.
+ */
+static void BuildUnlockables()
 {
-	int              unlockableNum, teamUnlockableNum = 0, itemNum = 0, unlockThreshold;
-	unlockable_t     *unlockable;
-	int unlockableType = 0;
-	team_t           currentTeam;
-	bool         newStatus;
-
-	// maintain a cache to prevent redundant imports
-	static int    lastMask = 0;
-	static team_t lastTeam = TEAM_NONE;
-
-	// just import if data is unavailable, cached mask is outdated or team has changed
-	if ( unlockablesDataAvailable && team == lastTeam && mask == lastMask )
+	int unlockableType = 0, itemNum = 0, unlockThreshold;
+	team_t team;
+
+	if ( unlockablesBuilt )
 	{
 		return;
 	}
 
-	// cache input
-	lastMask = mask;
-	lastTeam = (team_t) team;
+	memset( teamUnlockableCount, 0, sizeof( teamUnlockableCount ) );
+	unlockedItems.reset();
+	knownItems.reset();
 
-#ifdef BUILD_CGAME
-	// no status change yet
-	int statusChanges[ NUM_UNLOCKABLES ]{};
-	int statusChangeCount = 0;
-#endif
-
-	for ( unlockableNum = 0; unlockableNum < NUM_UNLOCKABLES; unlockableNum++ )
+	for ( int unlockableNum = 0; unlockableNum < NUM_UNLOCKABLES; unlockableNum++ )
 	{
-		unlockable = &unlockables[ unlockableNum ];
+		unlockable_t *unlockable = &unlockables[ unlockableNum ];
 
 		// also iterate over item types, itemNum is a per-type counter
-		if ( unlockableType < UNLT_NUM_UNLOCKABLETYPES - 1 &&
-		     unlockableNum == unlockablesTypeOffset[ unlockableType + 1 ] )
+		while ( unlockableType < UNLT_NUM_UNLOCKABLETYPES - 1 &&
+		        unlockableNum == unlockablesTypeOffset[ unlockableType + 1 ] )
 		{
 			unlockableType++;
 			itemNum = 0;
@@ -278,78 +271,166 @@ void BG_ImportUnlockablesFromMask( int team, int mask )
 		switch ( unlockableType )
 		{
 			case UNLT_WEAPON:
-				currentTeam     = BG_Weapon( itemNum )->team;
+				team            = BG_Weapon( itemNum )->team;
 				unlockThreshold = BG_Weapon( itemNum )->unlockThreshold;
 				break;
 
 			case UNLT_UPGRADE:
-				currentTeam     = BG_Upgrade( itemNum )->team;
+				team            = BG_Upgrade( itemNum )->team;
 				unlockThreshold = BG_Upgrade( itemNum )->unlockThreshold;
 				break;
 
 			case UNLT_BUILDABLE:
-				currentTeam     = BG_Buildable( itemNum )->team;
+				team            = BG_Buildable( itemNum )->team;
 				unlockThreshold = BG_Buildable( itemNum )->unlockThreshold;
 				break;
 
 			case UNLT_CLASS:
-				currentTeam     = BG_Class( itemNum )->team;
+				team            = BG_Class( itemNum )->team;
 				unlockThreshold = BG_Class( itemNum )->unlockThreshold;
 				break;
 
 			default:
-				Sys::Error( "BG_ImportUnlockablesFromMask: Unknown unlockable type" );
+				Sys::Error( "BuildUnlockables: Unknown unlockable type" );
 		}
 
-		unlockThreshold = std::max( unlockThreshold, 0 );
-
 		unlockable->type            = unlockableType;
 		unlockable->num             = itemNum;
-		unlockable->team            = currentTeam;
-		unlockable->unlockThreshold = unlockThreshold;
-		unlockable->lockThreshold   = UnlockToLockThreshold( unlockThreshold );
+		unlockable->team            = team;
+		unlockable->unlockThreshold = std::max( unlockThreshold, 0 );
+		unlockable->teamBit         = -1;
 
-		// retrieve the item's locking state
-		if ( !unlockThreshold )
+		if ( !unlockable->unlockThreshold )
 		{
-			unlockable->statusKnown = true;
-			unlockable->unlocked    = true;
+			knownItems[ unlockableNum ]    = true;
+			unlockedItems[ unlockableNum ] = true;
 		}
-		else if ( currentTeam == team )
+		else
 		{
-			newStatus = mask & ( 1 << teamUnlockableNum );
+			int &count = teamUnlockableCount[ team ];
 
-#ifdef BUILD_CGAME
-			// notify client about single status change
-			if ( unlockablesTeamKnowledge == (1 << team) && unlockable->statusKnown &&
-			     unlockable->unlocked != newStatus )
+			if ( count >= MAX_TEAM_UNLOCKABLES )
 			{
-				statusChanges[ unlockableNum ] = newStatus ? 1 : -1;
-				statusChangeCount++;
+				Sys::Error( "BuildUnlockables: Number of unlockable items for a team exceeded" );
 			}
+
+			unlockable->teamBit = count;
+			teamUnlockables[ team ][ count ] = unlockableNum;
+			teamUnlockablesByThreshold[ team ][ count ] = unlockableNum;
+			count++;
+		}
+
+		itemNum++;
+	}
+
+	for ( int teamNum = TEAM_NONE; teamNum < NUM_TEAMS; teamNum++ )
+	{
+		std::stable_sort( teamUnlockablesByThreshold[ teamNum ],
+		                  teamUnlockablesByThreshold[ teamNum ] + teamUnlockableCount[ teamNum ],
+		                  []( int a, int b ) {
+		                      return unlockables[ a ].unlockThreshold < unlockables[ b ].unlockThreshold;
+		                  } );
+	}
+
+	// lock thresholds have to be derived again
+	lastMomentumHalfLife  = -1.0f;
+	lastUnlockableMinTime = -1.0f;
+	UpdateLockThresholds();
+
+	unlockablesBuilt = true;
+}
+
+// ----------
+// BG methods
+// ----------
+
+void BG_InitUnlockackables()
+{
+	unlockablesDataAvailable = false;
+	unlockablesTeamKnowledge = 0;
+	unlockablesBuilt = false;
+
+	memset( unlockables, 0, sizeof( unlockables ) );
+	memset( unlockablesMask, 0, sizeof( unlockablesMask ) );
+	unlockedItems.reset();
+	knownItems.reset();
+
+	unlockablesTypeOffset[ UNLT_WEAPON ]    = 0;
+	unlockablesTypeOffset[ UNLT_UPGRADE ]   = WP_NUM_WEAPONS;
+	unlockablesTypeOffset[ UNLT_BUILDABLE ] = unlockablesTypeOffset[ UNLT_UPGRADE ]   + UP_NUM_UPGRADES;
+	unlockablesTypeOffset[ UNLT_CLASS ]     = unlockablesTypeOffset[ UNLT_BUILDABLE ] + BA_NUM_BUILDABLES;
+
+#ifdef BUILD_SGAME
+	G_UpdateUnlockables();
 #endif
+}
+
+/**
+ * Applies the mask of a team that is sent to clients. For the team the mask was applied for last,
+ * only the bits that changed are looked at.
+ */
+void BG_ImportUnlockablesFromMask( int team, int mask )
+{
+	// the item configuration is loaded after BG_InitUnlockackables on the client
+	BuildUnlockables();
+	UpdateLockThresholds();
 
-			unlockable->statusKnown = true;
-			unlockable->unlocked    = newStatus;
+	mask &= ( 1 << teamUnlockableCount[ team ] ) - 1;
 
-			teamUnlockableNum++;
+	if ( unlockablesDataAvailable && unlockablesTeamKnowledge == ( 1 << team ) )
+	{
+		int changes = mask ^ unlockablesMask[ team ];
+
+		if ( !changes )
+		{
+			return;
 		}
-		else
+
+#ifdef BUILD_CGAME
+		int statusChanges[ NUM_UNLOCKABLES ]{};
+		int statusChangeCount = 0;
+#endif
+
+		for ( int bit = 0; bit < teamUnlockableCount[ team ]; bit++ )
 		{
-			unlockable->statusKnown = false;
-			unlockable->unlocked    = false;
+			if ( !( changes & ( 1 << bit ) ) )
+			{
+				continue;
+			}
+
+			int  unlockableNum = teamUnlockables[ team ][ bit ];
+			bool newStatus     = mask & ( 1 << bit );
+
+			unlockedItems[ unlockableNum ] = newStatus;
+
+#ifdef BUILD_CGAME
+			statusChanges[ unlockableNum ] = newStatus ? 1 : -1;
+			statusChangeCount++;
+#endif
 		}
 
-		itemNum++;
+#ifdef BUILD_CGAME
+		// notify client about all status changes
+		InformUnlockableStatusChanges( statusChanges, statusChangeCount );
+#endif
+
+		unlockablesMask[ team ] = mask;
+		return;
 	}
 
-#ifdef BUILD_CGAME
-	// notify client about all status changes
-	if ( statusChangeCount )
+	// the status of the items of other teams is unknown
+	for ( int otherTeam = TEAM_NONE; otherTeam < NUM_TEAMS; otherTeam++ )
 	{
-		InformUnlockableStatusChanges( statusChanges, statusChangeCount );
+		bool known = otherTeam == team;
+
+		for ( int bit = 0; bit < teamUnlockableCount[ otherTeam ]; bit++ )
+		{
+			int unlockableNum = teamUnlockables[ otherTeam ][ bit ];
+
+			knownItems[ unlockableNum ]    = known;
+			unlockedItems[ unlockableNum ] = known && ( mask & ( 1 << bit ) );
+		}
 	}
-#endif
 
 	// we only know the state for one team
 	unlockablesDataAvailable = true;
@@ -414,7 +495,7 @@ static int MomentumNextThreshold( int threshold )
 
 	for ( i = 0; i < NUM_UNLOCKABLES; ++i )
 	{
-		int thisThreshold = unlockables[ i ].unlocked ? unlockables[ i ].lockThreshold : unlockables[ i ].unlockThreshold;
+		int thisThreshold = unlockedItems[ i ] ? unlockables[ i ].lockThreshold : unlockables[ i ].unlockThreshold;
 
 		if ( thisThreshold > threshold && thisThreshold < next )
 		{
@@ -436,12 +517,13 @@ momentumThresholdIterator_t BG_IterateMomentumThresholds( momentumThresholdItera
 
 	for ( ++unlockableIter.num; unlockableIter.num < NUM_UNLOCKABLES; unlockableIter.num++ )
 	{
-		unlockable_t unlockable = unlockables[ unlockableIter.num ];
-		int          thisThreshold = unlockable.unlocked ? unlockable.lockThreshold : unlockable.unlockThreshold;
+		const unlockable_t &unlockable = unlockables[ unlockableIter.num ];
+		bool         isUnlocked = unlockedItems[ unlockableIter.num ];
+		int          thisThreshold = isUnlocked ? unlockable.lockThreshold : unlockable.unlockThreshold;
 
 		if ( unlockable.team == team && unlockable.unlockThreshold && ( !unlockableIter.threshold || unlockableIter.threshold == thisThreshold ) )
 		{
-			*unlocked = unlockable.unlocked;
+			*unlocked = isUnlocked;
 			*threshold = thisThreshold;
 
 			return unlockableIter;
@@ -467,121 +549,77 @@ momentumThresholdIterator_t BG_IterateMomentumThresholds( momentumThresholdItera
 // ------------
 
 #ifdef BUILD_SGAME
-static void UpdateUnlockablesMask()
+static void SetUnlocked( int unlockableNum, bool unlocked )
 {
-	int    unlockable, unlockableNum[ NUM_TEAMS ];
-	int    team;
+	const unlockable_t &unlockable = unlockables[ unlockableNum ];
+
+	unlockedItems[ unlockableNum ] = unlocked;
 
-	for ( team = TEAM_NONE + 1; team < NUM_TEAMS; team++ )
+	if ( unlocked )
 	{
-		unlockableNum[ team ] = 0;
-		unlockablesMask[ team ] = 0;
+		unlockablesMask[ unlockable.team ] |= 1 << unlockable.teamBit;
 	}
-
-	for ( unlockable = 0; unlockable < NUM_UNLOCKABLES; unlockable++ )
+	else
 	{
-		if ( unlockables[ unlockable ].unlockThreshold )
-		{
-			team = unlockables[ unlockable ].team;
-
-			if ( unlockableNum[ team ] > 15 ) // 16 bit available for transmission
-			{
-				Sys::Error( "UpdateUnlockablesMask: Number of unlockable items for a team exceeded" );
-			}
-
-			if ( !unlockables[ unlockable ].statusKnown )
-			{
-				Sys::Error( "UpdateUnlockablesMask: Called before G_UpdateUnlockables" );
-			}
-
-			if ( unlockables[ unlockable ].unlocked )
-			{
-				unlockablesMask[ team ] |= ( 1 << unlockableNum[ team ] );
-			}
-
-			unlockableNum[ team ]++;
-		}
+		unlockablesMask[ unlockable.team ] &= ~( 1 << unlockable.teamBit );
 	}
 }
 #endif
 
 #ifdef BUILD_SGAME
+/**
+ * Updates the status of the items whose thresholds were crossed since the last call, using that
+ * an item is always unlocked above its unlock threshold and locked below its lock threshold.
+ */
 void G_UpdateUnlockables()
 {
-	int              itemNum = 0, unlockableNum, unlockThreshold;
-	float            momentum;
-	unlockable_t     *unlockable;
-	int              unlockableType = 0;
-	team_t           team;
+	BuildUnlockables();
+
+	bool thresholdsChanged = UpdateLockThresholds();
 
-	for ( unlockableNum = 0; unlockableNum < NUM_UNLOCKABLES; unlockableNum++ )
+	for ( int team = TEAM_NONE; team < NUM_TEAMS; team++ )
 	{
-		unlockable = &unlockables[ unlockableNum ];
+		const int *items    = teamUnlockablesByThreshold[ team ];
+		int       count     = teamUnlockableCount[ team ];
+		float     momentum  = level.team[ team ].momentum;
+		float     previous  = lastMomentum[ team ];
 
-		// also iterate over item types, itemNum is a per-type counter
-		while ( unlockableType < UNLT_NUM_UNLOCKABLETYPES - 1 &&
-		        unlockableNum == unlockablesTypeOffset[ unlockableType + 1 ] )
+		if ( !unlockablesDataAvailable || thresholdsChanged )
 		{
-			unlockableType++;
-			itemNum = 0;
-		}
+			// evaluate every item
+			for ( int i = 0; i < count; i++ )
+			{
+				const unlockable_t &unlockable = unlockables[ items[ i ] ];
 
-		switch ( unlockableType )
+				SetUnlocked( items[ i ],
+				             momentum >= unlockable.unlockThreshold ||
+				             ( unlockedItems[ items[ i ] ] && momentum >= unlockable.lockThreshold ) );
+			}
+		}
+		else if ( momentum > previous )
 		{
-			case UNLT_WEAPON:
-				team            = BG_Weapon( itemNum )->team;
-				unlockThreshold = BG_Weapon( itemNum )->unlockThreshold;
-				break;
-
-			case UNLT_UPGRADE:
-				team            = BG_Upgrade( itemNum )->team;
-				unlockThreshold = BG_Upgrade( itemNum )->unlockThreshold;
-				break;
-
-			case UNLT_BUILDABLE:
-				team            = BG_Buildable( itemNum )->team;
-				unlockThreshold = BG_Buildable( itemNum )->unlockThreshold;
-				break;
-
-			case UNLT_CLASS:
-				team            = BG_Class( itemNum )->team;
-				unlockThreshold = BG_Class( itemNum )->unlockThreshold;
-				break;
-
-			default:
-				Sys::Error( "G_UpdateUnlockables: Unknown unlockable type" );
+			// items with an unlock threshold up to the momentum are unlocked, the others keep their status
+			for ( int i = 0; i < count && unlockables[ items[ i ] ].unlockThreshold <= momentum; i++ )
+			{
+				SetUnlocked( items[ i ], true );
+			}
+		}
+		else if ( momentum < previous )
+		{
+			// items with a lock threshold above the momentum are locked, the others keep their status
+			for ( int i = count - 1; i >= 0 && unlockables[ items[ i ] ].lockThreshold > momentum; i-- )
+			{
+				SetUnlocked( items[ i ], false );
+			}
 		}
 
-		unlockThreshold = std::max( unlockThreshold, 0 );
-		momentum = level.team[ team ].momentum;
-
-		unlockable->type            = unlockableType;
-		unlockable->num             = itemNum;
-		unlockable->team            = team;
-		unlockable->statusKnown     = true;
-		unlockable->unlockThreshold = unlockThreshold;
-		unlockable->lockThreshold   = UnlockToLockThreshold( unlockThreshold );
-
-		// calculate the item's locking state
-		unlockable->unlocked = (
-		    !unlockThreshold || momentum >= unlockThreshold ||
-		    ( unlockable->unlocked && momentum >= unlockable->lockThreshold )
-		);
-
-		itemNum++;
-
-		/*Log::Notice( "G_UpdateUnlockables: Team %s, Type %s, Item %s, Momentum %d, Threshold %d, "
-		            "Unlocked %d, Synchronize %d\n",
-		            BG_TeamName( team ), UnlockableTypeName( unlockable ), UnlockableName( unlockable ),
-		            momentum, unlockThreshold, unlockable->unlocked, unlockable->synchronize );*/
+		lastMomentum[ team ] = momentum;
 	}
 
 	// GAME knows about all teams
 	unlockablesDataAvailable = true;
 	unlockablesTeamKnowledge = ~0;
-
-	// generate masks for network transmission
-	UpdateUnlockablesMask();
+	knownItems.set();
 }
 #endif
 
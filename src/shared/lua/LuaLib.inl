@@ -67,6 +67,14 @@ void LuaLib<T>::Register( lua_State* L )
 	lua_pushcfunction( L, tostring_T );
 	lua_setfield( L, metatable, "__tostring" );
 
+	//userdata already pushed for each object, weak so that unused ones can be collected
+	lua_newtable( L ); //[3] = cache
+	lua_newtable( L ); //[4] = metatable of the cache
+	lua_pushstring( L, "v" );
+	lua_setfield( L, -2, "__mode" );
+	lua_setmetatable( L, -2 ); //pop [4]
+	lua_setfield( L, metatable, "__userdata" ); //[metatable = 2] -> t["__userdata"] = [3]; pop [3]
+
 	ExtraInit<T>( L, metatable ); //optionally implemented by individual types
 
 	lua_newtable( L ); //for method table -> [3] = this table
@@ -93,18 +101,32 @@ int LuaLib<T>::push( lua_State* L, T* obj )
 	if ( lua_isnil( L, -1 ) ) luaL_error( L, "%s missing metatable", GetTClassName<T>() );
 
 	int mt = lua_gettop( L ); //mt = 1
-	T** ptrHold = ( T** )lua_newuserdata( L, sizeof( T** ) ); //->[2] = empty userdata
-	int ud = lua_gettop( L ); //ud = 2
 
-	if ( ptrHold != nullptr )
+	//reuse the userdata of this object if it is still alive, which saves an allocation
+	//and keeps the userdata of an object equal to itself
+	lua_getfield( L, mt, "__userdata" ); //->[2] = cache
+	int cache = lua_gettop( L ); //cache = 2
+	lua_pushlightuserdata( L, obj ); //->[3] = key
+	lua_rawget( L, cache ); //->[3] = cache[obj]
+
+	if ( lua_type( L, -1 ) != LUA_TUSERDATA )
 	{
-		*ptrHold = obj;
-		lua_pushvalue( L, mt ); // ->[3] = copy of [1]
-		lua_setmetatable( L, -2 ); //[-2 = 2] -> [2]'s metatable = [3]; pop [3]
+		lua_pop( L, 1 ); //remove the nil
+		T** ptrHold = ( T** )lua_newuserdata( L, sizeof( T** ) ); //->[3] = empty userdata
+
+		if ( ptrHold != nullptr )
+		{
+			*ptrHold = obj;
+			lua_pushvalue( L, mt ); // ->[4] = copy of [1]
+			lua_setmetatable( L, -2 ); //[-2 = 3] -> [3]'s metatable = [4]; pop [4]
+
+			lua_pushlightuserdata( L, obj ); //->[4] = key
+			lua_pushvalue( L, -2 ); //->[5] = copy of [3]
+			lua_rawset( L, cache ); //cache[obj] = [3]; pop [4] and [5]
+		}
 	}
 
-	lua_settop( L, ud ); //[ud = 2] -> remove everything that is above 2, top = [2]
-	lua_replace( L, mt ); //[mt = 1] -> move [2] to pos [1], and pop previous [1]
+	lua_replace( L, mt ); //[mt = 1] -> move [3] to pos [1], and pop previous [1]
 	lua_settop( L, mt ); //remove everything above [1]
 	return mt;  // index of userdata containing pointer to T object
 }
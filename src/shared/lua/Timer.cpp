@@ -32,7 +32,7 @@ Maryland 20850 USA.
 ===========================================================================
 */
 
-#include <list>
+#include <queue>
 
 #include "common/Common.h"
 #include "register_lua_extensions.h"
@@ -47,43 +47,66 @@ class Timer
    public:
 	void Add( int delayMs, int callbackRef, lua_State* L )
 	{
-		events.push_back( { delayMs, callbackRef, L } );
+		events.push( { lastTime + delayMs, nextSequence++, callbackRef, L } );
 	}
 
 	void RunUpdate( int time )
 	{
-		int dtMs = time - lastTime;
 		lastTime = time;
 
-		auto it = events.begin();
-		while ( it != events.end() )
+		// Take the due events off the queue before running any of them, so
+		// that timers added by the callbacks wait for the next update.
+		due.clear();
+		while ( !events.empty() && events.top().dueTime <= time )
 		{
-			it->delayMs -= dtMs;
-			if ( it->delayMs <= 0 )
-			{
-				lua_rawgeti( it->L, LUA_REGISTRYINDEX, it->callbackRef );
-				luaL_unref( it->L, LUA_REGISTRYINDEX, it->callbackRef );
-				if ( lua_pcall( it->L, 0, 0, 0 ) != 0 )
-					Log::Warn( "Could not run lua timer callback: %s", lua_tostring( it->L, -1 ) );
-				it = events.erase( it );
-			}
-			else
+			due.push_back( events.top() );
+			events.pop();
+		}
+
+		for ( const TimerEvent& event : due )
+		{
+			lua_rawgeti( event.L, LUA_REGISTRYINDEX, event.callbackRef );
+			luaL_unref( event.L, LUA_REGISTRYINDEX, event.callbackRef );
+			if ( lua_pcall( event.L, 0, 0, 0 ) != 0 )
 			{
-				++it;
+				Log::Warn( "Could not run lua timer callback: %s", lua_tostring( event.L, -1 ) );
+				lua_pop( event.L, 1 );
 			}
 		}
 	}
 
+	void Clear()
+	{
+		events = {};
+		lastTime = 0;
+	}
+
+	size_t Size() const
+	{
+		return events.size();
+	}
+
    private:
 	struct TimerEvent
 	{
-		int delayMs;
+		int dueTime;
+		unsigned sequence; // keeps events that are due at the same time in order
 		int callbackRef;
 		lua_State* L;
+
+		// std::priority_queue puts the greatest element on top
+		bool operator<( const TimerEvent& other ) const
+		{
+			if ( dueTime != other.dueTime )
+				return dueTime > other.dueTime;
+			return sequence > other.sequence;
+		}
 	};
 
-	int lastTime;
-	std::list<TimerEvent> events;
+	int lastTime = 0;
+	unsigned nextSequence = 0;
+	std::priority_queue<TimerEvent> events;
+	std::vector<TimerEvent> due;
 };
 
 static Timer timer;
@@ -114,5 +137,16 @@ void UpdateTimers( int time )
 	timer.RunUpdate( time );
 }
 
+// The callback references are not released, the state is about to be closed.
+void ClearTimers()
+{
+	timer.Clear();
+}
+
+size_t PendingTimers()
+{
+	return timer.Size();
+}
+
 }  // namespace Lua
 }  // namespace Shared
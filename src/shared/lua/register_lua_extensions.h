@@ -44,6 +44,8 @@ void RegisterCvar(lua_State* L);
 void RegisterTimer(lua_State* L);
 
 void UpdateTimers(int time);
+void ClearTimers();
+size_t PendingTimers();
 
 
 }  // namespace Lua
@@ -4290,6 +4290,131 @@ int Parse_SourceFileAndLine( int handle, char (&filename)[ MAX_QPATH ], int *lin
 	return true;
 }
 
+/*
+===============
+COM_ParseExt_r
+
+COM_ParseExt into a buffer of the caller rather than a global one, so that
+several threads can parse at once
+===============
+*/
+const char *COM_ParseExt_r( const char **text_p, bool allowLineBreaks, char (&token)[ MAX_TOKEN_CHARS ] )
+{
+	const char *data = *text_p;
+	bool hasNewLines = false;
+	int len = 0;
+
+	token[ 0 ] = '\0';
+
+	if ( !data )
+	{
+		return token;
+	}
+
+	// skip whitespace and comments
+	while ( true )
+	{
+		while ( static_cast<unsigned char>( *data ) <= ' ' )
+		{
+			if ( !*data )
+			{
+				*text_p = nullptr;
+				return token;
+			}
+
+			if ( *data == '\n' )
+			{
+				hasNewLines = true;
+			}
+
+			data++;
+		}
+
+		if ( hasNewLines && !allowLineBreaks )
+		{
+			*text_p = data;
+			return token;
+		}
+
+		if ( data[ 0 ] == '/' && data[ 1 ] == '/' )
+		{
+			while ( *data && *data != '\n' )
+			{
+				data++;
+			}
+		}
+		else if ( data[ 0 ] == '/' && data[ 1 ] == '*' )
+		{
+			data += 2;
+
+			while ( *data && ( data[ 0 ] != '*' || data[ 1 ] != '/' ) )
+			{
+				data++;
+			}
+
+			if ( *data )
+			{
+				data += 2;
+			}
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if ( *data == '"' )
+	{
+		// quoted string, with \" for a quote
+		data++;
+
+		while ( *data && *data != '"' )
+		{
+			if ( data[ 0 ] == '\\' && data[ 1 ] == '"' )
+			{
+				data++;
+			}
+
+			if ( len < MAX_TOKEN_CHARS - 1 )
+			{
+				token[ len++ ] = *data;
+			}
+
+			data++;
+		}
+
+		if ( *data )
+		{
+			data++;
+		}
+	}
+	else
+	{
+		while ( static_cast<unsigned char>( *data ) > ' ' )
+		{
+			if ( len < MAX_TOKEN_CHARS - 1 )
+			{
+				token[ len++ ] = *data;
+			}
+
+			data++;
+		}
+	}
+
+	token[ len ] = '\0';
+	*text_p = data;
+	return token;
+}
+
+/*
+===============
+COM_Parse_r
+===============
+*/
+const char *COM_Parse_r( const char **text_p, char (&token)[ MAX_TOKEN_CHARS ] )
+{
+	return COM_ParseExt_r( text_p, true, token );
+}
 
 /*
 ===============
@@ -55,6 +55,10 @@ int Parse_FreeSourceHandle(int handle);
 bool Parse_ReadTokenHandle(int handle, pc_token_t *pc_token);
 int Parse_SourceFileAndLine(int handle, char (&filename)[MAX_QPATH], int *line);
 
+// reentrant COM_ParseExt and COM_Parse, which return token
+const char *COM_ParseExt_r(const char **text_p, bool allowLineBreaks, char (&token)[MAX_TOKEN_CHARS]);
+const char *COM_Parse_r(const char **text_p, char (&token)[MAX_TOKEN_CHARS]);
+
 /*
 ===============
 Parse_WordListSplitter